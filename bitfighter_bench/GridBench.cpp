@@ -0,0 +1,257 @@
+//------------------------------------------------------------------------------
+// Copyright Chris Eykamp
+// See LICENSE.txt for full copyright information
+//------------------------------------------------------------------------------
+
+// GridDatabase timings.  The unit tests check that the index does less work by counting what it looks at; these show
+// what that's worth in milliseconds, which depends too much on the machine to assert on.
+
+#include "GridBench.h"
+
+#include "gridDB.h"
+#include "BfObject.h"      // For TypeNumbers
+#include "GeomUtils.h"
+#include "moveObject.h"    // For ActualState
+
+#include "tnlPlatform.h"
+#include "tnlRandom.h"
+
+#include <stdio.h>
+
+namespace Zap
+{
+
+// Bare-bones object we can put in a database without dragging a Game along
+class BenchGridObject : public DatabaseObject
+{
+public:
+   BenchGridObject(const Rect &extent, U8 typeNumber = TestItemTypeNumber)
+   {
+      mObjectTypeNumber = typeNumber;
+      setExtent(extent);
+   }
+};
+
+
+// Object with a square collision polygon filling its extent
+class BenchGridWall : public BenchGridObject
+{
+   Vector<Point> mPoly;
+
+public:
+   BenchGridWall(const Rect &extent) : BenchGridObject(extent, WallItemTypeNumber)
+   {
+      mPoly.push_back(extent.min);
+      mPoly.push_back(Point(extent.max.x, extent.min.y));
+      mPoly.push_back(extent.max);
+      mPoly.push_back(Point(extent.min.x, extent.max.y));
+   }
+
+   const Vector<Point> *getCollisionPoly() const { return &mPoly; }
+};
+
+
+static Rect squareAt(F32 x, F32 y, F32 size)
+{
+   return Rect(Point(x, y), Point(x + size, y + size));
+}
+
+
+static Point randomPoint(F32 levelSize)
+{
+   return Point(Random::readF() * levelSize, Random::readF() * levelSize);
+}
+
+
+static bool isTestItemType(U8 x)
+{
+   return x == TestItemTypeNumber;
+}
+
+
+// Small objects on a jittered grid, so density stays the same however big the level is
+static void fillLevel(GridDatabase &db, F32 levelSize)
+{
+   const F32 spacing = 128;
+
+   for(F32 x = 0; x < levelSize; x += spacing)
+      for(F32 y = 0; y < levelSize; y += spacing)
+         db.addToDatabase(new BenchGridObject(squareAt(x + Random::readF() * 100, y + Random::readF() * 100, 20)));
+}
+
+
+// Scatter small walls around a level
+static void fillLevelWithWalls(GridDatabase &db, F32 levelSize, S32 count)
+{
+   for(S32 i = 0; i < count; i++)
+   {
+      Point p = randomPoint(levelSize);
+      db.addToDatabase(new BenchGridWall(squareAt(p.x, p.y, 20 + Random::readF() * 60)));
+   }
+}
+
+
+// How findObjectLOS() used to work: gather everything in the ray's bounding box, then test each candidate
+static DatabaseObject *findObjectLOSByRect(GridDatabase &db, DatabaseQuery &query, const Point &start, const Point &end,
+                                           F32 &collisionTime)
+{
+   query.results.clear();
+   db.findObjects(query, (TestFunc)isWallType, Rect(start, end));
+
+   DatabaseObject *hit = NULL;
+   collisionTime = 1;
+
+   for(S32 i = 0; i < query.results.size(); i++)
+   {
+      const Vector<Point> *poly = query.results[i]->getCollisionPoly();
+      F32 ct;
+      Point normal;
+
+      if(polygonIntersectsSegmentDetailed(&poly->first(), poly->size(), true, start, end, ct, normal) && ct < collisionTime)
+      {
+         collisionTime = ct;
+         hit = query.results[i];
+      }
+   }
+
+   return hit;
+}
+
+
+// Long sightlines across a big, busy map; cell walking versus the old bounding box search
+static void benchRaycasts()
+{
+   const F32 LevelSize = 16384;
+   const S32 RayCount = 5000;
+
+   GridDatabase db(false);
+   fillLevelWithWalls(db, LevelSize, 20000);
+   db.resizeGrid(Rect(Point(0, 0), Point(LevelSize, LevelSize)));
+
+   Vector<LOSRay> rays(RayCount);
+   for(S32 i = 0; i < RayCount; i++)
+   {
+      LOSRay ray;
+      ray.start = randomPoint(LevelSize);
+      ray.end   = ray.start + Point(Random::readF() - 0.5f, Random::readF() - 0.5f) * 4000;
+      rays.push_back(ray);
+   }
+
+   F32 time;
+   Point normal;
+   DatabaseQuery query;
+
+   S64 start = Platform::getHighPrecisionTimerValue();
+   for(S32 i = 0; i < RayCount; i++)
+      findObjectLOSByRect(db, query, rays[i].start, rays[i].end, time);
+   F64 rectMs = Platform::getHighPrecisionMilliseconds(Platform::getHighPrecisionTimerValue() - start);
+
+   start = Platform::getHighPrecisionTimerValue();
+   for(S32 i = 0; i < RayCount; i++)
+      db.findObjectLOS(query, (TestFunc)isWallType, ActualState, true, rays[i].start, rays[i].end, time, normal);
+   F64 walkMs = Platform::getHighPrecisionMilliseconds(Platform::getHighPrecisionTimerValue() - start);
+
+   start = Platform::getHighPrecisionTimerValue();
+   db.findObjectsLOS(query, (TestFunc)isWallType, ActualState, true, rays);
+   F64 batchMs = Platform::getHighPrecisionMilliseconds(Platform::getHighPrecisionTimerValue() - start);
+
+   printf("Raycasts, %d rays among %d walls:\n", RayCount, db.getObjectCount());
+   printf("   Bounding box %.2f ms, cell walk %.2f ms, batched %.2f ms\n", rectMs, walkMs, batchMs);
+}
+
+
+// Moving objects around a heavily walled level, with and without the walls in a static grid
+static void benchMovingObjects()
+{
+   const F32 LevelSize = 8192;
+   const S32 WallCount = 40000;
+   const S32 MoverCount = 2000;
+   const S32 TickCount = 300;
+   F64 ms[2];
+
+   for(S32 pass = 0; pass < 2; pass++)
+   {
+      GridDatabase db(false);
+      fillLevelWithWalls(db, LevelSize, WallCount);
+
+      Vector<BenchGridObject *> movers;
+      Vector<Point> pos, vel;
+
+      for(S32 i = 0; i < MoverCount; i++)
+      {
+         pos.push_back(randomPoint(LevelSize));
+         vel.push_back(Point(Random::readF() - 0.5f, Random::readF() - 0.5f) * 100);
+         movers.push_back(new BenchGridObject(squareAt(pos[i].x, pos[i].y, 20)));
+         db.addToDatabase(movers[i]);
+      }
+
+      db.resizeGrid(Rect(Point(0, 0), Point(LevelSize, LevelSize)));
+      if(pass == 1)
+         db.buildStaticIndex();
+
+      S64 start = Platform::getHighPrecisionTimerValue();
+
+      for(S32 tick = 0; tick < TickCount; tick++)
+         for(S32 i = 0; i < MoverCount; i++)
+         {
+            pos[i] += vel[i];
+
+            if(pos[i].x < 0 || pos[i].x > LevelSize)     // Bounce off the edges of the level, so we stay among the walls
+               vel[i].x = -vel[i].x;
+            if(pos[i].y < 0 || pos[i].y > LevelSize)
+               vel[i].y = -vel[i].y;
+
+            movers[i]->setExtent(squareAt(pos[i].x, pos[i].y, 20));
+         }
+
+      ms[pass] = Platform::getHighPrecisionMilliseconds(Platform::getHighPrecisionTimerValue() - start);
+   }
+
+   printf("Moving objects, %d movers for %d ticks among %d walls:\n", MoverCount, TickCount, WallCount);
+   printf("   One index %.2f ms, static walls %.2f ms\n", ms[0], ms[1]);
+}
+
+
+// Query cost should not grow with level size when object density stays the same
+static void benchQueryCostByLevelSize()
+{
+   const S32 QueryCount = 20000;
+   const F32 levelSizes[] = { 2048, 8192, 16384 };
+
+   printf("Rect queries, same object density at every level size:\n");
+
+   for(U32 i = 0; i < ARRAYSIZE(levelSizes); i++)
+   {
+      GridDatabase db(false);
+      fillLevel(db, levelSizes[i]);
+      db.resizeGrid(Rect(Point(0, 0), Point(levelSizes[i], levelSizes[i])));
+
+      DatabaseQuery query;
+      S64 start = Platform::getHighPrecisionTimerValue();
+
+      for(S32 j = 0; j < QueryCount; j++)
+      {
+         F32 x = Random::readF() * (levelSizes[i] - 400);
+         F32 y = Random::readF() * (levelSizes[i] - 400);
+
+         query.results.clear();
+         db.findObjects(query, (TestFunc)isTestItemType, squareAt(x, y, 400));
+      }
+
+      F64 ms = Platform::getHighPrecisionMilliseconds(Platform::getHighPrecisionTimerValue() - start);
+
+      printf("   Level %5.0fpx: %6d objects, %5d cells of %dpx, %.5f ms/query\n", levelSizes[i], db.getObjectCount(),
+             db.getCellCount(), db.getCellSize(), ms / QueryCount);
+   }
+}
+
+
+void runGridBenchmarks()
+{
+   benchQueryCostByLevelSize();
+   benchRaycasts();
+   benchMovingObjects();
+}
+
+
+};
@@ -0,0 +1,17 @@
+//------------------------------------------------------------------------------
+// Copyright Chris Eykamp
+// See LICENSE.txt for full copyright information
+//------------------------------------------------------------------------------
+
+#ifndef _GRIDBENCH_H_
+#define _GRIDBENCH_H_
+
+namespace Zap
+{
+
+// Times GridDatabase on synthetic levels, for comparing the ways it can be used; see bitfighter_bench -grid
+void runGridBenchmarks();
+
+};
+
+#endif
@@ -0,0 +1,628 @@
+//------------------------------------------------------------------------------
+// Copyright Chris Eykamp
+// See LICENSE.txt for full copyright information
+//------------------------------------------------------------------------------
+
+// Bitfighter server benchmark
+//
+// Loads a level into a ServerGame with no rendering and no network traffic, fills it with robots, then runs a fixed
+// number of fixed-length ticks as fast as it can, and reports how long they took and where the time went.
+//
+//    bitfighter_bench [-robots N] [-observers N] [-ticks N] [-ticklength ms] [-bot script] [-cmdrmap]
+//                     [-latency ms] [-loss percent] [-joins N] [-connectthreads N] [other Bitfighter cmd line params]
+//                     <level file>
+//
+// Observers stand in for connected players: each gets a ship and a GameConnection that gets scoped and has packets
+// written for it, but the packets are thrown away and acked right on the spot, so the numbers don't depend on
+// the network.  With -cmdrmap, they keep the commander's map open, so they see what their whole team sees.
+// -latency holds acks back for that long, and -loss drops that share of packets, for seeing how updates that
+// depend on what the client has acked hold up on a real connection.
+//
+// -joins has that many clients connect to the server over the network, all at once, halfway through the run, to
+// see how much a burst of joins holds up the ticks.  -connectthreads sets how many worker threads the server checks
+// connect requests on; 0 checks them on the main thread, the way it used to be done.
+//
+// bitfighter_bench -grid skips all of the above, and times the spatial database on synthetic levels instead.
+// Run it from the exe folder, or pass -rootdatadir, so the bots and scripts can be found.
+
+#include "GridBench.h"
+#include "ServerGame.h"
+#include "GameManager.h"
+#include "GameSettings.h"
+#include "LevelSource.h"
+#include "LuaScriptRunner.h"
+#include "SystemFunctions.h"
+#include "TickProfiler.h"
+#include "ObjectPool.h"
+#include "gameConnection.h"
+#include "gameNetInterface.h"
+#include "ClientInfo.h"
+#include "ship.h"
+
+#include "stringUtils.h"
+
+#include "tnlLog.h"
+#include "tnlNetInterface.h"
+#include "tnlNonce.h"
+#include "tnlPlatform.h"
+#include "tnlRandom.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+
+namespace Zap
+{
+void exitToOs(S32 errcode) { exit(errcode); }
+void shutdownBitfighter()  { exit(0); }
+}
+
+
+using namespace Zap;
+
+
+// The game-specific part of the connect request a real client sends
+static void writeBenchConnectRequest(BitStream *stream, ServerGame *game, const string &name)
+{
+   stream->write(GameConnection::CONNECT_VERSION);
+   stream->writeString(Game::md5.getSaltedHashFromString(game->getSettings()->getServerPassword()).c_str());
+   stream->writeString(name.c_str());
+
+   Nonce id;
+   id.getRandom();
+   id.write(stream);
+   stream->writeFlag(false);     // Not authenticated
+}
+
+
+// A player with no client behind it.  Every tick it gets a packet written the way the server would for a real
+// connection, which is then acked as if it had arrived, or dropped, once the simulated latency has passed.
+class BenchObserver : public GameConnection
+{
+   typedef GameConnection Parent;
+
+private:
+   // Matches the fastest rate setConnectionSpeed() negotiates
+   static const U32 PacketPeriod = 20;
+   static const U32 PacketSize = 1310;
+
+   U32 mSinceLastPacket;
+   U32 mReadySequence;
+   U32 mPacketsWritten;
+   U32 mBytesWritten;
+
+   U32 mTime;
+   U32 mLatency;
+   U32 mLossPercent;
+
+   // Acks or drops, in order, everything sent at least mLatency ago
+   void notifySentPackets()
+   {
+      while(mNotifyQueueHead && mTime - mNotifyQueueHead->sendTime >= mLatency)
+      {
+         PacketNotify *note = mNotifyQueueHead;
+         mNotifyQueueHead = note->nextPacket;
+         if(!mNotifyQueueHead)
+            mNotifyQueueTail = NULL;
+
+         if(mLossPercent > 0 && Random::readI(0, 99) < mLossPercent)
+            packetDropped(note);
+         else
+            packetReceived(note);
+
+         delete note;
+      }
+   }
+
+public:
+   BenchObserver(ServerGame *game, const string &name, bool inCommanderMap, U32 latency, U32 lossPercent)
+   {
+      mServerGame = game;
+      mSinceLastPacket = 0;
+      mReadySequence = 0;
+      mPacketsWritten = 0;
+      mBytesWritten = 0;
+
+      mTime = 0;
+      mLatency = latency;
+      mLossPercent = lossPercent;
+
+      setInterface(game->getNetInterface());
+
+      // Hand the server the same connect request a real client would send
+      PacketStream request;
+      GhostConnection::writeConnectRequest(&request);
+      writeBenchConnectRequest(&request, game, name);
+
+      request.setBytePosition(0);
+
+      TerminationReason reason;
+      if(!readConnectRequest(&request, reason))
+      {
+         printf("Server refused connection from %s\n", name.c_str());
+         exit(1);
+      }
+
+      onConnectionEstablished();
+
+      if(inCommanderMap)
+         c2sRequestCommanderMap_remote();    // As if the client had asked
+   }
+
+
+   void idle(U32 timeDelta)
+   {
+      // A real client answers rpcStartGhosting and the GameType's sync messages; we just pretend it did
+      if(getGhostingSequence() != mReadySequence)
+      {
+         mReadySequence = getGhostingSequence();
+         rpcReadyForNormalGhosts_remote(mReadySequence);
+         setReadyForRegularGhosts(true);
+      }
+
+      mTime += timeDelta;
+      notifySentPackets();
+
+      mSinceLastPacket += timeDelta;
+      if(mSinceLastPacket < PacketPeriod)
+         return;
+
+      mSinceLastPacket -= PacketPeriod;
+
+      PacketNotify *note = allocNotify();
+      note->nextPacket = NULL;
+      note->sendTime = mTime;
+
+      if(mNotifyQueueTail)
+         mNotifyQueueTail->nextPacket = note;
+      else
+         mNotifyQueueHead = note;
+      mNotifyQueueTail = note;
+
+      PacketStream stream(PacketSize);
+      stream.setStringTable(mStringTable);
+
+      prepareWritePacket();
+      writePacket(&stream, note);
+
+      notifySentPackets();
+
+      mPacketsWritten++;
+      mBytesWritten += stream.getBytePosition();
+   }
+
+
+   U32 getPacketsWritten() const { return mPacketsWritten; }
+   U32 getBytesWritten()   const { return mBytesWritten;   }
+   U32 getElapsedMs()      const { return mTime;           }
+
+
+   void disconnect()
+   {
+      onConnectionTerminated(ReasonSelfDisconnect, "");
+   }
+};
+
+
+// A client connecting over the network from its own NetInterface.  It only gets as far as sending its connect
+// request; whatever the server sends back once it's connected is never read.
+class BenchJoiner : public GameConnection
+{
+   typedef GameConnection Parent;
+
+private:
+   ServerGame *mGame;
+   string mName;
+
+public:
+   BenchJoiner(ServerGame *game, const string &name)
+   {
+      mGame = game;
+      mName = name;
+   }
+
+   void writeConnectRequest(BitStream *stream)
+   {
+      GhostConnection::writeConnectRequest(stream);
+      writeBenchConnectRequest(stream, mGame, mName);
+   }
+
+   // There's no ClientGame to tell
+   void onConnectTerminated(TerminationReason reason, const char *reasonString)    { }
+   void onConnectionTerminated(TerminationReason reason, const char *reasonString) { }
+};
+
+
+struct HeldPacket
+{
+   Address address;
+   Vector<U8> data;
+};
+
+
+// Reads what's arrived for the server, holding back connect requests so they can all be let in at once later
+static void receiveHoldingConnectRequests(NetInterface *netInterface, Vector<HeldPacket> &heldPackets)
+{
+   static U8 data[Socket::MaxBatchSize][MaxPacketDataSize];
+   U8 *buffers[Socket::MaxBatchSize];
+   Address addresses[Socket::MaxBatchSize];
+   S32 sizes[Socket::MaxBatchSize];
+
+   for(S32 i = 0; i < Socket::MaxBatchSize; i++)
+      buffers[i] = data[i];
+
+   S32 count = netInterface->getSocket().recvBatch(addresses, buffers, MaxPacketDataSize, sizes, Socket::MaxBatchSize);
+
+   for(S32 i = 0; i < count; i++)
+   {
+      if(sizes[i] > 0 && data[i][0] == NetInterface::ConnectRequest)
+      {
+         bool resent = false;
+         for(S32 j = 0; j < heldPackets.size() && !resent; j++)
+            resent = heldPackets[j].address == addresses[i];
+
+         if(resent)
+            continue;
+
+         HeldPacket packet;
+         packet.address = addresses[i];
+         packet.data = Vector<U8>(data[i], sizes[i]);
+         heldPackets.push_back(packet);
+      }
+      else
+      {
+         BitStream stream(data[i], sizes[i]);
+         stream.setMaxSizes(sizes[i], 0);
+         stream.reset();
+         netInterface->processPacket(addresses[i], &stream);
+      }
+   }
+
+   netInterface->flushSendQueue();
+}
+
+
+// Gets each joiner through the handshake up to the point where it's sent its connect request, and has the
+// requests held back, so they can all be delivered together.  Joiners go one at a time, so none of their packets
+// get lost to a full socket buffer.  Returns false if one of them didn't make it.
+static bool prepareJoins(ServerGame *serverGame, S32 joins, Vector<NetInterface *> &joinerInterfaces,
+                         Vector<RefPtr<BenchJoiner> > &joiners, Vector<HeldPacket> &heldPackets)
+{
+   NetInterface *serverInterface = serverGame->getNetInterface();
+
+   Address serverAddress("IP:127.0.0.1:0");
+   serverAddress.port = serverInterface->getSocket().getBoundAddress().port;
+
+   for(S32 i = 0; i < joins; i++)
+   {
+      NetInterface *joinerInterface = new NetInterface(Address(IPProtocol, Address::Any, 0));
+      BenchJoiner *joiner = new BenchJoiner(serverGame, "Joiner " + itos(i));
+
+      joinerInterfaces.push_back(joinerInterface);
+      joiners.push_back(joiner);
+
+      joiner->connect(joinerInterface, serverAddress);
+
+      // Solving the puzzle takes a little while
+      U32 start = Platform::getRealMilliseconds();
+      while(heldPackets.size() <= i)
+      {
+         if(Platform::getRealMilliseconds() - start > 10000)
+            return false;
+
+         receiveHoldingConnectRequests(serverInterface, heldPackets);
+
+         joinerInterface->checkIncomingPackets();
+         joinerInterface->processConnections();
+
+         Platform::sleep(1);
+      }
+   }
+
+   return true;
+}
+
+
+static void printUsage()
+{
+   printf("Usage: bitfighter_bench [-robots N] [-observers N] [-ticks N] [-ticklength ms] [-bot script] [-cmdrmap]\n"
+          "                        [-latency ms] [-loss percent] [-joins N] [-connectthreads N] [other Bitfighter params]\n"
+          "                        <level file>\n"
+          "       bitfighter_bench -grid\n");
+}
+
+
+static F64 getPercentile(const Vector<F64> &sortedTimes, F64 percentile)
+{
+   if(sortedTimes.size() == 0)
+      return 0;
+
+   S32 index = S32(percentile * (sortedTimes.size() - 1) + 0.5);
+   return sortedTimes[index];
+}
+
+
+int main(int argc, char **argv)
+{
+   S32 robots = 8;
+   S32 observers = 0;
+   S32 ticks = 3600;
+   U32 tickLength = 16;
+   bool inCommanderMap = false;
+   U32 latency = 0;
+   U32 lossPercent = 0;
+   S32 joins = 0;
+   S32 connectThreads = -1;   // Leave the NetInterface default
+   string botScript = "s_bot.bot";
+   string levelFile = "";
+
+   Vector<string> argVector;
+
+   for(S32 i = 1; i < argc; i++)
+   {
+      string arg = argv[i];
+      bool hasValue = i + 1 < argc;
+
+      if(arg == "-robots" && hasValue)
+         robots = atoi(argv[++i]);
+      else if(arg == "-observers" && hasValue)
+         observers = atoi(argv[++i]);
+      else if(arg == "-ticks" && hasValue)
+         ticks = atoi(argv[++i]);
+      else if(arg == "-ticklength" && hasValue)
+         tickLength = atoi(argv[++i]);
+      else if(arg == "-bot" && hasValue)
+         botScript = argv[++i];
+      else if(arg == "-cmdrmap")
+         inCommanderMap = true;
+      else if(arg == "-latency" && hasValue)
+         latency = atoi(argv[++i]);
+      else if(arg == "-loss" && hasValue)
+         lossPercent = atoi(argv[++i]);
+      else if(arg == "-joins" && hasValue)
+         joins = atoi(argv[++i]);
+      else if(arg == "-connectthreads" && hasValue)
+         connectThreads = atoi(argv[++i]);
+      else if(arg == "-grid")
+      {
+         runGridBenchmarks();
+         return 0;
+      }
+      else if(arg[0] != '-' && i == argc - 1)
+         levelFile = arg;
+      else
+         argVector.push_back(arg);
+   }
+
+   if(levelFile == "" || ticks <= 0 || tickLength == 0)
+   {
+      printUsage();
+      return 1;
+   }
+
+   string levelCode = readFile(levelFile);
+   if(levelCode == "")
+   {
+      printf("Could not read level file %s\n", levelFile.c_str());
+      return 1;
+   }
+
+   // Problems with the level or the bots would otherwise go unnoticed, and make for some very fast ticks
+   StdoutLogConsumer stdoutLog;
+   stdoutLog.setMsgTypes(LogConsumer::AllErrorTypes);
+
+   GameSettingsPtr settings = GameSettingsPtr(new GameSettings());
+
+   settings->readCmdLineParams(argVector);
+   settings->resolveDirs();
+
+   // Let the OS pick a port, so we don't trip over a server that's already running
+   if(!settings->getSpecified(HOST_ADDRESS))
+      settings->getIniSettings()->hostaddr = "IP:Localhost:0";
+
+   LuaScriptRunner::startLua(settings->getFolderManager()->luaDir);
+   Ship::computeMaxFireDelay();
+
+   initHosting(settings, LevelSourcePtr(new StringLevelSource(levelCode)), true, true);
+
+   ServerGame *serverGame = GameManager::getServerGame();
+   serverGame->setReadyToConnectToMaster(false);
+
+   if(!serverGame->startHosting())
+   {
+      printf("Could not load level %s\n", levelFile.c_str());
+      return 1;
+   }
+
+   if(serverGame->isSuspended())
+      serverGame->unsuspendGame(false);
+
+   Vector<RefPtr<BenchObserver> > observerList;
+   for(S32 i = 0; i < observers; i++)
+      observerList.push_back(new BenchObserver(serverGame, "Observer " + itos(i), inCommanderMap, latency, lossPercent));
+
+   S32 teamCount = max(serverGame->getTeamCount(), 1);
+   for(S32 i = 0; i < robots; i++)
+   {
+      string team = itos(i % teamCount);
+
+      Vector<const char *> botArgs;
+      botArgs.push_back(team.c_str());
+      botArgs.push_back(botScript.c_str());
+
+      string error = serverGame->addBot(botArgs, ClientInfo::ClassRobotAddedByAddbots);
+      if(error != "")
+      {
+         printf("Could not add robot: %s\n", error.c_str());
+         return 1;
+      }
+   }
+
+   NetInterface *serverInterface = serverGame->getNetInterface();
+
+   if(connectThreads >= 0)
+      serverInterface->setConnectCheckThreadCount(connectThreads);
+
+   // Give everything a moment to spawn, so the first ticks measured aren't doing one-off work
+   for(S32 i = 0; i < 10; i++)
+   {
+      serverGame->idle(tickLength);
+      for(S32 j = 0; j < observerList.size(); j++)
+         observerList[j]->idle(tickLength);
+   }
+
+   Vector<NetInterface *> joinerInterfaces;
+   Vector<RefPtr<BenchJoiner> > joiners;
+   Vector<HeldPacket> heldPackets;
+
+   if(joins > 0 && !prepareJoins(serverGame, joins, joinerInterfaces, joiners, heldPackets))
+   {
+      printf("Only %d of %d joiners got their connect requests sent\n", heldPackets.size(), joins);
+      return 1;
+   }
+
+   S32 joinTick = ticks / 2;
+   S32 joinSettledTick = -1;
+   S32 connectionsBeforeJoins = 0;
+   F64 worstJoinTickMs = 0;
+
+   TickProfiler::reset();
+
+   // Pools keep their counts for the life of the process, so remember where loading left them
+   U32 heapAllocationsBefore = ObjectPool::getTotalHeapAllocations();
+   U32 reusesBefore = ObjectPool::getTotalReuses();
+
+   Vector<F64> tickTimes;
+   tickTimes.reserve(ticks);
+
+   S64 benchStart = Platform::getHighPrecisionTimerValue();
+
+   for(S32 i = 0; i < ticks; i++)
+   {
+      S64 tickStart = Platform::getHighPrecisionTimerValue();
+
+      TickProfiler::beginTick();
+
+      // All the joiners' connect requests arrive at once
+      if(i == joinTick && heldPackets.size() > 0)
+      {
+         connectionsBeforeJoins = serverInterface->getConnectionList().size();
+
+         for(S32 j = 0; j < heldPackets.size(); j++)
+         {
+            BitStream stream(heldPackets[j].data.address(), heldPackets[j].data.size());
+            stream.setMaxSizes(heldPackets[j].data.size(), 0);
+            stream.reset();
+            serverInterface->processPacket(heldPackets[j].address, &stream);
+         }
+      }
+
+      serverGame->idle(tickLength);
+
+      {
+         ProfileScope profileScope(TickProfiler::PhasePacketWriting);
+
+         for(S32 j = 0; j < observerList.size(); j++)
+            observerList[j]->idle(tickLength);
+      }
+
+      TickProfiler::endTick(true);
+
+      tickTimes.push_back(Platform::getHighPrecisionMilliseconds(Platform::getHighPrecisionTimerValue() - tickStart));
+
+      // Until every request has been dealt with, the ticks count as ones the joins might have held up
+      if(joins > 0 && i >= joinTick && joinSettledTick < 0)
+      {
+         worstJoinTickMs = max(worstJoinTickMs, tickTimes.last());
+
+         if(serverInterface->getPendingConnectCheckCount() == 0)
+            joinSettledTick = i;
+      }
+   }
+
+   F64 totalMs = Platform::getHighPrecisionMilliseconds(Platform::getHighPrecisionTimerValue() - benchStart);
+
+   std::sort(tickTimes.address(), tickTimes.address() + tickTimes.size());
+
+   printf("Level:     %s\n", levelFile.c_str());
+   printf("Robots:    %d (%d running)\n", robots, serverGame->getRobotCount());
+   printf("Observers: %d\n", observers);
+   if(observers > 0)
+      printf("Link:      %dms latency, %d%% loss\n", latency, lossPercent);
+   printf("Ticks:     %d x %dms in %.1fms\n", ticks, tickLength, totalMs);
+   printf("\n");
+   printf("Ticks per second: %.1f\n", totalMs > 0 ? ticks * 1000.0 / totalMs : 0.0);
+   printf("Tick time p50:    %.3fms\n", getPercentile(tickTimes, 0.50));
+   printf("Tick time p99:    %.3fms\n", getPercentile(tickTimes, 0.99));
+   printf("Tick time max:    %.3fms\n", tickTimes.last());
+   if(joins > 0)
+      printf("Joins:            %d at once, %d connected, worst tick %.3fms over the %d ticks it took\n", joins,
+             serverInterface->getConnectionList().size() - connectionsBeforeJoins, worstJoinTickMs,
+             joinSettledTick < 0 ? ticks - joinTick : joinSettledTick - joinTick + 1);
+   printf("\n");
+
+   F64 accountedMs = 0;
+   for(S32 i = 0; i < TickProfiler::PhaseCount; i++)
+   {
+      TickProfiler::Phase phase = TickProfiler::Phase(i);
+      F64 ms = TickProfiler::getPhaseMs(phase);
+      accountedMs += ms;
+
+      printf("%-16s %8.4fms/tick %6.1f%%\n", TickProfiler::getPhaseName(phase), ms / ticks, totalMs > 0 ? 100 * ms / totalMs : 0.0);
+   }
+
+   F64 otherMs = max(totalMs - accountedMs, 0.0);
+   printf("%-16s %8.4fms/tick %6.1f%%\n", "other", otherMs / ticks, totalMs > 0 ? 100 * otherMs / totalMs : 0.0);
+
+   U32 heapAllocations = ObjectPool::getTotalHeapAllocations() - heapAllocationsBefore;
+   U32 reuses = ObjectPool::getTotalReuses() - reusesBefore;
+   printf("\nPooled objects:   %u from heap, %u reused (%.1f%% hits)\n", heapAllocations, reuses,
+          heapAllocations + reuses > 0 ? 100.0 * reuses / (heapAllocations + reuses) : 0.0);
+
+   Vector<string> poolLines;
+   ObjectPool::getReport(poolLines);
+   for(S32 i = 0; i < poolLines.size(); i++)
+      printf("  %s\n", poolLines[i].c_str());
+
+   if(observers > 0)
+   {
+      U32 packets = 0;
+      U32 bytes = 0;
+      F64 seconds = 0;
+      for(S32 i = 0; i < observerList.size(); i++)
+      {
+         packets += observerList[i]->getPacketsWritten();
+         bytes += observerList[i]->getBytesWritten();
+         seconds += observerList[i]->getElapsedMs() / 1000.0;
+      }
+
+      printf("\nPackets written:  %d, averaging %d bytes\n", packets, packets > 0 ? bytes / packets : 0);
+      printf("Per observer:     %.0f bytes/sec\n", seconds > 0 ? bytes / seconds : 0.0);
+
+      // Where the bytes went, for the kinds of object updated at least once a packet on average
+      printf("\n");
+      U32 classCount = NetClassRep::getNetClassCount(NetClassGroupGame, NetClassTypeObject);
+      for(U32 i = 0; i < classCount; i++)
+      {
+         NetClassRep *rep = NetClassRep::getClass(NetClassGroupGame, NetClassTypeObject, i);
+         U32 updates = rep->getPartialUpdateCount();
+
+         if(updates >= packets)
+            printf("%-16s %8d updates, averaging %.1f bits\n", rep->getClassName(), updates,
+                   F64(rep->getPartialUpdateBitsUsed()) / updates);
+      }
+   }
+
+   for(S32 i = 0; i < observerList.size(); i++)
+      observerList[i]->disconnect();
+   observerList.clear();
+
+   GameManager::deleteServerGame();
+   LuaScriptRunner::shutdown();
+
+   joiners.clear();
+   for(S32 i = 0; i < joinerInterfaces.size(); i++)
+      delete joinerInterfaces[i];
+
+   return 0;
+}
@@ -0,0 +1,70 @@
+//------------------------------------------------------------------------------
+// Copyright Chris Eykamp
+// See LICENSE.txt for full copyright information
+//------------------------------------------------------------------------------
+
+#include "../zap/BotNavMeshZone.h"
+
+#include "gtest/gtest.h"
+
+namespace Zap
+{
+
+using namespace std;
+using namespace TNL;
+
+
+static void buildZones(GridDatabase &database, Vector<BotNavMeshZone *> &zones, const Rect &extents, BotZoneCache *cache)
+{
+   Vector<DatabaseObject *> noObjects;
+   Vector<pair<Point, const Vector<Point> *> > noTeleporters;
+
+   ASSERT_TRUE(BotNavMeshZone::buildBotMeshZones(&database, &zones, &extents, noObjects, noObjects, noObjects,
+                                                 noTeleporters, false, cache));
+}
+
+
+TEST(BotNavMeshZoneTest, CachedZonesMatch)
+{
+   GridDatabase database;
+   Vector<BotNavMeshZone *> zones;
+   BotZoneCache cache;
+   Rect extents(Point(-500, -500), Point(500, 500));
+
+   buildZones(database, zones, extents, &cache);
+   ASSERT_GT(zones.size(), 0);
+   EXPECT_EQ(1, cache.getSnapshotCount());
+
+   Vector<Vector<Point> > outlines;
+   Vector<S32> neighborCounts;
+   for(S32 i = 0; i < zones.size(); i++)
+   {
+      outlines.push_back(*zones[i]->getOutline());
+      neighborCounts.push_back(zones[i]->mNeighbors.size());
+   }
+
+   // Same inputs again should come straight from the cache, and give the same zones
+   buildZones(database, zones, extents, &cache);
+   EXPECT_EQ(1, cache.getSnapshotCount());
+   ASSERT_EQ(outlines.size(), zones.size());
+   EXPECT_EQ(zones.size(), database.getObjectCount());
+
+   for(S32 i = 0; i < zones.size(); i++)
+   {
+      EXPECT_EQ(i, zones[i]->getZoneId());
+      EXPECT_EQ(neighborCounts[i], zones[i]->mNeighbors.size());
+
+      ASSERT_EQ(outlines[i].size(), zones[i]->getOutline()->size());
+      for(S32 j = 0; j < outlines[i].size(); j++)
+         EXPECT_EQ(outlines[i][j], zones[i]->getOutline()->get(j));
+   }
+
+   // Different inputs need their own snapshot
+   buildZones(database, zones, Rect(Point(-1000, -1000), Point(1000, 1000)), &cache);
+   EXPECT_EQ(2, cache.getSnapshotCount());
+
+   zones.deleteAndClear();
+}
+
+
+};
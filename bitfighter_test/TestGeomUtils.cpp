@@ -7,6 +7,7 @@
 #include "../zap/MathUtils.h"
 #include "gtest/gtest.h"
 #include <tnl.h>
+#include "tnlRandom.h"
 #include <map>
 #include <stdarg.h>
 
@@ -428,5 +429,64 @@ TEST(GeomUtilsTest, pointInHexagon)
 }
 
 
+// The batched swept circle test should agree with the one-at-a-time version MoveObject::findFirstCollision() used to do
+TEST(GeomUtilsTest, sweptCircleHitTimes)
+{
+   const S32 Count = 103;     // Not a multiple of 4, so the scalar tail gets exercised too
+   F32 x[Count], y[Count], radii[Count], hitTimes[Count];
+
+   Point pos(10, 20);
+   Point vel(300, -150);
+   F32 radius = 24;
+   F32 maxTime = 0.5f;
+
+   for(S32 i = 0; i < Count; i++)
+   {
+      x[i] = TNL::Random::readF() * 400 - 100;
+      y[i] = TNL::Random::readF() * 400 - 300;
+      radii[i] = TNL::Random::readF() * 30 + 1;
+   }
+
+   // A few we know the answer for
+   x[0] = 110;   y[0] = 20;    radii[0] = 26;    // Dead ahead in x, but we're moving diagonally
+   x[1] = 20;    y[1] = 20;    radii[1] = 10;    // Overlapping, and we're moving towards it
+   x[2] = -20;   y[2] = 20;    radii[2] = 10;    // Overlapping, but we're moving away
+   x[3] = 5000;  y[3] = 5000;  radii[3] = 10;    // Miles away
+
+   sweptCircleHitTimes(pos, vel, radius, x, y, radii, Count, maxTime, hitTimes);
+
+   EXPECT_EQ(0, hitTimes[1]);
+   EXPECT_EQ(-1, hitTimes[2]);
+   EXPECT_EQ(-1, hitTimes[3]);
+
+   S32 hits = 0;
+
+   for(S32 i = 0; i < Count; i++)
+   {
+      Point p = pos - Point(x[i], y[i]);
+      F32 R = radius + radii[i];
+      F32 expected = -1;
+
+      if(vel.dot(p) < 0)
+      {
+         F32 t;
+         if(p.len() <= R)
+            expected = 0;
+         else if(findLowestRootInInterval(vel.dot(vel), 2 * p.dot(vel), p.dot(p) - R * R, maxTime, t))
+            expected = t;
+      }
+
+      if(expected == -1)
+         EXPECT_EQ(-1, hitTimes[i]) << "Circle " << i;
+      else
+      {
+         EXPECT_NEAR(expected, hitTimes[i], 0.0001f) << "Circle " << i;
+         hits++;
+      }
+   }
+
+   EXPECT_GT(hits, 0);
+}
+
 
 };
\ No newline at end of file
@@ -0,0 +1,833 @@
+//------------------------------------------------------------------------------
+// Copyright Chris Eykamp
+// See LICENSE.txt for full copyright information
+//------------------------------------------------------------------------------
+
+#include "../zap/gridDB.h"
+#include "../zap/BfObject.h"     // For TypeNumbers
+#include "../zap/GeomUtils.h"
+#include "../zap/moveObject.h"   // For ActualState
+#include "../zap/Zone.h"
+#include "gtest/gtest.h"
+
+#include "tnlRandom.h"
+
+#include <algorithm>
+#include <math.h>
+#include <thread>
+
+namespace Zap
+{
+
+using namespace std;
+using namespace TNL;
+
+
+// Bare-bones object we can put in a database without dragging a Game along
+class GridTestObject : public DatabaseObject
+{
+public:
+   GridTestObject(const Rect &extent, U8 typeNumber = TestItemTypeNumber)
+   {
+      mObjectTypeNumber = typeNumber;
+      setExtent(extent);
+   }
+
+   // What BfObject::deleteObject() does, minus the delete list
+   void markAsDeleted()
+   {
+      mObjectTypeNumber = DeletedTypeNumber;
+      getDatabase()->onObjectDeleted(this);
+   }
+};
+
+
+// Object with a square collision polygon filling its extent
+class GridTestWall : public GridTestObject
+{
+   Vector<Point> mPoly;
+
+public:
+   GridTestWall(const Rect &extent) : GridTestObject(extent, WallItemTypeNumber)
+   {
+      mPoly.push_back(extent.min);
+      mPoly.push_back(Point(extent.max.x, extent.min.y));
+      mPoly.push_back(extent.max);
+      mPoly.push_back(Point(extent.min.x, extent.max.y));
+   }
+
+   const Vector<Point> *getCollisionPoly() const { return &mPoly; }
+};
+
+
+static Rect squareAt(F32 x, F32 y, F32 size = 10)
+{
+   return Rect(Point(x, y), Point(x + size, y + size));
+}
+
+
+static Point randomPoint(F32 levelSize)
+{
+   return Point(TNL::Random::readF() * levelSize, TNL::Random::readF() * levelSize);
+}
+
+
+static bool isTestItemType(U8 x)
+{
+   return x == TestItemTypeNumber;
+}
+
+
+// Per-type lists must stay in step with the database as objects come and go
+TEST(GridDatabaseTest, TypeLists)
+{
+   const U8 types[] = { FlagTypeNumber, TestItemTypeNumber, AsteroidTypeNumber, BarrierTypeNumber, PolyWallTypeNumber };
+   const S32 typeCount = ARRAYSIZE(types);
+
+   GridDatabase db(false);
+   Vector<DatabaseObject *> objects;
+
+   for(S32 i = 0; i < 500; i++)
+   {
+      objects.push_back(new GridTestObject(squareAt(F32(i * 20), 0), types[i % typeCount]));
+      db.addToDatabase(objects.last());
+   }
+
+   // Remove a scattering of objects, in no particular order
+   for(S32 i = 0; i < 200; i++)
+   {
+      S32 index = TNL::Random::readI(0, objects.size() - 1);
+      db.removeFromDatabase(objects[index], true);
+      objects.erase_fast(index);
+   }
+
+   for(S32 i = 0; i < typeCount; i++)
+   {
+      S32 expected = 0;
+      for(S32 j = 0; j < objects.size(); j++)
+         if(objects[j]->getObjectTypeNumber() == types[i])
+            expected++;
+
+      EXPECT_EQ(expected, db.getObjectCount(types[i]));
+      EXPECT_EQ(expected, db.findObjects_fast(types[i])->size());
+      EXPECT_EQ(expected > 0, db.hasObjectOfType(types[i]));
+
+      for(S32 j = 0; j < db.findObjects_fast(types[i])->size(); j++)
+         EXPECT_EQ(types[i], db.findObjects_fast(types[i])->get(j)->getObjectTypeNumber());
+   }
+
+   EXPECT_FALSE(db.hasObjectOfType(TurretTypeNumber));
+   EXPECT_EQ(0, db.getObjectCount(TurretTypeNumber));
+
+   // Predicate searches should find the same objects they would by checking every object
+   Vector<DatabaseObject *> found;
+   db.findObjects((TestFunc)isWallType, found);
+
+   S32 expectedWalls = 0;
+   for(S32 i = 0; i < objects.size(); i++)
+      if(isWallType(objects[i]->getObjectTypeNumber()))
+         expectedWalls++;
+
+   EXPECT_EQ(expectedWalls, found.size());
+
+   Vector<U8> typeList;
+   typeList.push_back(FlagTypeNumber);
+   typeList.push_back(AsteroidTypeNumber);
+   typeList.push_back(FlagTypeNumber);       // Duplicates shouldn't produce duplicate results
+
+   found.clear();
+   db.findObjects(typeList, found);
+   EXPECT_EQ(db.getObjectCount(FlagTypeNumber) + db.getObjectCount(AsteroidTypeNumber), found.size());
+
+   // Objects marked as deleted drop out of type searches right away, even though they're still in the database
+   for(S32 i = 0; i < objects.size(); i += 3)
+      static_cast<GridTestObject *>(objects[i])->markAsDeleted();
+
+   // And everything comes out in the same order as a walk through every object would find it
+   const Vector<DatabaseObject *> &all = *db.findObjects_fast();
+   Vector<DatabaseObject *> expected;
+
+   for(S32 i = 0; i < all.size(); i++)
+      if(isWallType(all[i]->getObjectTypeNumber()))
+         expected.push_back(all[i]);
+
+   found.clear();
+   db.findObjects((TestFunc)isWallType, found);
+   ASSERT_EQ(expected.size(), found.size());
+   for(S32 i = 0; i < found.size(); i++)
+      EXPECT_EQ(expected[i], found[i]);
+
+   expected.clear();
+   for(S32 i = 0; i < all.size(); i++)
+      if(all[i]->getObjectTypeNumber() == FlagTypeNumber || all[i]->getObjectTypeNumber() == AsteroidTypeNumber)
+         expected.push_back(all[i]);
+
+   found.clear();
+   db.findObjects(typeList, found);
+   ASSERT_EQ(expected.size(), found.size());
+   for(S32 i = 0; i < found.size(); i++)
+      EXPECT_EQ(expected[i], found[i]);
+
+   expected.clear();
+   for(S32 i = 0; i < all.size(); i++)
+      if(all[i]->getObjectTypeNumber() == FlagTypeNumber)
+         expected.push_back(all[i]);
+
+   found.clear();
+   db.findObjects(FlagTypeNumber, found);
+   ASSERT_EQ(expected.size(), found.size());
+   for(S32 i = 0; i < found.size(); i++)
+      EXPECT_EQ(expected[i], found[i]);
+
+   for(S32 i = 0; i < db.findObjects_fast(FlagTypeNumber)->size(); i++)
+      EXPECT_FALSE(db.findObjects_fast(FlagTypeNumber)->get(i)->isDeleted());
+
+   // Deleted objects can still be removed from the database as usual
+   for(S32 i = 0; i < objects.size(); i += 3)
+      db.removeFromDatabase(objects[i], true);
+}
+
+
+// World extents are tracked as objects come, go and move; they should always match a full recalculation
+TEST(GridDatabaseTest, ExtentsTracking)
+{
+   GridDatabase db(false);
+   EXPECT_EQ(Rect(), db.getExtents());
+
+   Vector<GridTestObject *> objects;
+   Vector<Point> pos;
+
+   for(S32 step = 0; step < 3000; step++)
+   {
+      S32 action = TNL::Random::readI(0, 9);
+
+      if(objects.size() == 0 || action < 3)                         // Add, sometimes right on an existing edge
+      {
+         pos.push_back(action == 0 && objects.size() > 0 ? pos[0] : randomPoint(2000));
+         objects.push_back(new GridTestObject(squareAt(pos.last().x, pos.last().y)));
+         db.addToDatabase(objects.last());
+      }
+      else if(action < 5)                                           // Remove
+      {
+         S32 index = TNL::Random::readI(0, objects.size() - 1);
+         db.removeFromDatabase(objects[index], true);
+         objects.erase_fast(index);
+         pos.erase_fast(index);
+      }
+      else                                                          // Move, in or out
+      {
+         S32 index = TNL::Random::readI(0, objects.size() - 1);
+         pos[index] += Point(TNL::Random::readF() - 0.5f, TNL::Random::readF() - 0.5f) * 400;
+         objects[index]->setExtent(squareAt(pos[index].x, pos[index].y));
+      }
+
+      Rect expected;
+      for(S32 i = 0; i < objects.size(); i++)
+         if(i == 0)
+            expected = objects[i]->getExtent();
+         else
+            expected.unionRect(objects[i]->getExtent());
+
+      ASSERT_EQ(expected, db.getExtents());
+   }
+}
+
+
+// Objects a multiple of 16 cells apart used to share a bucket; make sure queries don't return any of them
+TEST(GridDatabaseTest, NoAliasingOnLargeLevels)
+{
+   GridDatabase db(false);
+
+   const F32 stride = 16 * 256;
+   for(S32 i = 0; i < 8; i++)
+      for(S32 j = 0; j < 8; j++)
+         db.addToDatabase(new GridTestObject(squareAt(i * stride + 5, j * stride + 5)));
+
+   Vector<DatabaseObject *> found;
+   db.findObjects((TestFunc)isTestItemType, found, Rect(Point(0, 0), Point(100, 100)));
+
+   ASSERT_EQ(1, found.size());
+   EXPECT_EQ(squareAt(5, 5), found[0]->getExtent());
+
+   // Only the cells that were used exist
+   EXPECT_EQ(64, db.getCellCount());
+}
+
+
+TEST(GridDatabaseTest, MovingObjectsChangeCells)
+{
+   GridDatabase db(false);
+
+   GridTestObject *obj = new GridTestObject(squareAt(0, 0));
+   db.addToDatabase(obj);
+
+   obj->setExtent(squareAt(10000, -7000));
+
+   Vector<DatabaseObject *> found;
+   db.findObjects((TestFunc)isTestItemType, found, squareAt(-50, -50, 100));
+   EXPECT_EQ(0, found.size());
+
+   db.findObjects((TestFunc)isTestItemType, found, squareAt(9950, -7050, 100));
+   ASSERT_EQ(1, found.size());
+   EXPECT_EQ(obj, found[0]);
+
+   db.removeFromDatabase(obj, true);
+
+   found.clear();
+   db.findObjects((TestFunc)isTestItemType, found, squareAt(9950, -7050, 100));
+   EXPECT_EQ(0, found.size());
+}
+
+
+// Objects covering huge areas go in a separate list, but should still be found by any query that touches them
+TEST(GridDatabaseTest, LargeObjects)
+{
+   GridDatabase db(false);
+
+   GridTestObject *huge = new GridTestObject(Rect(Point(-50000, -50000), Point(50000, 50000)));
+   db.addToDatabase(huge);
+   db.addToDatabase(new GridTestObject(squareAt(100, 100)));
+
+   Vector<DatabaseObject *> found;
+   db.findObjects((TestFunc)isTestItemType, found, squareAt(40000, 40000));
+   ASSERT_EQ(1, found.size());
+   EXPECT_EQ(huge, found[0]);
+
+   found.clear();
+   db.findObjects((TestFunc)isTestItemType, found, squareAt(95, 95));
+   EXPECT_EQ(2, found.size());
+
+   // Shrinking it moves it back into the grid
+   huge->setExtent(squareAt(-1000, -1000));
+
+   found.clear();
+   db.findObjects((TestFunc)isTestItemType, found, squareAt(40000, 40000));
+   EXPECT_EQ(0, found.size());
+
+   found.clear();
+   db.findObjects((TestFunc)isTestItemType, found, squareAt(-1000, -1000));
+   EXPECT_EQ(1, found.size());
+}
+
+
+// Two overlapping searches made with sameQuery should only report each object once
+TEST(GridDatabaseTest, SameQuerySkipsObjectsAlreadyFound)
+{
+   GridDatabase db(false);
+
+   db.addToDatabase(new GridTestObject(squareAt(0, 0, 1000)));   // Spans many cells, and both query rects
+   db.addToDatabase(new GridTestObject(squareAt(50, 50)));
+   db.addToDatabase(new GridTestObject(squareAt(900, 900)));
+
+   DatabaseQuery query;
+   db.findObjects(query, (TestFunc)isTestItemType, squareAt(0, 0, 100));
+   EXPECT_EQ(2, query.results.size());
+
+   db.findObjects(query, (TestFunc)isTestItemType, squareAt(850, 850, 100), true);
+   EXPECT_EQ(3, query.results.size());
+
+   // A fresh search finds everything again
+   query.results.clear();
+   db.findObjects(query, (TestFunc)isTestItemType, squareAt(850, 850, 100));
+   EXPECT_EQ(2, query.results.size());
+}
+
+
+// Mirrored circles belong to the object that set them; a new object in a recycled slot starts without one
+TEST(GridDatabaseTest, MirroredCircles)
+{
+   GridDatabase db(false);
+   GridDatabase other(false);
+
+   GridTestObject *a = new GridTestObject(squareAt(0, 0));
+   GridTestObject *b = new GridTestObject(squareAt(100, 100));
+   db.addToDatabase(a);
+   db.addToDatabase(b);
+
+   Point center;
+   F32 radius;
+   EXPECT_FALSE(db.getMirroredCircle(a, center, radius));
+
+   db.setMirroredCircle(a, Point(5, 5), 7);
+   ASSERT_TRUE(db.getMirroredCircle(a, center, radius));
+   EXPECT_EQ(Point(5, 5), center);
+   EXPECT_EQ(7, radius);
+
+   EXPECT_FALSE(db.getMirroredCircle(b, center, radius));
+   EXPECT_FALSE(other.getMirroredCircle(a, center, radius));
+
+   db.removeFromDatabase(a, true);
+
+   GridTestObject *c = new GridTestObject(squareAt(200, 200));
+   db.addToDatabase(c);       // Gets the slot a was using
+   EXPECT_FALSE(db.getMirroredCircle(c, center, radius));
+}
+
+
+// Populate a level of the given size with the same object density every time
+static void fillLevel(GridDatabase &db, F32 levelSize)
+{
+   const F32 spacing = 128;
+
+   for(F32 x = 0; x < levelSize; x += spacing)
+      for(F32 y = 0; y < levelSize; y += spacing)
+         db.addToDatabase(new GridTestObject(squareAt(x + TNL::Random::readF() * 100, y + TNL::Random::readF() * 100, 20)));
+}
+
+
+static S32 countBruteForce(GridDatabase &db, const Rect &rect)
+{
+   S32 count = 0;
+   const Vector<DatabaseObject *> *objects = db.findObjects_fast();
+
+   for(S32 i = 0; i < objects->size(); i++)
+      if(objects->get(i)->getExtent().intersects(rect))
+         count++;
+
+   return count;
+}
+
+
+TEST(GridDatabaseTest, ResizeGridKeepsResults)
+{
+   GridDatabase db(false);
+   fillLevel(db, 4096);
+
+   Rect query(Point(1000, 1200), Point(1800, 1500));
+   S32 expected = countBruteForce(db, query);
+
+   for(S32 shift = GridDatabase::MinCellShift; shift <= GridDatabase::MaxCellShift; shift++)
+   {
+      // A level this dense should prefer small cells; fake up extents that push the choice around
+      F32 size = F32(1 << shift) * 64;
+      db.resizeGrid(Rect(Point(0, 0), Point(size, size)));
+
+      Vector<DatabaseObject *> found;
+      db.findObjects((TestFunc)isTestItemType, found, query);
+      EXPECT_EQ(expected, found.size());
+   }
+}
+
+
+// Several threads searching the same database at once, each with its own DatabaseQuery, should all get correct answers
+TEST(GridDatabaseTest, ConcurrentQueries)
+{
+   const S32 ThreadCount = 4;
+
+   GridDatabase db(false);
+   fillLevel(db, 4096);
+
+   Rect rects[ThreadCount];
+   S32 expected[ThreadCount];
+   S32 mismatches[ThreadCount];
+
+   for(S32 i = 0; i < ThreadCount; i++)
+   {
+      rects[i] = squareAt(i * 700.0f, i * 500.0f, 900);
+      expected[i] = countBruteForce(db, rects[i]);
+      mismatches[i] = 0;
+   }
+
+   struct Worker
+   {
+      static void run(const GridDatabase *db, Rect rect, S32 expected, S32 *mismatches)
+      {
+         DatabaseQuery query;
+
+         for(S32 i = 0; i < 2000; i++)
+         {
+            query.results.clear();
+            db->findObjects(query, (TestFunc)isTestItemType, rect);
+
+            if(query.results.size() != expected)
+               (*mismatches)++;
+         }
+      }
+   };
+
+   std::thread threads[ThreadCount];
+   for(S32 i = 0; i < ThreadCount; i++)
+      threads[i] = std::thread(Worker::run, &db, rects[i], expected[i], &mismatches[i]);
+
+   for(S32 i = 0; i < ThreadCount; i++)
+   {
+      threads[i].join();
+      EXPECT_EQ(0, mismatches[i]);
+   }
+}
+
+
+// Scatter small walls around a level
+static void fillLevelWithWalls(GridDatabase &db, F32 levelSize, S32 count)
+{
+   for(S32 i = 0; i < count; i++)
+   {
+      Point p = randomPoint(levelSize);
+      db.addToDatabase(new GridTestWall(squareAt(p.x, p.y, 20 + TNL::Random::readF() * 60)));
+   }
+}
+
+
+// How findObjectLOS() used to work: gather everything in the ray's bounding box, then test each candidate
+static DatabaseObject *findObjectLOSByRect(GridDatabase &db, const Point &start, const Point &end, F32 &collisionTime)
+{
+   Vector<DatabaseObject *> candidates;
+   db.findObjects((TestFunc)isWallType, candidates, Rect(start, end));
+
+   DatabaseObject *hit = NULL;
+   collisionTime = 1;
+
+   for(S32 i = 0; i < candidates.size(); i++)
+   {
+      const Vector<Point> *poly = candidates[i]->getCollisionPoly();
+      F32 ct;
+      Point normal;
+
+      if(polygonIntersectsSegmentDetailed(&poly->first(), poly->size(), true, start, end, ct, normal) && ct < collisionTime)
+      {
+         collisionTime = ct;
+         hit = candidates[i];
+      }
+   }
+
+   return hit;
+}
+
+
+// Walking cells along the ray must find exactly what a brute force search does, for rays in every direction
+TEST(GridDatabaseTest, RaycastMatchesBruteForce)
+{
+   const F32 LevelSize = 8192;
+
+   GridDatabase db(false);
+   fillLevelWithWalls(db, LevelSize, 2000);
+   db.addToDatabase(new GridTestWall(Rect(Point(-20000, 3000), Point(20000, 3100))));   // One large object, too
+
+   DatabaseQuery query;
+   Vector<LOSRay> rays;
+
+   for(S32 i = 0; i < 2000; i++)
+   {
+      LOSRay ray;
+      ray.start = randomPoint(LevelSize * 1.2f) - Point(LevelSize * 0.1f, LevelSize * 0.1f);   // Some start off the map
+      ray.end   = randomPoint(LevelSize * 1.2f) - Point(LevelSize * 0.1f, LevelSize * 0.1f);
+      if(i % 10 == 0)
+         ray.end.x = ray.start.x;      // Axis-aligned rays are special cases for the walk
+      rays.push_back(ray);
+   }
+
+   db.findObjectsLOS(query, (TestFunc)isWallType, ActualState, true, rays);
+
+   for(S32 i = 0; i < rays.size(); i++)
+   {
+      F32 expectedTime;
+      DatabaseObject *expected = findObjectLOSByRect(db, rays[i].start, rays[i].end, expectedTime);
+
+      EXPECT_EQ(expected, rays[i].hitObject);
+      if(expected)
+         EXPECT_FLOAT_EQ(expectedTime, rays[i].collisionTime);
+
+      // Single ray version should agree with the batched one
+      F32 time;
+      Point normal;
+      EXPECT_EQ(expected, db.findObjectLOS((TestFunc)isWallType, ActualState, rays[i].start, rays[i].end, time, normal));
+   }
+}
+
+
+// Long sightlines across a big, busy map: walking the cells along each ray should look at fewer cells and objects than
+// searching its bounding box.  bitfighter_bench -grid has the timings.
+TEST(GridDatabaseTest, RaycastChecksLessThanBoundingBox)
+{
+   const F32 LevelSize = 16384;
+   const S32 RayCount = 2000;
+
+   GridDatabase db(false);
+   fillLevelWithWalls(db, LevelSize, 20000);
+   db.resizeGrid(Rect(Point(0, 0), Point(LevelSize, LevelSize)));
+
+   DatabaseQuery rectQuery, walkQuery;
+   F32 time;
+   Point normal;
+
+   for(S32 i = 0; i < RayCount; i++)
+   {
+      Point start = randomPoint(LevelSize);
+      Point end = start + Point(TNL::Random::readF() - 0.5f, TNL::Random::readF() - 0.5f) * 4000;
+
+      rectQuery.results.clear();
+      db.findObjects(rectQuery, (TestFunc)isWallType, Rect(start, end));
+
+      U32 cellsBefore = walkQuery.getCellsVisited();
+      db.findObjectLOS(walkQuery, (TestFunc)isWallType, ActualState, true, start, end, time, normal);
+
+      // The walk never needs more than the cells along the ray
+      Point delta = end - start;
+      F32 cellSize = F32(db.getCellSize());
+      EXPECT_LE(walkQuery.getCellsVisited() - cellsBefore, U32(fabs(delta.x) / cellSize + fabs(delta.y) / cellSize) + 3);
+   }
+
+   EXPECT_LT(walkQuery.getCellsVisited(), rectQuery.getCellsVisited() / 2);
+   EXPECT_LT(walkQuery.getObjectsChecked(), rectQuery.getObjectsChecked() / 2);
+}
+
+
+// Query cost should not grow with level size when object density stays the same.  We count the cells and listings
+// each query has to look at rather than timing them; bitfighter_bench -grid has the timings.
+TEST(GridDatabaseTest, QueryCostIsFlatAsLevelGrows)
+{
+   const S32 QueriesPerSide = 100;
+   const F32 levelSizes[] = { 2048, 8192, 16384 };
+   F64 cellsPerQuery[3], objectsPerQuery[3];
+
+   for(S32 i = 0; i < 3; i++)
+   {
+      GridDatabase db(false);
+      fillLevel(db, levelSizes[i]);
+      db.resizeGrid(Rect(Point(0, 0), Point(levelSizes[i], levelSizes[i])));
+
+      DatabaseQuery query;
+      F32 step = (levelSizes[i] - 400) / QueriesPerSide;
+
+      for(S32 x = 0; x < QueriesPerSide; x++)
+         for(S32 y = 0; y < QueriesPerSide; y++)
+         {
+            query.results.clear();
+            db.findObjects(query, (TestFunc)isTestItemType, squareAt(x * step, y * step, 400));
+         }
+
+      cellsPerQuery[i]   = F64(query.getCellsVisited())   / (QueriesPerSide * QueriesPerSide);
+      objectsPerQuery[i] = F64(query.getObjectsChecked()) / (QueriesPerSide * QueriesPerSide);
+   }
+
+   // 64x the objects should mean about the same amount of looking per query
+   for(S32 i = 1; i < 3; i++)
+   {
+      EXPECT_LE(cellsPerQuery[i], cellsPerQuery[0] * 1.5) << "Level size " << levelSizes[i];
+      EXPECT_LE(objectsPerQuery[i], objectsPerQuery[0] * 1.5) << "Level size " << levelSizes[i];
+   }
+}
+
+
+// Sorted copy of whatever a query finds, so results from differently organized databases can be compared
+static Vector<DatabaseObject *> findSorted(GridDatabase &db, TestFunc testFunc, const Rect &rect)
+{
+   Vector<DatabaseObject *> found;
+   db.findObjects(testFunc, found, rect);
+   std::sort(found.getStlVector().begin(), found.getStlVector().end());
+   return found;
+}
+
+
+// Moving walls into the static grid shouldn't change what anyone finds, even as objects come, go and move around
+TEST(GridDatabaseTest, StaticIndex)
+{
+   const F32 LevelSize = 8192;
+
+   GridDatabase db(false);
+   fillLevelWithWalls(db, LevelSize, 2000);
+   fillLevel(db, LevelSize);
+
+   Vector<Rect> rects;
+   Vector<Vector<DatabaseObject *> > expected;
+
+   for(S32 i = 0; i < 200; i++)
+   {
+      Point p = randomPoint(LevelSize);
+      rects.push_back(squareAt(p.x, p.y, 50 + TNL::Random::readF() * 1000));
+      expected.push_back(findSorted(db, (TestFunc)isAnyObjectType, rects.last()));
+   }
+
+   db.resizeGrid(Rect(Point(0, 0), Point(LevelSize, LevelSize)));
+   db.buildStaticIndex();
+   EXPECT_EQ(2000, db.getStaticObjectCount());     // All the walls, none of the test items
+
+   for(S32 i = 0; i < rects.size(); i++)
+   {
+      Vector<DatabaseObject *> found = findSorted(db, (TestFunc)isAnyObjectType, rects[i]);
+      ASSERT_EQ(expected[i].size(), found.size());
+      for(S32 j = 0; j < found.size(); j++)
+         EXPECT_EQ(expected[i][j], found[j]);
+   }
+
+   // Walls in the static grid must be hit by rays too
+   GridTestWall *wall = new GridTestWall(squareAt(-1000, -1000, 100));
+   db.addToDatabase(wall);
+   db.buildStaticIndex();
+   EXPECT_EQ(2001, db.getStaticObjectCount());
+
+   F32 time;
+   Point normal;
+   EXPECT_EQ(wall, db.findObjectLOS((TestFunc)isWallType, ActualState, Point(-1200, -950), Point(-800, -950), time, normal));
+
+   // A wall that moves leaves the static grid, and should only be found where it went
+   wall->setExtent(squareAt(-3000, -3000, 100));
+   EXPECT_EQ(2000, db.getStaticObjectCount());
+   EXPECT_EQ(0, findSorted(db, (TestFunc)isWallType, squareAt(-1000, -1000, 100)).size());
+   EXPECT_EQ(1, findSorted(db, (TestFunc)isWallType, squareAt(-3000, -3000, 100)).size());
+
+   // Walls added or removed after the static grid has been built
+   GridTestWall *lateWall = new GridTestWall(squareAt(-1000, -1000, 100));
+   db.addToDatabase(lateWall);
+   EXPECT_EQ(1, findSorted(db, (TestFunc)isWallType, squareAt(-1000, -1000, 100)).size());
+
+   Vector<DatabaseObject *> walls = findSorted(db, (TestFunc)isWallType, squareAt(0, 0, LevelSize));
+   for(S32 i = 0; i < walls.size(); i++)
+      db.removeFromDatabase(walls[i], true);
+
+   EXPECT_EQ(0, db.getStaticObjectCount());
+   EXPECT_EQ(0, findSorted(db, (TestFunc)isWallType, squareAt(0, 0, LevelSize)).size());
+   EXPECT_EQ(NULL, db.findObjectLOS((TestFunc)isWallType, ActualState, Point(0, 0), Point(LevelSize, LevelSize), time, normal));
+}
+
+
+// Moving objects around a heavily walled level: with the walls in the static grid, the cells movers have to be found
+// and erased from hold only other movers.  bitfighter_bench -grid has the timings.
+TEST(GridDatabaseTest, MovingObjectsWithStaticIndex)
+{
+   const F32 LevelSize = 8192;
+   const S32 WallCount = 40000;
+   const S32 MoverCount = 2000;
+   const S32 TickCount = 30;
+   S32 listings[2];
+
+   for(S32 pass = 0; pass < 2; pass++)
+   {
+      GridDatabase db(false);
+      fillLevelWithWalls(db, LevelSize, WallCount);
+
+      Vector<GridTestObject *> movers;
+      Vector<Point> pos, vel;
+
+      for(S32 i = 0; i < MoverCount; i++)
+      {
+         pos.push_back(randomPoint(LevelSize));
+         vel.push_back(Point(TNL::Random::readF() - 0.5f, TNL::Random::readF() - 0.5f) * 100);
+         movers.push_back(new GridTestObject(squareAt(pos[i].x, pos[i].y, 20)));
+         db.addToDatabase(movers[i]);
+      }
+
+      db.resizeGrid(Rect(Point(0, 0), Point(LevelSize, LevelSize)));
+      if(pass == 1)
+      {
+         db.buildStaticIndex();
+         EXPECT_EQ(WallCount, db.getStaticObjectCount());
+      }
+
+      for(S32 tick = 0; tick < TickCount; tick++)
+         for(S32 i = 0; i < MoverCount; i++)
+         {
+            pos[i] += vel[i];
+
+            if(pos[i].x < 0 || pos[i].x > LevelSize)     // Bounce off the edges of the level, so we stay among the walls
+               vel[i].x = -vel[i].x;
+            if(pos[i].y < 0 || pos[i].y > LevelSize)
+               vel[i].y = -vel[i].y;
+
+            movers[i]->setExtent(squareAt(pos[i].x, pos[i].y, 20));
+         }
+
+      listings[pass] = db.getCellListingCount();
+   }
+
+   EXPECT_GE(listings[0], WallCount + MoverCount);
+   EXPECT_LE(listings[1], MoverCount * 4);      // Movers are smaller than a cell, so touch 4 cells at most
+}
+
+
+static Zone *addZone(GridDatabase &db, const Vector<Point> &outline)
+{
+   Zone *zone = new Zone();
+   zone->GeomObject::setGeom(outline);
+   zone->setExtent(Rect(outline));
+   db.addToDatabase(zone);
+
+   return zone;
+}
+
+
+// Zones the index says pos is in should be exactly those whose outlines contain it
+static void checkZonesAt(const ZoneIndex &index, const Vector<Zone *> &zones, const Point &pos)
+{
+   Vector<SafePtr<Zone> > found;
+   index.findZones(index.getCell(pos), pos, found);
+
+   S32 expected = 0;
+   for(S32 i = 0; i < zones.size(); i++)
+   {
+      const Vector<Point> *outline = zones[i]->getCollisionPoly();
+
+      if(polygonContainsPoint(outline->address(), outline->size(), pos))
+      {
+         expected++;
+         EXPECT_TRUE(found.contains(SafePtr<Zone>(zones[i]))) << "Missed zone " << i << " at " << pos.toString();
+      }
+   }
+
+   EXPECT_EQ(expected, found.size()) << "at " << pos.toString();
+}
+
+
+TEST(GridDatabaseTest, ZoneIndex)
+{
+   GridDatabase db(false);
+   Vector<Zone *> zones;
+   Vector<Point> outline;
+
+   // Concave L shape
+   outline.push_back(Point(0, 0));     outline.push_back(Point(900, 0));   outline.push_back(Point(900, 200));
+   outline.push_back(Point(200, 200)); outline.push_back(Point(200, 900)); outline.push_back(Point(0, 900));
+   zones.push_back(addZone(db, outline));
+
+   // Overlapping triangle
+   outline.clear();
+   outline.push_back(Point(100, 100)); outline.push_back(Point(700, 150)); outline.push_back(Point(300, 800));
+   zones.push_back(addZone(db, outline));
+
+   // Self-intersecting bowtie, which won't triangulate
+   outline.clear();
+   outline.push_back(Point(500, 500)); outline.push_back(Point(800, 800));
+   outline.push_back(Point(800, 500)); outline.push_back(Point(500, 800));
+   zones.push_back(addZone(db, outline));
+
+   ZoneIndex index;
+   U32 generation = index.refresh(&db);
+
+   EXPECT_EQ(-1, index.getCell(Point(-500, -500)));
+   EXPECT_EQ(-1, index.getCell(Point(5000, 0)));
+
+   for(S32 i = 0; i < 20000; i++)
+      checkZonesAt(index, zones, Point(TNL::Random::readF() * 1000 - 50, TNL::Random::readF() * 1000 - 50));
+
+   // Nothing changed, nothing to do
+   EXPECT_EQ(generation, index.refresh(&db));
+
+   // Refreshing a zone's extent without changing its geometry is no reason to rebuild
+   zones[1]->setExtent(zones[1]->getExtent());
+   EXPECT_EQ(generation, index.refresh(&db));
+
+   // Moving a zone is noticed
+   outline.clear();
+   outline.push_back(Point(2000, 2000)); outline.push_back(Point(2300, 2000)); outline.push_back(Point(2300, 2300));
+   zones[1]->GeomObject::setGeom(outline);
+   zones[1]->onGeomChanged();
+
+   EXPECT_NE(generation, index.refresh(&db));
+   generation = index.refresh(&db);
+
+   checkZonesAt(index, zones, Point(2250, 2100));
+   checkZonesAt(index, zones, Point(300, 150));
+
+   // So is removing one
+   db.removeFromDatabase(zones[0], true);
+   zones.erase(0);
+
+   EXPECT_NE(generation, index.refresh(&db));
+
+   for(S32 i = 0; i < 2000; i++)
+      checkZonesAt(index, zones, Point(TNL::Random::readF() * 2500, TNL::Random::readF() * 2500));
+}
+
+
+};
+
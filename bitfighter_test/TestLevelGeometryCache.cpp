@@ -0,0 +1,160 @@
+//------------------------------------------------------------------------------
+// Copyright Chris Eykamp
+// See LICENSE.txt for full copyright information
+//------------------------------------------------------------------------------
+
+#include "../zap/LevelGeometryCache.h"
+#include "../zap/stringUtils.h"
+
+#include "gtest/gtest.h"
+
+#include <stdio.h>
+
+namespace Zap
+{
+
+using namespace std;
+using namespace TNL;
+
+
+static Vector<WallRec> makeWalls()
+{
+   Vector<WallRec> walls;
+
+   Vector<F32> verts;
+   verts.push_back(0);      verts.push_back(0);
+   verts.push_back(100.5f); verts.push_back(-3.25f);
+   walls.push_back(WallRec(50, false, verts));
+
+   verts.push_back(1.0f / 3); verts.push_back(1e6f);
+   walls.push_back(WallRec(1, true, verts));
+
+   walls.push_back(WallRec(10, false, Vector<F32>()));    // Never gets sent, so doesn't count
+
+   return walls;
+}
+
+
+TEST(LevelGeometryCacheTest, Hash)
+{
+   Vector<WallRec> walls = makeWalls();
+   string hash = LevelGeometryCache::getWallsHash(walls);
+
+   EXPECT_EQ(32, hash.length());
+
+   walls.erase(2);      // Dropping the empty wall changes nothing
+   EXPECT_EQ(hash, LevelGeometryCache::getWallsHash(walls));
+
+   walls[1].width = 2;
+   EXPECT_NE(hash, LevelGeometryCache::getWallsHash(walls));
+}
+
+
+TEST(LevelGeometryCacheTest, SaveAndLoad)
+{
+   string folder = "LevelGeometryCacheTest";
+
+   Vector<WallRec> walls = makeWalls();
+   string hash = LevelGeometryCache::getWallsHash(walls);
+
+   Vector<Point> edges;
+   edges.push_back(Point(0, 0));
+   edges.push_back(Point(100.5f, 1.0f / 3));
+
+   Vector<string> evicted;
+
+   LevelGeometryCache cache(folder);
+   EXPECT_FALSE(cache.addLevel("0123456789abcdef0123456789abcdef", walls, edges, evicted));   // Hash doesn't match walls
+   EXPECT_TRUE(cache.addLevel(hash, walls, edges, evicted));
+   EXPECT_FALSE(cache.addLevel(hash, walls, edges, evicted));                                 // Already have it
+   EXPECT_EQ(0, evicted.size());
+
+   // A fresh cache should find what we wrote, exactly as we wrote it
+   LevelGeometryCache loaded(folder);
+   loaded.loadAll();
+   ASSERT_EQ(1, loaded.getLevelCount());
+
+   const LevelGeometryCache::CachedLevel *level = loaded.getLevel(hash);
+   ASSERT_TRUE(level != NULL);
+   ASSERT_EQ(2, level->walls.size());
+   ASSERT_EQ(walls[1].verts.size(), level->walls[1].verts.size());
+   for(S32 i = 0; i < walls[1].verts.size(); i++)
+      EXPECT_EQ(walls[1].verts[i], level->walls[1].verts[i]);
+   EXPECT_EQ(walls[1].width, level->walls[1].width);
+   EXPECT_TRUE(level->walls[1].solid);
+   ASSERT_EQ(2, level->edges.size());
+   EXPECT_EQ(edges[1], level->edges[1]);
+
+   // A damaged file gets ignored
+   string filename = joindir(folder, hash + ".walls");
+   writeFile(filename, "2 50 0 4 0 0 100.5 -3.25 1 1 0 0");
+   loaded.loadAll();
+   EXPECT_EQ(0, loaded.getLevelCount());
+
+   remove(filename.c_str());
+   remove(joindir(folder, "recently_used.txt").c_str());
+}
+
+
+// Walls that differ only in the width of the first one
+static Vector<WallRec> makeWalls(S32 id)
+{
+   Vector<WallRec> walls = makeWalls();
+   walls[0].width = F32(id + 1);
+   return walls;
+}
+
+
+TEST(LevelGeometryCacheTest, EvictsLeastRecentlyUsed)
+{
+   string folder = "LevelGeometryCacheEvictionTest";
+   S32 maxLevels = LevelGeometryCache::MaxLevels;
+
+   Vector<Point> edges;
+   Vector<string> hashes;
+   Vector<string> evicted;
+
+   LevelGeometryCache cache(folder);
+
+   for(S32 i = 0; i < maxLevels; i++)
+   {
+      Vector<WallRec> walls = makeWalls(i);
+      hashes.push_back(LevelGeometryCache::getWallsHash(walls));
+      ASSERT_TRUE(cache.addLevel(hashes[i], walls, edges, evicted));
+   }
+
+   EXPECT_EQ(0, evicted.size());
+
+   // Playing the oldest level again saves it; the next oldest goes instead
+   cache.markUsed(hashes[0]);
+
+   Vector<WallRec> walls = makeWalls(maxLevels);
+   string newHash = LevelGeometryCache::getWallsHash(walls);
+   EXPECT_TRUE(cache.addLevel(newHash, walls, edges, evicted));
+
+   ASSERT_EQ(1, evicted.size());
+   EXPECT_EQ(hashes[1], evicted[0]);
+   EXPECT_EQ(maxLevels, cache.getLevelCount());
+   EXPECT_TRUE(cache.getLevel(hashes[1]) == NULL);
+   EXPECT_FALSE(fileExists(joindir(folder, hashes[1] + ".walls")));
+
+   // The order survives a reload, so hashes[2] is next to go
+   LevelGeometryCache loaded(folder);
+   loaded.loadAll();
+   EXPECT_EQ(maxLevels, loaded.getLevelCount());
+
+   evicted.clear();
+   walls = makeWalls(maxLevels + 1);
+   EXPECT_TRUE(loaded.addLevel(LevelGeometryCache::getWallsHash(walls), walls, edges, evicted));
+   ASSERT_EQ(1, evicted.size());
+   EXPECT_EQ(hashes[2], evicted[0]);
+
+   Vector<string> remaining;
+   loaded.getHashes(remaining);
+   for(S32 i = 0; i < remaining.size(); i++)
+      remove(joindir(folder, remaining[i] + ".walls").c_str());
+   remove(joindir(folder, "recently_used.txt").c_str());
+}
+
+
+};
@@ -0,0 +1,73 @@
+//------------------------------------------------------------------------------
+// Copyright Chris Eykamp
+// See LICENSE.txt for full copyright information
+//------------------------------------------------------------------------------
+
+#include "tnlNetInterface.h"
+#include "tnlNetConnection.h"
+#include "tnlPlatform.h"
+
+#include "gtest/gtest.h"
+
+namespace Zap
+{
+
+using namespace std;
+using namespace TNL;
+
+
+// Nothing but a handshake
+class HandshakeTestConnection : public NetConnection
+{
+public:
+   TNL_DECLARE_NETCONNECTION(HandshakeTestConnection);
+};
+
+TNL_IMPLEMENT_NETCONNECTION(HandshakeTestConnection, NetClassGroupGame, true);
+
+
+// Connects a client to a server over localhost, returning true once both ends agree they're connected
+static bool connect(U32 checkThreads)
+{
+   NetInterface server(Address(IPProtocol, Address::Any, 0));
+   NetInterface client(Address(IPProtocol, Address::Any, 0));
+
+   server.setConnectCheckThreadCount(checkThreads);
+
+   Address serverAddress("IP:127.0.0.1:0");
+   serverAddress.port = server.getSocket().getBoundAddress().port;
+
+   RefPtr<HandshakeTestConnection> conn = new HandshakeTestConnection;
+   conn->connect(&client, serverAddress);
+
+   for(S32 i = 0; i < 5000; i++)
+   {
+      client.checkIncomingPackets();
+      client.processConnections();
+      server.checkIncomingPackets();
+      server.processConnections();
+
+      if(conn->isEstablished() && server.getConnectionList().size() == 1)
+         return server.getPendingConnectCheckCount() == 0;
+
+      Platform::sleep(1);
+   }
+
+   return false;
+}
+
+
+// The puzzle solution gets checked on a worker thread, and the connection set up back on this one
+TEST(NetInterfaceTest, ConnectChecksOnWorkerThreads)
+{
+   EXPECT_TRUE(connect(2));
+}
+
+
+TEST(NetInterfaceTest, ConnectChecksOnMainThread)
+{
+   EXPECT_TRUE(connect(0));
+}
+
+
+};
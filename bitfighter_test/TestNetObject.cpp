@@ -0,0 +1,224 @@
+//------------------------------------------------------------------------------
+// Copyright Chris Eykamp
+// See LICENSE.txt for full copyright information
+//------------------------------------------------------------------------------
+
+#include "tnlNetObject.h"
+#include "tnlGhostConnection.h"
+
+#include "gtest/gtest.h"
+
+namespace Zap
+{
+
+using namespace std;
+using namespace TNL;
+
+
+class SharedUpdateObject : public NetObject
+{
+public:
+   S32 packCount;
+   U32 value;
+
+   SharedUpdateObject()
+   {
+      mNetFlags.set(Ghostable | SharedUpdates);
+      packCount = 0;
+      value = 0x12345;
+   }
+
+   U32 packUpdate(GhostConnection *connection, U32 updateMask, BitStream *stream)
+   {
+      packCount++;
+
+      if(stream->writeFlag(updateMask & BIT(0)))
+         stream->writeInt(value, 20);
+
+      stream->writeFlag(updateMask & BIT(1));
+      return updateMask & BIT(2);
+   }
+
+   U32 pack(U32 updateMask, BitStream *stream)
+   {
+      return packSharedUpdate(NULL, updateMask, stream);
+   }
+};
+
+
+// Packs the object twice, starting at different bit offsets, and checks both match a direct packUpdate
+TEST(NetObjectTest, SharedUpdates)
+{
+   SharedUpdateObject object;
+
+   U8 directBuffer[64], firstBuffer[64], secondBuffer[64];
+   BitStream direct(directBuffer, sizeof(directBuffer));
+   BitStream first(firstBuffer, sizeof(firstBuffer));
+   BitStream second(secondBuffer, sizeof(secondBuffer));
+
+   NetObject::collapseDirtyList();
+
+   second.writeInt(5, 3);     // Knock it off byte alignment
+
+   EXPECT_EQ(BIT(2), object.pack(BIT(0) | BIT(2), &first));
+   EXPECT_EQ(BIT(2), object.pack(BIT(0) | BIT(2), &second));
+   EXPECT_EQ(1, object.packCount);
+
+   object.packUpdate(NULL, BIT(0) | BIT(2), &direct);
+
+   ASSERT_EQ(direct.getBitPosition(), first.getBitPosition());
+   ASSERT_EQ(direct.getBitPosition() + 3, second.getBitPosition());
+
+   direct.setBitPosition(0);
+   first.setBitPosition(0);
+   second.setBitPosition(3);
+
+   for(U32 i = 0; i < 22; i++)
+   {
+      bool bit = direct.readFlag();
+      EXPECT_EQ(bit, first.readFlag());
+      EXPECT_EQ(bit, second.readFlag());
+   }
+
+   // A different mask needs packing on its own
+   object.pack(BIT(1), &first);
+   EXPECT_EQ(3, object.packCount);
+
+   // And once the dirty list is collapsed, state may have changed, so everything gets packed again
+   NetObject::collapseDirtyList();
+   object.value = 7;
+   object.pack(BIT(0) | BIT(2), &first);
+   EXPECT_EQ(4, object.packCount);
+}
+
+
+// Records a baseline with every update, the way MoveObject does, and can be made too big to fit in a packet
+class BaselineTestObject : public NetObject
+{
+public:
+   S32 value;
+   bool oversized;
+   bool hadAckedBaseline;     // What happened during the most recent packUpdate
+   S32 recordedSlot;
+
+   BaselineTestObject()
+   {
+      mNetFlags.set(Ghostable);
+      value = 0;
+      oversized = false;
+      hadAckedBaseline = false;
+      recordedSlot = -1;
+   }
+
+   void performScopeQuery(GhostConnection *connection)
+   {
+      connection->objectInScope(this);
+   }
+
+   U32 packUpdate(GhostConnection *connection, U32 updateMask, BitStream *stream)
+   {
+      S32 slot;
+      hadAckedBaseline = connection->getAckedBaseline(slot) != NULL;
+      recordedSlot = connection->recordBaseline(&value, 1);
+
+      stream->writeInt(value, 16);
+
+      if(oversized)
+         for(S32 i = 0; i < 200; i++)
+            stream->writeInt(0, 32);
+
+      return 0;
+   }
+
+   TNL_DECLARE_CLASS(BaselineTestObject);
+};
+
+TNL_IMPLEMENT_NETOBJECT(BaselineTestObject);
+
+
+// Ghosts to nobody; packets are written and then acked by hand
+class BaselineTestConnection : public GhostConnection
+{
+public:
+   BaselineTestConnection()
+   {
+      NetClassRep::initialize();    // Gives our object class its id, if no NetInterface has done so yet
+
+      setGhostFrom(true);
+      setTranslatesStrings();
+
+      mGhostClassCount = NetClassRep::getNetClassCount(getNetClassGroup(), NetClassTypeObject);
+      mGhostClassBitSize = getNextBinLog2(mGhostClassCount);
+      mScoping = true;
+      mGhosting = true;
+   }
+
+   NetClassGroup getNetClassGroup() const { return NetClassGroupGame; }
+
+   // Writes a packet and acks it right away
+   void writeAndAck()
+   {
+      PacketNotify *note = allocNotify();
+      note->nextPacket = NULL;
+      mNotifyQueueHead = mNotifyQueueTail = note;
+
+      PacketStream stream;
+
+      // Stands in for the header and such that come before the ghosts in a real packet
+      for(S32 i = 0; i < 8; i++)
+         stream.writeInt(0, 32);
+
+      NetObject::collapseDirtyList();
+      prepareWritePacket();
+      writePacket(&stream, note);
+
+      mNotifyQueueHead = mNotifyQueueTail = NULL;
+      packetReceived(note);
+      delete note;
+   }
+};
+
+
+// An update that doesn't fit gets rewound; the baseline it recorded mustn't keep its slot tied up forever
+TEST(NetObjectTest, BaselineSurvivesRewoundUpdates)
+{
+   BaselineTestObject object;
+   BaselineTestConnection connection;
+   connection.setScopeObject(&object);
+
+   connection.writeAndAck();
+   EXPECT_FALSE(object.hadAckedBaseline);
+   EXPECT_NE(-1, object.recordedSlot);
+
+   object.value = 1;
+   object.setMaskBits(BIT(0));
+   connection.writeAndAck();
+   EXPECT_TRUE(object.hadAckedBaseline);
+
+   // Keeps getting rewound, more times than there are slots
+   object.oversized = true;
+   for(S32 i = 0; i < GhostConnection::BaselineSlotCount * 2; i++)
+   {
+      object.value = i + 2;
+      object.setMaskBits(BIT(0));
+      connection.writeAndAck();
+   }
+
+   // Once it fits again, it goes back to recording baselines the client will keep
+   object.oversized = false;
+   object.setMaskBits(BIT(0));
+   connection.writeAndAck();
+   EXPECT_TRUE(object.hadAckedBaseline);
+   S32 slot = object.recordedSlot;
+   EXPECT_NE(-1, slot);
+
+   // And that one was acked, so the next goes somewhere else
+   object.setMaskBits(BIT(0));
+   connection.writeAndAck();
+   EXPECT_TRUE(object.hadAckedBaseline);
+   EXPECT_NE(-1, object.recordedSlot);
+   EXPECT_NE(slot, object.recordedSlot);
+}
+
+
+};
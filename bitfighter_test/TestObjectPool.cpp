@@ -0,0 +1,84 @@
+//------------------------------------------------------------------------------
+// Copyright Chris Eykamp
+// See LICENSE.txt for full copyright information
+//------------------------------------------------------------------------------
+
+#include "../zap/ObjectPool.h"
+
+#include "gtest/gtest.h"
+
+namespace Zap
+{
+
+using namespace std;
+using namespace TNL;
+
+
+struct PooledThing
+{
+   BF_DECLARE_POOLED_CLASS;
+
+   F32 stuff[8];
+   virtual ~PooledThing() { }
+};
+
+BF_IMPLEMENT_POOLED_CLASS(PooledThing);
+
+
+struct BiggerThing : public PooledThing
+{
+   F32 moreStuff[8];
+};
+
+
+TEST(ObjectPoolTest, Recycling)
+{
+   ObjectPool *pool = PooledThing::getObjectPool();
+   U32 heapAllocations = pool->getHeapAllocations();
+
+   PooledThing *things[10];
+   for(S32 i = 0; i < 10; i++)
+      things[i] = new PooledThing();
+
+   EXPECT_EQ(10, pool->getLiveCount());
+   EXPECT_EQ(heapAllocations + 10, pool->getHeapAllocations());
+
+   for(S32 i = 0; i < 10; i++)
+      delete things[i];
+
+   EXPECT_EQ(0, pool->getLiveCount());
+
+   // Once warmed up, coming and going doesn't touch the heap
+   for(S32 round = 0; round < 100; round++)
+   {
+      for(S32 i = 0; i < 10; i++)
+         things[i] = new PooledThing();
+      for(S32 i = 0; i < 10; i++)
+         delete things[i];
+   }
+
+   EXPECT_EQ(heapAllocations + 10, pool->getHeapAllocations());
+   EXPECT_EQ(1000, pool->getReuses());
+
+   Vector<string> lines;
+   ObjectPool::getReport(lines);
+   EXPECT_TRUE(lines.contains("PooledThing: 0 live, 10 from heap, 1000 reused"));
+}
+
+
+TEST(ObjectPoolTest, Subclasses)
+{
+   ObjectPool *pool = PooledThing::getObjectPool();
+   U32 heapAllocations = pool->getHeapAllocations();
+
+   // Subclasses don't fit in the pool's blocks, so they bypass it entirely
+   PooledThing *thing = new BiggerThing();
+   EXPECT_EQ(0, pool->getLiveCount());
+   delete thing;
+
+   EXPECT_EQ(0, pool->getLiveCount());
+   EXPECT_EQ(heapAllocations, pool->getHeapAllocations());
+}
+
+
+};
@@ -0,0 +1,92 @@
+//------------------------------------------------------------------------------
+// Copyright Chris Eykamp
+// See LICENSE.txt for full copyright information
+//------------------------------------------------------------------------------
+
+#include "tnlUDP.h"
+#include "tnlPlatform.h"
+
+#include "gtest/gtest.h"
+
+namespace Zap
+{
+
+using namespace std;
+using namespace TNL;
+
+
+// Reads whatever arrives at socket over the next second or so, until we've got expected packets
+static S32 receivePackets(Socket &socket, S32 expected, Vector<Vector<U8> > &packets)
+{
+   U8 data[Socket::MaxBatchSize][MaxPacketDataSize];
+   U8 *buffers[Socket::MaxBatchSize];
+   Address addresses[Socket::MaxBatchSize];
+   S32 sizes[Socket::MaxBatchSize];
+
+   for(S32 i = 0; i < Socket::MaxBatchSize; i++)
+      buffers[i] = data[i];
+
+   for(S32 tries = 0; tries < 100 && packets.size() < expected; tries++)
+   {
+      socket.waitForData(10000);
+
+      S32 count = socket.recvBatch(addresses, buffers, MaxPacketDataSize, sizes, Socket::MaxBatchSize);
+
+      for(S32 i = 0; i < count; i++)
+         packets.push_back(Vector<U8>(data[i], sizes[i]));
+   }
+
+   return packets.size();
+}
+
+
+TEST(SocketTest, BatchedSendAndReceive)
+{
+   Socket receiver(Address(IPProtocol, Address::Any, 0));
+   Socket sender(Address(IPProtocol, Address::Any, 0));
+
+   ASSERT_TRUE(receiver.isValid());
+   ASSERT_TRUE(sender.isValid());
+
+   Address destination("IP:127.0.0.1:0");
+   destination.port = receiver.getBoundAddress().port;
+
+   // More than fit in one batch, each a different size so we can tell them apart
+   const S32 PacketCount = Socket::MaxBatchSize + 8;
+
+   U8 data[PacketCount][100];
+   const U8 *buffers[PacketCount];
+   Address addresses[PacketCount];
+   S32 sizes[PacketCount];
+
+   for(S32 i = 0; i < PacketCount; i++)
+   {
+      memset(data[i], i, sizeof(data[i]));
+      buffers[i] = data[i];
+      addresses[i] = destination;
+      sizes[i] = i + 1;
+   }
+
+   EXPECT_EQ(PacketCount, sender.sendBatch(addresses, buffers, sizes, PacketCount));
+
+   Vector<Vector<U8> > packets;
+   ASSERT_EQ(PacketCount, receivePackets(receiver, PacketCount, packets));
+
+   for(S32 i = 0; i < PacketCount; i++)
+   {
+      ASSERT_EQ(i + 1, packets[i].size());
+      EXPECT_EQ(i, packets[i][0]);
+   }
+
+   EXPECT_EQ(PacketCount, sender.getStats().packetsSent);
+   EXPECT_EQ(PacketCount, receiver.getStats().packetsReceived);
+
+#ifdef TNL_OS_LINUX
+   // Two sendmmsg calls should have covered everything
+   EXPECT_EQ(2, sender.getStats().sendCalls);
+   EXPECT_LT(receiver.getStats().receiveCalls, PacketCount);
+#endif
+}
+
+
+};
@@ -0,0 +1,127 @@
+//------------------------------------------------------------------------------
+// Copyright Chris Eykamp
+// See LICENSE.txt for full copyright information
+//------------------------------------------------------------------------------
+
+#include "../zap/TickProfiler.h"
+
+#include "tnlPlatform.h"
+
+#include "gtest/gtest.h"
+
+namespace Zap
+{
+
+using namespace std;
+using namespace TNL;
+
+
+// The profiler reads this instead of the real timer, so time only passes when a test says so
+static S64 fakeTime = 0;
+
+static S64 getFakeTime()
+{
+   return fakeTime;
+}
+
+
+static const S64 Step = 1000;    // In timer units
+
+static void advance(S32 steps)
+{
+   fakeTime += steps * Step;
+}
+
+
+static F64 stepsToMs(S32 steps)
+{
+   return Platform::getHighPrecisionMilliseconds(steps * Step);
+}
+
+
+class TickProfilerTest : public testing::Test
+{
+protected:
+   virtual void SetUp()
+   {
+      TickProfiler::setTimer(getFakeTime);
+      TickProfiler::reset();
+   }
+
+   virtual void TearDown()
+   {
+      TickProfiler::setTimer(NULL);
+   }
+};
+
+
+TEST_F(TickProfilerTest, OnlyCountsInsideTicks)
+{
+   {
+      ProfileScope scope(TickProfiler::PhaseLua);
+      advance(1);
+   }
+
+   EXPECT_EQ(0, TickProfiler::getPhaseMs(TickProfiler::PhaseLua));
+
+   Vector<string> lines;
+   TickProfiler::getReport(lines);
+   ASSERT_EQ(1, lines.size());
+   EXPECT_EQ("No ticks recorded", lines[0]);
+}
+
+
+TEST_F(TickProfilerTest, NestedScopes)
+{
+   TickProfiler::beginTick();
+   advance(1);       // Not inside any phase
+
+   {
+      ProfileScope outer(TickProfiler::PhaseRobots);
+      advance(2);
+
+      {
+         ProfileScope inner(TickProfiler::PhaseLua);
+         advance(3);
+
+         // Recursing into a phase that's already open shouldn't count its time twice
+         ProfileScope again(TickProfiler::PhaseRobots);
+         advance(4);
+      }
+   }
+
+   TickProfiler::endTick(true);
+
+   // Each phase only gets the time nothing nested inside it claimed
+   EXPECT_EQ(stepsToMs(6), TickProfiler::getPhaseMs(TickProfiler::PhaseRobots));
+   EXPECT_EQ(stepsToMs(3), TickProfiler::getPhaseMs(TickProfiler::PhaseLua));
+   EXPECT_EQ(0, TickProfiler::getPhaseMs(TickProfiler::PhaseServerIdle));
+
+   Vector<string> lines;
+   TickProfiler::getReport(lines);
+   ASSERT_EQ(TickProfiler::PhaseCount + 1, lines.size());
+   EXPECT_EQ(0, lines[0].find("1 ticks"));
+   EXPECT_EQ(0, lines[TickProfiler::PhaseRobots + 1].find("robot ticks: "));
+}
+
+
+TEST_F(TickProfilerTest, SkippedTicks)
+{
+   TickProfiler::beginTick();
+   {
+      ProfileScope scope(TickProfiler::PhaseNetwork);
+      advance(1);
+   }
+   TickProfiler::endTick(false);
+
+   // Time still gets added up, but the tick stays out of the histograms
+   EXPECT_EQ(stepsToMs(1), TickProfiler::getPhaseMs(TickProfiler::PhaseNetwork));
+
+   Vector<string> lines;
+   TickProfiler::getReport(lines);
+   ASSERT_EQ(1, lines.size());
+   EXPECT_EQ("No ticks recorded", lines[0]);
+}
+
+
+};
@@ -0,0 +1,94 @@
+//------------------------------------------------------------------------------
+// Copyright Chris Eykamp
+// See LICENSE.txt for full copyright information
+//------------------------------------------------------------------------------
+
+#include "../zap/TickScheduler.h"
+
+#include "gtest/gtest.h"
+
+namespace Zap
+{
+
+using namespace std;
+using namespace TNL;
+
+
+TEST(TickSchedulerTest, TickLengthsAddUp)
+{
+   TickScheduler scheduler(60);
+
+   // First call starts the schedule and runs one tick right away
+   EXPECT_EQ(1, scheduler.getTicksDue(0));
+
+   // 60 ticks of 16 or 17ms each should add up to exactly one second
+   U32 total = 0;
+   for(S32 i = 0; i < 60; i++)
+   {
+      U32 length = scheduler.getTickLength();
+      EXPECT_TRUE(length == 16 || length == 17);
+      total += length;
+   }
+   EXPECT_EQ(1000, total);
+}
+
+
+TEST(TickSchedulerTest, Deadlines)
+{
+   TickScheduler scheduler(100);    // 10ms ticks
+
+   EXPECT_EQ(1, scheduler.getTicksDue(1000));
+   EXPECT_DOUBLE_EQ(10, scheduler.getTimeUntilNextTick(1000));
+   EXPECT_DOUBLE_EQ(3.5, scheduler.getTimeUntilNextTick(1006.5));
+
+   // Nothing due until the deadline
+   EXPECT_EQ(0, scheduler.getTicksDue(1009.9));
+   EXPECT_EQ(1, scheduler.getTicksDue(1010.5));
+
+   // Waking up late doesn't shift the schedule
+   EXPECT_DOUBLE_EQ(9.5, scheduler.getTimeUntilNextTick(1010.5));
+   EXPECT_EQ(2, scheduler.getTicksDue(1030.2));
+   EXPECT_NEAR(9.8, scheduler.getTimeUntilNextTick(1030.2), 1e-9);
+
+   EXPECT_EQ(4, scheduler.getTicksRun());
+   EXPECT_EQ(0, scheduler.getTicksDropped());
+   EXPECT_NEAR(10.2, scheduler.getMaxLateness(), 1e-9);
+}
+
+
+TEST(TickSchedulerTest, BoundedCatchUp)
+{
+   TickScheduler scheduler(100);
+   scheduler.setMaxCatchUpTicks(3);
+
+   EXPECT_EQ(1, scheduler.getTicksDue(0));
+
+   // A 100ms stall has 10 ticks due, but we only run 3 and drop the rest
+   EXPECT_EQ(3, scheduler.getTicksDue(100));
+   EXPECT_EQ(7, scheduler.getTicksDropped());
+
+   // Schedule stays on its original phase
+   EXPECT_DOUBLE_EQ(10, scheduler.getTimeUntilNextTick(100));
+   EXPECT_EQ(1, scheduler.getTicksDue(110));
+
+   // Reporting resets the stats
+   EXPECT_FALSE(scheduler.isReportDue(110));
+   EXPECT_TRUE(scheduler.isReportDue(60000));
+   EXPECT_NE(string::npos, scheduler.getJitterReport(60000).find("7 dropped"));
+   EXPECT_EQ(0, scheduler.getTicksRun());
+   EXPECT_EQ(0, scheduler.getTicksDropped());
+   EXPECT_FALSE(scheduler.isReportDue(60000));
+}
+
+
+TEST(TickSchedulerTest, Disabled)
+{
+   TickScheduler scheduler;
+
+   EXPECT_EQ(0, scheduler.getTicksDue(0));
+   EXPECT_EQ(0, scheduler.getTicksDue(1000));
+   EXPECT_DOUBLE_EQ(0, scheduler.getTimeUntilNextTick(1000));
+}
+
+
+};
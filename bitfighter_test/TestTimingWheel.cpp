@@ -0,0 +1,119 @@
+//------------------------------------------------------------------------------
+// Copyright Chris Eykamp
+// See LICENSE.txt for full copyright information
+//------------------------------------------------------------------------------
+
+#include "../zap/TimingWheel.h"
+
+#include "gtest/gtest.h"
+
+namespace Zap
+{
+
+using namespace std;
+using namespace TNL;
+
+
+TEST(TimingWheelTest, Expiry)
+{
+   TimingWheel<S32> wheel;
+   Vector<S32> expired;
+
+   // Like a countdown timer, an item comes out once the elapsed time goes past its delay
+   wheel.schedule(1, 0);
+   wheel.schedule(2, 10);
+   wheel.schedule(3, 300);
+   wheel.schedule(4, 70000);
+   EXPECT_EQ(4, wheel.getCount());
+
+   wheel.advance(1, expired);
+   ASSERT_EQ(1, expired.size());
+   EXPECT_EQ(1, expired[0]);
+
+   wheel.advance(9, expired);
+   EXPECT_EQ(1, expired.size());
+   wheel.advance(1, expired);
+   ASSERT_EQ(2, expired.size());
+   EXPECT_EQ(2, expired[1]);
+
+   // Crosses into the second wheel's territory
+   wheel.advance(289, expired);
+   EXPECT_EQ(2, expired.size());
+   wheel.advance(1, expired);
+   ASSERT_EQ(3, expired.size());
+   EXPECT_EQ(3, expired[2]);
+
+   // ...and the third
+   for(S32 i = 0; i < 6969; i++)
+      wheel.advance(10, expired);
+   wheel.advance(9, expired);
+   EXPECT_EQ(3, expired.size());
+   wheel.advance(1, expired);
+   ASSERT_EQ(4, expired.size());
+   EXPECT_EQ(4, expired[3]);
+
+   EXPECT_EQ(0, wheel.getCount());
+}
+
+
+TEST(TimingWheelTest, MatchesCountdown)
+{
+   TimingWheel<S32> wheel;
+   Vector<S32> expired;
+
+   // Compare against the straightforward list of countdowns we used to keep for the delete list
+   Vector<S32> remaining;
+   Vector<S32> ids;
+
+   U32 seed = 12345;
+   for(S32 tick = 0; tick < 2000; tick++)
+   {
+      for(S32 j = 0; j < 3; j++)
+      {
+         seed = seed * 1103515245 + 12345;
+         S32 delay = (seed >> 8) % 5000;
+
+         wheel.schedule(ids.size(), delay);
+         remaining.push_back(delay);
+         ids.push_back(ids.size());
+      }
+
+      U32 timeDelta = 10 + (tick % 25);
+
+      Vector<S32> expectedExpired;
+      for(S32 i = 0; i < remaining.size(); i++)
+         if(remaining[i] >= 0)
+         {
+            if(timeDelta > U32(remaining[i]))
+            {
+               expectedExpired.push_back(ids[i]);
+               remaining[i] = -1;
+            }
+            else
+               remaining[i] -= timeDelta;
+         }
+
+      expired.clear();
+      wheel.advance(timeDelta, expired);
+
+      ASSERT_EQ(expectedExpired.size(), expired.size());
+
+      // Order within a tick follows deadlines rather than scheduling order, so compare as sets
+      for(S32 i = 0; i < expectedExpired.size(); i++)
+         EXPECT_TRUE(expired.contains(expectedExpired[i]));
+   }
+
+   // Emptying the wheel hands back everything that's left
+   S32 left = 0;
+   for(S32 i = 0; i < remaining.size(); i++)
+      if(remaining[i] >= 0)
+         left++;
+
+   expired.clear();
+   wheel.removeAll(expired);
+   EXPECT_EQ(left, expired.size());
+   EXPECT_EQ(0, wheel.getCount());
+}
+
+
+};
@@ -160,11 +160,13 @@ end
 
 
 -- Checks the current time and fires any scheduled events. This is called by the C++ code.
+-- Returns the time until the next event is due, or nil if there are none, so C++ knows
+-- when it next needs to call us.
 function Timer:_tick(timeDelta)
    self.time = self.time + timeDelta
 
    -- Return if there are no events
-   if #self.queue == 0 then return end
+   if #self.queue == 0 then return nil end
 
    -- Check the front of the queue for events that need to be fired.  Remember that
    -- events are sorted by time so as soon as we find an event that doesn't need to
@@ -203,6 +205,12 @@ function Timer:_tick(timeDelta)
       -- Check the next item, now at the front of the queue
       record = self.queue[1]
    end
+
+   if record then
+      return record.time - now
+   end
+
+   return nil
 end
 
 
@@ -235,5 +243,5 @@ Timer:_initialize()     -- Actually intialize the timer
 -- this Timer... updates timers
 --
 function _tickTimer(self, deltaT)
-   Timer:_tick(deltaT)
+   return Timer:_tick(deltaT)
 end
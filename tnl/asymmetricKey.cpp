@@ -146,16 +146,17 @@ ByteBufferPtr AsymmetricKey::computeSharedSecretKey(AsymmetricKey *publicKey)
    if(publicKey->getKeySize() != getKeySize() || !mHasPrivateKey)
       return NULL;
 
+   // Uses its own buffer rather than staticCryptoBuffer, since connect requests are checked on worker threads
+   U8 secretBuffer[StaticCryptoBufferSize];
    U8 hash[32];
-   unsigned long outLen = sizeof(staticCryptoBuffer);
+   unsigned long outLen = sizeof(secretBuffer);
 
-   TIME_BLOCK(secretSubKeyGen,
    crypto_shared_secret((crypto_key *) mKeyData, (crypto_key *) publicKey->mKeyData,
-      staticCryptoBuffer, &outLen);
-   )
+      secretBuffer, &outLen);
+
    hash_state hashState;
    sha256_init(&hashState);
-   sha256_process(&hashState, staticCryptoBuffer, outLen);
+   sha256_process(&hashState, secretBuffer, outLen);
    sha256_done(&hashState, hash);
    ByteBuffer *ret = new ByteBuffer(hash, 32);
    ret->takeOwnership();
@@ -134,15 +134,20 @@ bool ClientPuzzleManager::checkOneSolution(U32 solution, Nonce &clientNonce, Non
    return (mask & hash[index]) == 0;
 }
 
+ClientPuzzleManager::NonceTable *ClientPuzzleManager::findNonceTable(Nonce &serverNonce)
+{
+   if(serverNonce == mCurrentNonce)
+      return mCurrentNonceTable;
+   else if(serverNonce == mLastNonce)
+      return mLastNonceTable;
+   return NULL;
+}
+
 ClientPuzzleManager::ErrorCode ClientPuzzleManager::checkSolution(U32 solution, Nonce &clientNonce, Nonce &serverNonce, U32 puzzleDifficulty, U32 clientIdentity)
 {
    if(puzzleDifficulty != mCurrentDifficulty)
       return InvalidPuzzleDifficulty;
-   NonceTable *theTable = NULL;
-   if(serverNonce == mCurrentNonce)
-      theTable = mCurrentNonceTable;
-   else if(serverNonce == mLastNonce)
-      theTable = mLastNonceTable;
+   NonceTable *theTable = findNonceTable(serverNonce);
    if(!theTable)
       return InvalidServerNonce;
    if(!checkOneSolution(solution, clientNonce, serverNonce, puzzleDifficulty, clientIdentity))
@@ -152,6 +157,18 @@ ClientPuzzleManager::ErrorCode ClientPuzzleManager::checkSolution(U32 solution,
    return Success;
 }
 
+ClientPuzzleManager::ErrorCode ClientPuzzleManager::claimSolution(Nonce &clientNonce, Nonce &serverNonce, U32 puzzleDifficulty)
+{
+   if(puzzleDifficulty != mCurrentDifficulty)
+      return InvalidPuzzleDifficulty;
+   NonceTable *theTable = findNonceTable(serverNonce);
+   if(!theTable)
+      return InvalidServerNonce;
+   if(!theTable->checkAdd(clientNonce))
+      return InvalidClientNonce;
+   return Success;
+}
+
 bool ClientPuzzleManager::solvePuzzle(U32 *solution, Nonce &clientNonce, Nonce &serverNonce, U32 puzzleDifficulty, U32 clientIdentity)
 {
    U32 startTime = Platform::getRealMilliseconds();
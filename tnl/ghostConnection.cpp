@@ -33,6 +33,8 @@
 
 namespace TNL {
 
+ClassChunker<GhostConnection::GhostRef> GhostConnection::mGhostRefChunker;
+
 GhostConnection::GhostConnection()
 {
    // ghost management data:
@@ -43,6 +45,10 @@ GhostConnection::GhostConnection()
    mGhostLookupTable = NULL;
    mGhostZeroUpdateIndex = 0;
 
+   mPackingGhost = NULL;
+   mPackingBaselineSlot = -1;
+   mBaselinePacket = 0;
+
    mGhostFrom = false;
    mGhostTo = false;
 }
@@ -143,7 +149,15 @@ void GhostConnection::packetDropped(PacketNotify *pnotify)
          packRef->ghost->flags &= ~GhostInfo::KillingGhost;
       }
 
-      delete packRef;
+      // The client never got the state recorded with this update, so its slot can be used again
+      if(packRef->baselineSlot >= 0)
+      {
+         GhostBaseline *baseline = packRef->ghost->baseline;
+         if(baseline && baseline->sentPacket[packRef->baselineSlot] == notify->baselinePacket)
+            baseline->sentPacket[packRef->baselineSlot] = 0;
+      }
+
+      mGhostRefChunker.free(packRef);
       packRef = temp;
    }
 }
@@ -177,19 +191,47 @@ void GhostConnection::packetReceived(PacketNotify *pnotify)
       else if(packRef->ghostInfoFlags & GhostInfo::KillingGhost)
          freeGhostInfo(packRef->ghost);
 
-      delete packRef;
+      // The state the object recorded with this update is on the client now, and replaces the one it had before
+      if(packRef->baselineSlot >= 0)
+      {
+         GhostBaseline *baseline = packRef->ghost->baseline;
+         if(baseline && baseline->sentPacket[packRef->baselineSlot] == notify->baselinePacket)
+         {
+            if(baseline->ackedSlot >= 0)
+               baseline->sentPacket[baseline->ackedSlot] = 0;
+
+            baseline->ackedSlot = packRef->baselineSlot;
+         }
+      }
+
+      mGhostRefChunker.free(packRef);
       packRef = temp;
    }
 }
 
-static S32 QSORT_CALLBACK UQECompare(const void *a,const void *b)
+static bool hasLowerPriority(const GhostInfo *a, const GhostInfo *b)
 {
-   GhostInfo *ga = *((GhostInfo **) a);
-   GhostInfo *gb = *((GhostInfo **) b);
+   return a->priority < b->priority;
+}
 
-   F32 ret = ga->priority - gb->priority;
-   return (ret < 0) ? -1 : ((ret > 0) ? 1 : 0);
-} 
+/// Moves the batchSize highest priority ghosts among the first count in mGhostArray to the end of that
+/// range, sorted by priority, and returns the index of the first of them.  Usually only a few dozen updates
+/// fit in a packet, so this is a lot less work than sorting every ghost that wants updating.
+S32 GhostConnection::selectHighestPriorities(S32 count, S32 batchSize)
+{
+   GhostInfo **ghosts = mGhostArray.address();
+   S32 first = count > batchSize ? count - batchSize : 0;
+
+   if(first > 0)
+      std::nth_element(ghosts, ghosts + first, ghosts + count, hasLowerPriority);
+
+   std::sort(ghosts + first, ghosts + count, hasLowerPriority);
+
+   for(S32 i = 0; i < count; i++)
+      ghosts[i]->arrayIndex = i;
+
+   return first;
+}
 
 void GhostConnection::prepareWritePacket()
 {
@@ -259,6 +301,9 @@ void GhostConnection::writePacket(BitStream *bstream, PacketNotify *pnotify)
    
    if(!bstream->writeFlag(mGhosting && mScopeObject.isValid()))
       return;
+
+   mBaselinePacket++;
+   notify->baselinePacket = mBaselinePacket;
       
    // fill a packet (or two) with ghosting data
 
@@ -301,11 +346,6 @@ void GhostConnection::writePacket(BitStream *bstream, PacketNotify *pnotify)
          walk->priority = 0;
    }
    GhostRef *updateList = NULL;
-   if(mGhostZeroUpdateIndex != 0)
-      qsort(&mGhostArray[0], mGhostZeroUpdateIndex, sizeof(GhostInfo *), UQECompare);
-   // reset the array indices...
-   for(S32 i = mGhostZeroUpdateIndex - 1; i >= 0; i--)
-      mGhostArray[i]->arrayIndex = i;
 
    U8 sendSize = 0;
    while(maxIndex != 0)
@@ -321,8 +361,18 @@ void GhostConnection::writePacket(BitStream *bstream, PacketNotify *pnotify)
 
    U32 count = 0;
    bool have_something_to_send = bstream->getBitPosition() >= 256;
+   // Ghosts from here up are in priority order; we sort more, a batch at a time, as we get to them
+   S32 sortedIndex = mGhostZeroUpdateIndex;
+   S32 batchSize = PriorityBatchSize;
+
    for(S32 i = mGhostZeroUpdateIndex - 1; i >= 0 && !bstream->isFull(); i--)
    {
+      if(i < sortedIndex)
+      {
+         sortedIndex = selectHighestPriorities(i + 1, batchSize);
+         batchSize *= 2;
+      }
+
       GhostInfo *walk = mGhostArray[i];
       if(walk->flags & (GhostInfo::KillingGhost | GhostInfo::Ghosting))
          continue;
@@ -331,6 +381,7 @@ void GhostConnection::writePacket(BitStream *bstream, PacketNotify *pnotify)
       U32 updateMask = walk->updateMask;
       U32 retMask = 0;
       ConnectionStringTable::PacketEntry *strEntry = getCurrentWritePacketNotify()->stringList.stringTail;;
+      mPackingBaselineSlot = -1;
 
       bstream->writeFlag(true);
       if(!BitSizeWritten)
@@ -355,8 +406,13 @@ void GhostConnection::writePacket(BitStream *bstream, PacketNotify *pnotify)
             bstream->writeInt(classId, mGhostClassBitSize);
             NetObject::mIsInitialUpdate = true;
          }
-         // update the object
-         retMask = walk->obj->packUpdate(this, updateMask, bstream);
+         // update the object -- objects that don't care who they're talking to are only packed once per mask
+         mPackingGhost = walk;
+         if(walk->obj->mNetFlags.test(NetObject::SharedUpdates))
+            retMask = walk->obj->packSharedUpdate(this, updateMask, bstream);
+         else
+            retMask = walk->obj->packUpdate(this, updateMask, bstream);
+         mPackingGhost = NULL;
 
          if(NetObject::mIsInitialUpdate)
          {
@@ -382,6 +438,13 @@ void GhostConnection::writePacket(BitStream *bstream, PacketNotify *pnotify)
          TNLAssert(have_something_to_send || bstream->getBitPosition() < mWriteMaxBitSize, "Packet too big to send");
          if(have_something_to_send)
          {
+            // The baseline this update recorded won't go out, so free its slot for next time
+            if(mPackingBaselineSlot >= 0)
+            {
+               walk->baseline->sentPacket[mPackingBaselineSlot] = 0;
+               mPackingBaselineSlot = -1;
+            }
+
             bstream->setBitPosition(updateStart);
             bstream->clearError();
             break;
@@ -391,7 +454,7 @@ void GhostConnection::writePacket(BitStream *bstream, PacketNotify *pnotify)
 
       // otherwise, create a record of this ghost update and
       // attach it to the packet.
-      GhostRef *upd = new GhostRef;
+      GhostRef *upd = mGhostRefChunker.alloc();
 
       upd->nextRef = updateList;
       updateList = upd;
@@ -403,6 +466,7 @@ void GhostConnection::writePacket(BitStream *bstream, PacketNotify *pnotify)
       upd->ghost = walk;
       upd->ghostInfoFlags = 0;
       upd->updateChain = NULL;
+      upd->baselineSlot = mPackingBaselineSlot;
 
       if(walk->flags & GhostInfo::KillGhost)
       {
@@ -706,6 +770,10 @@ void GhostConnection::objectInScope(NetObject *obj)
    giptr->lastUpdateChain = NULL;
    giptr->updateSkipCount = 0;
 
+   // Whatever the last object to use this GhostInfo recorded means nothing to the new ghost
+   if(giptr->baseline)
+      giptr->baseline->reset();
+
    giptr->connection = this;
 
    giptr->nextObjectRef = obj->mFirstObjectRef;
@@ -811,7 +879,7 @@ void GhostConnection::clearGhostInfo()
       while(delWalk)
       {
          GhostRef *next = delWalk->nextRef;
-         delete delWalk;
+         mGhostRefChunker.free(delWalk);
          delWalk = next;
       }
    }
@@ -824,7 +892,10 @@ void GhostConnection::clearGhostInfo()
    TNLAssert((mGhostFreeIndex == 0) && (mGhostZeroUpdateIndex == 0), "Invalid indices.");
 
    for(U32 j = 0; j < U32(mGhostRefs.size()); j++)
+   {
+      delete mGhostRefs[j]->baseline;
       delete mGhostRefs[j];
+   }
    mGhostRefs.clear();
    mGhostArray.clear();
 }
@@ -877,6 +948,44 @@ S32 GhostConnection::getGhostIndex(NetObject *obj)
    return -1;
 }
 
+const S32 *GhostConnection::getAckedBaseline(S32 &slot)
+{
+   if(!mPackingGhost || !mPackingGhost->baseline || mPackingGhost->baseline->ackedSlot < 0)
+      return NULL;
+
+   slot = mPackingGhost->baseline->ackedSlot;
+   return mPackingGhost->baseline->values[slot];
+}
+
+S32 GhostConnection::recordBaseline(const S32 *values, S32 count)
+{
+   TNLAssert(count <= MaxBaselineValues, "Too many baseline values");
+
+   if(!mPackingGhost)
+      return -1;
+
+   if(!mPackingGhost->baseline)
+      mPackingGhost->baseline = new GhostBaseline();
+
+   GhostBaseline *baseline = mPackingGhost->baseline;
+
+   // If every slot is either acked or still in flight, this state just doesn't become a baseline
+   S32 slot = 0;
+   while(slot < BaselineSlotCount && (slot == baseline->ackedSlot || baseline->sentPacket[slot] != 0))
+      slot++;
+
+   if(slot == BaselineSlotCount)
+      return -1;
+
+   for(S32 i = 0; i < count; i++)
+      baseline->values[slot][i] = values[i];
+
+   baseline->sentPacket[slot] = mBaselinePacket;
+   mPackingBaselineSlot = slot;
+
+   return slot;
+}
+
 //-----------------------------------------------------------------------------
 
 void GhostConnection::onStartGhosting()
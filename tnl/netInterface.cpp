@@ -33,10 +33,128 @@
 #include "tnlNetObject.h"
 #include "tnlClientPuzzle.h"
 #include "tnlCertificate.h"
+#include "tnlThread.h"
 #include <tomcrypt.h>
 
 namespace TNL {
 
+/// A connect request on its way through checkConnectRequest() and finishConnectRequest().  It holds its
+/// own copy of the packet, since the rest of the packet can't be read until the key exchange is done.
+struct ConnectRequestCheck
+{
+   Address address;
+   ConnectionParameters params;
+
+   U8 packet[MaxPacketDataSize];
+   U32 packetSize;
+   U32 bitPosition;        ///< Where reading the packet picks up again
+
+   bool puzzleSolved;
+   bool keysValid;
+
+   ConnectRequestCheck(const Address &theAddress, const ConnectionParameters &theParams, BitStream *stream)
+   {
+      address = theAddress;
+      params = theParams;
+
+      packetSize = stream->getBufferSize();
+      memcpy(packet, stream->getBuffer(), packetSize);
+      bitPosition = stream->getBitPosition();
+
+      puzzleSolved = false;
+      keysValid = true;
+   }
+
+   /// Moves a stream made on our copy of the packet up to the part that hasn't been read yet
+   void resumeReading(BitStream &stream)
+   {
+      stream.setMaxSizes(packetSize, 0);
+      stream.reset();
+      stream.setBitPosition(bitPosition);
+   }
+};
+
+/// Checks connect requests on worker threads, and hands them back to the NetInterface when they're done.
+/// Checks are only ever created, finished and deleted on the main thread.
+class ConnectRequestQueue : public ThreadQueue
+{
+   /// Runs the check on a worker thread, then sends it back to the main thread
+   struct CheckCall : public Functor
+   {
+      ConnectRequestCheck *mCheck;
+
+      CheckCall(ConnectRequestCheck *check) { mCheck = check; }
+      ~CheckCall() { delete mCheck; }
+
+      void read(BitStream &stream) { }
+      void write(BitStream &stream) { }
+      void dispatch(Object *t)
+      {
+         ConnectRequestCheck *check = mCheck;
+         mCheck = NULL;    // finishing it belongs to the FinishCall now
+         static_cast<ConnectRequestQueue *>(t)->runCheck(check);
+      }
+   };
+
+   /// Runs on the main thread once the check is done
+   struct FinishCall : public Functor
+   {
+      ConnectRequestCheck *mCheck;
+
+      FinishCall(ConnectRequestCheck *check) { mCheck = check; }
+      ~FinishCall() { delete mCheck; }
+
+      void read(BitStream &stream) { }
+      void write(BitStream &stream) { }
+      void dispatch(Object *t) { static_cast<ConnectRequestQueue *>(t)->finishCheck(mCheck); }
+   };
+
+   NetInterface *mInterface;
+   Vector<ConnectRequestCheck *> mPendingChecks;
+
+   void runCheck(ConnectRequestCheck *check)
+   {
+      NetInterface::checkConnectRequest(check);
+      postCall(new FinishCall(check));
+   }
+
+   void finishCheck(ConnectRequestCheck *check)
+   {
+      for(S32 i = 0; i < mPendingChecks.size(); i++)
+         if(mPendingChecks[i] == check)
+         {
+            mPendingChecks.erase_fast(i);
+            break;
+         }
+
+      mInterface->finishConnectRequest(check);
+   }
+
+public:
+   ConnectRequestQueue(NetInterface *theInterface, U32 threadCount) : ThreadQueue(threadCount)
+   {
+      mInterface = theInterface;
+   }
+
+   void addCheck(ConnectRequestCheck *check)
+   {
+      mPendingChecks.push_back(check);
+      postCall(new CheckCall(check));
+   }
+
+   /// Returns true if we're already checking a request with this nonce from this address
+   bool isPending(const Address &address, const Nonce &nonce)
+   {
+      for(S32 i = 0; i < mPendingChecks.size(); i++)
+         if(mPendingChecks[i]->address == address && mPendingChecks[i]->params.mNonce == nonce)
+            return true;
+
+      return false;
+   }
+
+   S32 getPendingCount() { return mPendingChecks.size(); }
+};
+
 //-----------------------------------------------------------------------------
 // NetInterface initialization/destruction
 //-----------------------------------------------------------------------------
@@ -55,17 +173,30 @@ NetInterface::NetInterface(const Address &bindAddress) : mSocket(bindAddress)
    for(S32 i = 0; i < mConnectionHashTable.size(); i++)
       mConnectionHashTable[i] = NULL;
    mSendPacketList = NULL;
+   mSendQueueCount = 0;
    mCurrentTime = Platform::getRealMilliseconds();
+
+   mConnectRequestQueue = NULL;
+#ifdef TNL_NO_THREADS
+   mConnectCheckThreadCount = 0;
+#else
+   mConnectCheckThreadCount = DefaultConnectCheckThreadCount;
+#endif
 }
 
 NetInterface::~NetInterface()
 {
+   // stop checking connect requests before the connections they'd be added to go away
+   delete mConnectRequestQueue;
+
    // gracefully close all the connections on this NetInterface:
    while(mConnectionList.size())
    {
       NetConnection *c = mConnectionList[0];
       disconnect(c, NetConnection::ReasonShutdown, "");
    }
+   flushSendQueue();
+
    while(mSendPacketList)
    {
       DelaySendPacket *next = mSendPacketList->nextPacket;
@@ -104,7 +235,32 @@ void NetInterface::setPrivateKey(AsymmetricKey *theKey)
 
 NetError NetInterface::sendto(const Address &address, BitStream *stream)
 {
-   return mSocket.sendto(address, stream->getBuffer(), stream->getBytePosition());
+   U32 dataSize = stream->getBytePosition();
+
+   TNLAssert(dataSize <= MaxPacketDataSize, "Packet too big to send!");
+
+   if(mSendQueueCount == Socket::MaxBatchSize)
+      flushSendQueue();
+
+   memcpy(mSendQueueBuffers[mSendQueueCount], stream->getBuffer(), dataSize);
+   mSendQueueAddresses[mSendQueueCount] = address;
+   mSendQueueSizes[mSendQueueCount] = dataSize;
+   mSendQueueCount++;
+
+   return NoError;
+}
+
+void NetInterface::flushSendQueue()
+{
+   if(mSendQueueCount == 0)
+      return;
+
+   const U8 *buffers[Socket::MaxBatchSize];
+   for(S32 i = 0; i < mSendQueueCount; i++)
+      buffers[i] = mSendQueueBuffers[i];
+
+   mSocket.sendBatch(mSendQueueAddresses, buffers, mSendQueueSizes, mSendQueueCount);
+   mSendQueueCount = 0;
 }
 
 void NetInterface::sendtoDelayed(const Address *address, NetConnection *receiveTo, BitStream *stream, U32 millisecondDelay)
@@ -326,6 +482,10 @@ void NetInterface::processConnections()
    mCurrentTime = Platform::getRealMilliseconds();
    mPuzzleManager.tick(mCurrentTime);
 
+   // set up the connections for any connect requests that have been checked
+   if(mConnectRequestQueue)
+      mConnectRequestQueue->dispatchResponseCalls();
+
    // first see if there are any delayed packets that need to be sent...
    while(mSendPacketList && S32(mSendPacketList->sendTime - getCurrentTime()) < 0)
    {
@@ -438,6 +598,8 @@ void NetInterface::processConnections()
          break;
       }
    }
+
+   flushSendQueue();
 }
 
 //-----------------------------------------------------------------------------
@@ -446,15 +608,30 @@ void NetInterface::processConnections()
 
 void NetInterface::checkIncomingPackets()
 {
-   PacketStream stream;
-   NetError error;
-   Address sourceAddress;
+   U8 *buffers[Socket::MaxBatchSize];
+   for(S32 i = 0; i < Socket::MaxBatchSize; i++)
+      buffers[i] = mReceiveBuffers[i];
 
    mCurrentTime = Platform::getRealMilliseconds();
 
-   // read out all the available packets:
-   while((error = stream.recvfrom(mSocket, &sourceAddress)) == NoError)
-      processPacket(sourceAddress, &stream);
+   // read out all the available packets, a batch at a time:
+   S32 count;
+   do
+   {
+      count = mSocket.recvBatch(mReceiveAddresses, buffers, MaxPacketDataSize, mReceiveSizes, Socket::MaxBatchSize);
+
+      for(S32 i = 0; i < count; i++)
+      {
+         BitStream stream(mReceiveBuffers[i], mReceiveSizes[i]);
+         stream.setMaxSizes(mReceiveSizes[i], 0);
+         stream.reset();
+
+         processPacket(mReceiveAddresses[i], &stream);
+      }
+   } while(count == Socket::MaxBatchSize);
+
+   // Send any replies right away
+   flushSendQueue();
 }
 
 void NetInterface::processPacket(const Address &sourceAddress, BitStream *pStream)
@@ -680,6 +857,23 @@ void NetInterface::continuePuzzleSolution(NetConnection *conn)
    }
 }
 
+//-----------------------------------------------------------------------------
+// NetInterface connect request checking
+//-----------------------------------------------------------------------------
+
+void NetInterface::setConnectCheckThreadCount(U32 count)
+{
+   delete mConnectRequestQueue;
+   mConnectRequestQueue = NULL;
+
+   mConnectCheckThreadCount = count;
+}
+
+S32 NetInterface::getPendingConnectCheckCount()
+{
+   return mConnectRequestQueue ? mConnectRequestQueue->getPendingCount() : 0;
+}
+
 //-----------------------------------------------------------------------------
 // NetInterface connect request
 //-----------------------------------------------------------------------------
@@ -767,16 +961,9 @@ void NetInterface::handleConnectRequest(const Address &address, BitStream *strea
       }
    }
 
-   // Check the puzzle solution
-   ClientPuzzleManager::ErrorCode result = mPuzzleManager.checkSolution(
-      theParams.mPuzzleSolution, theParams.mNonce, theParams.mServerNonce,
-      theParams.mPuzzleDifficulty, theParams.mClientIdentity);
-
-   if(result != ClientPuzzleManager::Success)      // Wrong answer!
-   {
-      sendConnectReject(&theParams, address, NetConnection::ReasonPuzzle);
+   // A client that hasn't heard back yet will send the same request again; we only need to check it once
+   if(mConnectRequestQueue && mConnectRequestQueue->isPending(address, theParams.mNonce))
       return;
-   }
 
    if(stream->readFlag())
    {
@@ -784,29 +971,98 @@ void NetInterface::handleConnectRequest(const Address &address, BitStream *strea
          return;
 
       theParams.mUsingCrypto = true;
-      theParams.mPublicKey = new AsymmetricKey(stream);
       theParams.mPrivateKey = mPrivateKey;
+   }
 
-      U32 decryptPos = stream->getBytePosition();
+   if(mConnectCheckThreadCount == 0)
+   {
+      ConnectRequestCheck check(address, theParams, stream);
+      checkConnectRequest(&check);
+      finishConnectRequest(&check);
+      return;
+   }
 
-      stream->setBytePosition(decryptPos);
-      theParams.mSharedSecret = theParams.mPrivateKey->computeSharedSecretKey(theParams.mPublicKey);
+   if(!mConnectRequestQueue)
+      mConnectRequestQueue = new ConnectRequestQueue(this, mConnectCheckThreadCount);
 
-      SymmetricCipher theCipher(theParams.mSharedSecret);
+   if(mConnectRequestQueue->getPendingCount() >= MaxPendingConnectChecks)
+      return;
 
-      if(!stream->decryptAndCheckHash(NetConnection::MessageSignatureBytes, decryptPos, &theCipher))
-         return;
+   mConnectRequestQueue->addCheck(new ConnectRequestCheck(address, theParams, stream));
+}
 
-      // Read the first part of the connection's symmetric key
-      stream->read(SymmetricCipher::KeySize, theParams.mSymmetricKey);
-      Random::read(theParams.mInitVector, SymmetricCipher::KeySize);
+void NetInterface::checkConnectRequest(ConnectRequestCheck *check)
+{
+   ConnectionParameters &theParams = check->params;
+
+   check->puzzleSolved = ClientPuzzleManager::checkOneSolution(theParams.mPuzzleSolution, theParams.mNonce,
+      theParams.mServerNonce, theParams.mPuzzleDifficulty, theParams.mClientIdentity);
+
+   if(!check->puzzleSolved || !theParams.mUsingCrypto)
+      return;
+
+   check->keysValid = false;
+
+   BitStream stream(check->packet, check->packetSize);
+   check->resumeReading(stream);
+
+   theParams.mPublicKey = new AsymmetricKey(&stream);
+   if(!theParams.mPublicKey->isValid())
+      return;
+
+   U32 decryptPos = stream.getBytePosition();
+
+   stream.setBytePosition(decryptPos);
+   theParams.mSharedSecret = theParams.mPrivateKey->computeSharedSecretKey(theParams.mPublicKey);
+
+   if(theParams.mSharedSecret.isNull())      // Key sizes don't match
+      return;
+
+   SymmetricCipher theCipher(theParams.mSharedSecret);
+
+   if(!stream.decryptAndCheckHash(NetConnection::MessageSignatureBytes, decryptPos, &theCipher))
+      return;
+
+   // Read the first part of the connection's symmetric key
+   stream.read(SymmetricCipher::KeySize, theParams.mSymmetricKey);
+
+   check->packetSize = stream.getBufferSize();
+   check->bitPosition = stream.getBitPosition();
+   check->keysValid = true;
+}
+
+void NetInterface::finishConnectRequest(ConnectRequestCheck *check)
+{
+   if(!mAllowConnections)
+      return;
+
+   const Address &address = check->address;
+   ConnectionParameters &theParams = check->params;
+
+   // The solution checked out; now make sure it's for a current puzzle, and hasn't been used before
+   if(!check->puzzleSolved || mPuzzleManager.claimSolution(theParams.mNonce, theParams.mServerNonce,
+                                                            theParams.mPuzzleDifficulty) != ClientPuzzleManager::Success)
+   {
+      sendConnectReject(&theParams, address, NetConnection::ReasonPuzzle);      // Wrong answer!
+      return;
    }
 
+   if(!check->keysValid)
+      return;
+
+   if(theParams.mUsingCrypto)
+      Random::read(theParams.mInitVector, SymmetricCipher::KeySize);
+
+   BitStream streamData(check->packet, check->packetSize);
+   BitStream *stream = &streamData;
+   check->resumeReading(streamData);
+
    U32 connectSequence;
    theParams.mDebugObjectSizes = stream->readFlag();
    stream->read(&connectSequence);
    logprintf(LogConsumer::LogNetInterface, "Received Connect Request %8x", theParams.mClientIdentity);
 
+   NetConnection *connect = findConnection(address);
    if(connect)
       disconnect(connect, NetConnection::ReasonSelfDisconnect, "NewConnection");
 
@@ -34,6 +34,7 @@ namespace TNL {
 GhostConnection *NetObject::mRPCSourceConnection = NULL;
 GhostConnection *NetObject::mRPCDestConnection = NULL;
 bool NetObject::mIsInitialUpdate = false;
+U32 NetObject::mSharedUpdateEpoch = 1;
 
 NetObject::NetObject()
 {
@@ -43,6 +44,7 @@ NetObject::NetObject()
    mPrevDirtyList = NULL;
    mNextDirtyList = NULL;
    mDirtyMaskBits = 0;
+   mSharedUpdates = NULL;
 }
 
 // Copy constructor
@@ -53,6 +55,7 @@ NetObject::NetObject(const NetObject &t)
    mPrevDirtyList = NULL;
    mNextDirtyList = NULL;
    mDirtyMaskBits = 0;
+   mSharedUpdates = NULL;
 }
 
 
@@ -61,6 +64,8 @@ NetObject::~NetObject()
    while(mFirstObjectRef)
       mFirstObjectRef->connection->detachObject(mFirstObjectRef);
 
+   delete [] mSharedUpdates;
+
    if(mDirtyMaskBits)
    {
       if(mPrevDirtyList)
@@ -123,6 +128,8 @@ void NetObject::clearMaskBits(U32 orMask)
 
 void NetObject::collapseDirtyList()
 {
+   mSharedUpdateEpoch++;
+
    Vector<NetObject *> tempV;
    for(NetObject *t = mDirtyList; t; t = t->mNextDirtyList)
       tempV.push_back(t);
@@ -158,6 +165,58 @@ void NetObject::collapseDirtyList()
    }
 }
 
+U32 NetObject::packSharedUpdate(GhostConnection *connection, U32 updateMask, BitStream *stream)
+{
+   TNLAssert(mNetFlags.test(SharedUpdates), "Object's updates can't be shared!");
+
+   if(!mSharedUpdates)
+      mSharedUpdates = new SharedUpdate[MaxSharedUpdates];
+
+   SharedUpdate *freeSlot = NULL;
+
+   for(S32 i = 0; i < MaxSharedUpdates; i++)
+   {
+      SharedUpdate &update = mSharedUpdates[i];
+
+      if(update.epoch != mSharedUpdateEpoch)
+      {
+         if(!freeSlot)
+            freeSlot = &update;
+      }
+      else if(update.updateMask == updateMask && update.initialUpdate == mIsInitialUpdate)
+      {
+         stream->writeBits(update.bitCount, update.bits.address());
+         return update.retMask;
+      }
+   }
+
+   // Already holding as many different updates as we keep this round
+   if(!freeSlot)
+      return packUpdate(connection, updateMask, stream);
+
+   static U8 scratchBuffer[MaxPacketDataSize];
+   BitStream scratch(scratchBuffer, MaxPacketDataSize);
+
+   U32 retMask = packUpdate(connection, updateMask, &scratch);
+
+   // Won't fit in any packet; pack it again where the caller can see the overrun
+   if(!scratch.isValid())
+      return packUpdate(connection, updateMask, stream);
+
+   freeSlot->epoch = mSharedUpdateEpoch;
+   freeSlot->updateMask = updateMask;
+   freeSlot->initialUpdate = mIsInitialUpdate;
+   freeSlot->retMask = retMask;
+   freeSlot->bitCount = scratch.getBitPosition();
+   freeSlot->bits.resize(scratch.getBytePosition());
+
+   if(freeSlot->bits.size())
+      memcpy(freeSlot->bits.address(), scratchBuffer, freeSlot->bits.size());
+
+   stream->writeBits(freeSlot->bitCount, freeSlot->bits.address());
+   return retMask;
+}
+
 bool NetObject::onGhostAdd(GhostConnection *theConnection)
 {
    return true;
@@ -42,6 +42,7 @@
 #include <unistd.h>
 #include <signal.h>
 #include <sys/time.h>
+#include <time.h>
 
 #endif
 
@@ -414,6 +415,8 @@ U32 x86UNIXGetTickCountMicro()
    return uSecs;
 }
 
+// Counts microseconds on a monotonic clock where we have one, so the high precision timer lives up to its name and
+// doesn't jump around when the system clock is adjusted
 class UnixTimer
 {
    public:
@@ -422,11 +425,18 @@ class UnixTimer
       }
       S64 getCurrentTime()
       {
-         return x86UNIXGetTickCount();
+#ifdef CLOCK_MONOTONIC
+         timespec t;
+         if(clock_gettime(CLOCK_MONOTONIC, &t) == 0)
+            return S64(t.tv_sec) * 1000000 + t.tv_nsec / 1000;
+#endif
+         timeval tv;
+         ::gettimeofday(&tv, NULL);
+         return S64(tv.tv_sec) * 1000000 + tv.tv_usec;
       }
       F64 convertToMS(S64 delta)
       {
-         return F64(delta);
+         return F64(delta) / 1000.0;
       }
 };
 
@@ -270,40 +270,69 @@ U32 ThreadQueue::ThreadQueueThread::run()
    sto.set((void *) 0);
    mThreadQueue->unlock();
 
-   for(;;)
-      mThreadQueue->dispatchNextCall();
+   while(mThreadQueue->dispatchNextCall())
+      ;
+
+   // Last thing we touch; the ThreadQueue may be gone as soon as this returns
+   mThreadQueue->mExitSemaphore.increment();
    return 0;
 }
 
 ThreadQueue::ThreadQueue(U32 threadCount)
 {
+   mQuitting = false;
    mStorage.set((void *) 1);
+
+#ifndef TNL_NO_THREADS
    for(U32 i = 0; i < threadCount; i++)
    {
       Thread *theThread = new ThreadQueueThread(this);
       mThreads.push_back(theThread);
       theThread->start();
    }
+#endif
 }
 
 ThreadQueue::~ThreadQueue()
 {
+   lock();
+   mQuitting = true;
+   unlock();
+
+   mSemaphore.increment(mThreads.size());
+   for(S32 i = 0; i < mThreads.size(); i++)
+      mExitSemaphore.wait();
+
+   for(S32 i = 0; i < mThreads.size(); i++)
+      delete mThreads[i];
+
+   for(S32 i = 0; i < mThreadCalls.size(); i++)
+      delete mThreadCalls[i];
+
+   for(S32 i = 0; i < mResponseCalls.size(); i++)
+      delete mResponseCalls[i];
 }
 
-void ThreadQueue::dispatchNextCall()
+bool ThreadQueue::dispatchNextCall()
 {
    mSemaphore.wait();
    lock();
+   if(mQuitting)
+   {
+      unlock();
+      return false;
+   }
    if(mThreadCalls.size() == 0)
    {
       unlock();
-      return;
+      return true;
    }
    Functor *c = mThreadCalls.first();
    mThreadCalls.pop_front();
    unlock();
    c->dispatch(this);
    delete c;
+   return true;
 }
 
 void ThreadQueue::postCall(Functor *theCall)
@@ -107,7 +107,8 @@ public:
    /// Returns true if this is a valid key.
    bool isValid() { return mIsValid; }
    /// Compute a key we can share with the specified AsymmetricKey
-   /// for a symmetric crypto.
+   /// for a symmetric crypto.  Several threads may do this with the
+   /// same key at once.
    ByteBufferPtr computeSharedSecretKey(AsymmetricKey *publicKey);
 
    /// Returns the strength of the AsymmetricKey in byte size.
@@ -85,11 +85,17 @@ private:
 
    NonceTable *mCurrentNonceTable;
    NonceTable *mLastNonceTable;
-   static bool checkOneSolution(U32 solution, Nonce &clientNonce, Nonce &serverNonce, U32 puzzleDifficulty, U32 clientIdentity);
+
+   /// Returns the nonce table for the current or previous server nonce, or NULL if it's neither.
+   NonceTable *findNonceTable(Nonce &serverNonce);
 public:
    ClientPuzzleManager();
    ~ClientPuzzleManager();
 
+   /// Checks whether solution solves the puzzle, without checking the nonces or recording the solution.  This touches
+   /// no ClientPuzzleManager state, so it's safe to call from any thread.
+   static bool checkOneSolution(U32 solution, Nonce &clientNonce, Nonce &serverNonce, U32 puzzleDifficulty, U32 clientIdentity);
+
    /// Checks to see if a new nonce needs to be created, and if so
    /// generates one and tosses out the current list of accepted nonces
    void tick(U32 currentTime);
@@ -117,6 +123,10 @@ public:
    /// Checks a puzzle solution submitted by a client to see if it is a valid solution for the current or previous puzzle nonces
    ErrorCode checkSolution(U32 solution, Nonce &clientNonce, Nonce &serverNonce, U32 puzzleDifficulty, U32 clientIdentity);
 
+   /// Does everything checkSolution does except hashing the solution, for a solution that has already been
+   /// checked with checkOneSolution, possibly on another thread.  Only a successful call uses up the client nonce.
+   ErrorCode claimSolution(Nonce &clientNonce, Nonce &serverNonce, U32 puzzleDifficulty);
+
    /// Computes a puzzle solution value for the given puzzle difficulty and server nonce.  If the execution time of this function
    /// exceeds MaxSolutionComputeFragment milliseconds, it will return the current trail solution in the solution variable and a
    /// return value of false.
@@ -93,13 +93,15 @@ public:
       GhostRef *nextRef;     ///< The next ghost updated in this packet
       GhostRef *updateChain; ///< A pointer to the GhostRef on the least previous packet that
                              ///  updated this ghost, or NULL, if no prior packet updated this ghost
+      S32 baselineSlot;      ///< The GhostBaseline slot the object recorded its state in, or -1 if it didn't
    };
 
    /// Notify structure attached to each packet with information about the ghost updates in the packet
    struct GhostPacketNotify : public EventConnection::EventPacketNotify
    {
-      GhostRef *ghostList; ///< list of ghosts updated in this packet
-      GhostPacketNotify() { ghostList = NULL; }
+      GhostRef *ghostList;    ///< list of ghosts updated in this packet
+      U32 baselinePacket;     ///< The mBaselinePacket this packet was written with
+      GhostPacketNotify() { ghostList = NULL; baselinePacket = 0; }
    };
 
 protected:
@@ -129,6 +131,19 @@ protected:
 // ghost manager functions/code:
 //----------------------------------------------------------------
 
+private:
+   static ClassChunker<GhostRef> mGhostRefChunker; ///< Quick memory allocator for ghost refs
+
+   enum {
+      PriorityBatchSize = 32, ///< How many ghosts writePacket() puts in priority order at first; each further batch is twice as big
+   };
+
+   S32 selectHighestPriorities(S32 count, S32 batchSize);
+
+   GhostInfo *mPackingGhost;     ///< The ghost writePacket() is currently packing an update for, if any
+   S32 mPackingBaselineSlot;     ///< Where the object being packed recorded its state, or -1
+   U32 mBaselinePacket;          ///< Counts packets written, so acks can be matched to the baselines they carried
+
 protected:
    Vector<GhostInfo *> mGhostArray;   ///< Array of GhostInfo structures used to track all the objects ghosted by this side of the connection.
                               ///
@@ -194,6 +209,10 @@ public:
       GhostLookupTableSize = (1 << GhostLookupTableSizeShift), ///< Size of the hash table used to lookup source NetObjects by remote ghost ID.
       GhostLookupTableMask = (GhostLookupTableSize - 1),       ///< Hashing mask for table lookups.
 
+      BaselineSlotBitSize = 2,                          ///< Size, in bits, of the integer used to transmit baseline slots.
+      BaselineSlotCount = (1 << BaselineSlotBitSize),   ///< Number of recent states kept per ghost for delta encoding.
+      MaxBaselineValues = 4,                            ///< Most values an object can record in one baseline.
+
    };
 
    void setScopeObject(NetObject *object);                           ///< Sets the object that is queried at each packet to determine
@@ -218,6 +237,15 @@ public:
    /// Returns true if the object is available on the client.
    bool isGhostAvailable(NetObject *object) { return getGhostIndex(object) != -1; }
 
+   /// While an object's update is being packed, returns the most recent state it recorded that the remote host is
+   /// known to have received, and sets slot to where the remote host is keeping it.  Returns NULL if there isn't one.
+   const S32 *getAckedBaseline(S32 &slot);
+
+   /// Records count values as the state of the object whose update is being packed, and returns the slot the remote
+   /// host should keep them in, so later updates can be encoded against them once this one is acked.  Returns -1
+   /// if there's no slot free, in which case the remote host shouldn't keep them at all.
+   S32 recordBaseline(const S32 *values, S32 count);
+
    void resetGhosting();                   ///< Stops ghosting objects from this GhostConnection to the remote host, which causes all ghosts to be destroyed on the client.
    void activateGhosting();                ///< Begins ghosting objects from this GhostConnection to the remote host, starting with the GhostAlways objects.
    bool isGhosting() { return mGhosting; } ///< Returns true if this connection is currently ghosting objects to the remote host.
@@ -242,6 +270,30 @@ public:
 
 //----------------------------------------------------------------------------
 
+/// The last few states of a ghost sent to the remote host, which the object can encode its updates against.
+///
+/// Each state goes in a slot the remote host mirrors.  Slots aren't reused while the packet they went out in
+/// is still in flight, nor while they're the acked baseline, so both sides always agree on what the acked
+/// slot holds.
+struct GhostBaseline
+{
+   S32 values[GhostConnection::BaselineSlotCount][GhostConnection::MaxBaselineValues];
+   U32 sentPacket[GhostConnection::BaselineSlotCount];   ///< The mBaselinePacket each slot was sent in, or 0 if free
+   S32 ackedSlot;    ///< Most recent slot the remote host is known to have, or -1
+
+   GhostBaseline() { reset(); }
+
+   void reset()
+   {
+      for(S32 i = 0; i < GhostConnection::BaselineSlotCount; i++)
+         sentPacket[i] = 0;
+
+      ackedSlot = -1;
+   }
+};
+
+//----------------------------------------------------------------------------
+
 /// Each GhostInfo structure tracks the state of a single NetObject's ghost for a single GhostConnection.
 struct GhostInfo
 {
@@ -267,6 +319,7 @@ struct GhostInfo
    F32 priority;   ///< Priority for the update of this object, computed after the scoping process has run.
    U32 index;      ///< Fixed index of the object in the mGhostRefs array for the connection, and the ghostId of the object on the client.
    S32 arrayIndex; ///< Position of the object in the mGhostArray for the connection, which changes as the object is pushed to zero, non-zero and free.
+   GhostBaseline *baseline; ///< States recorded for delta encoding, allocated when the object first records one.
 
     enum Flags
     {
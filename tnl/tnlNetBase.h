@@ -255,6 +255,9 @@ public:
       mPartialUpdateBitsUsed += bitCount;
    }
 
+   U32 getPartialUpdateCount() const { return mPartialUpdateCount; }       ///< Returns how many partial updates have been recorded.
+   U32 getPartialUpdateBitsUsed() const { return mPartialUpdateBitsUsed; } ///< Returns the bits used by all recorded partial updates.
+
    virtual Object *create() const = 0;             ///< Creates an instance of the class this represents.
 
    /// Returns the number of classes registered under classGroup and classType.
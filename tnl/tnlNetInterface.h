@@ -140,9 +140,13 @@ struct ConnectionParameters;
 /// of the receiver.
 
 
+struct ConnectRequestCheck;
+class ConnectRequestQueue;
+
 class NetInterface : public Object
 {
    friend class NetConnection;
+   friend class ConnectRequestQueue;
 public:
    /// PacketType is encoded as the first byte of each packet.
    ///
@@ -196,6 +200,20 @@ protected:
    U8  mRandomHashData[12];     /// Data that gets hashed with connect challenge requests to prevent connection spoofing.
    bool mAllowConnections;      /// Set if this NetInterface allows connections from remote instances.
 
+   /// @name NetInterfaceConnectChecks Connect request checking
+   ///
+   /// Checking the puzzle solution and doing the key exchange for a connect request is handed off to worker
+   /// threads, so a flood of connect requests doesn't hold up everything else.  The connection itself is set up
+   /// back on the main thread, in processConnections(), once the request has been checked.
+   ///
+   /// @{
+
+   ///
+   ConnectRequestQueue *mConnectRequestQueue;   ///< Created when the first connect request arrives; NULL until then.
+   U32 mConnectCheckThreadCount;                ///< Number of worker threads to check connect requests with; 0 checks them right away.
+
+   /// @}
+
    /// Structure used to track packets that are delayed in sending for simulating a high-latency connection.
    ///
    /// The DelaySendPacket is allocated as sizeof(DelaySendPacket) + packetSize;
@@ -211,6 +229,25 @@ protected:
    };
    DelaySendPacket *mSendPacketList; /// List of delayed packets pending to send.
 
+   /// @name NetInterfaceBatching Batched packet IO
+   ///
+   /// Incoming packets are read several at a time into a set of preallocated buffers, and packets sent
+   /// by connections are queued up and handed to the socket together, saving a system call per packet.
+   ///
+   /// @{
+
+   ///
+   U8 mReceiveBuffers[Socket::MaxBatchSize][MaxPacketDataSize];
+   Address mReceiveAddresses[Socket::MaxBatchSize];
+   S32 mReceiveSizes[Socket::MaxBatchSize];
+
+   U8 mSendQueueBuffers[Socket::MaxBatchSize][MaxPacketDataSize];
+   Address mSendQueueAddresses[Socket::MaxBatchSize];
+   S32 mSendQueueSizes[Socket::MaxBatchSize];
+   S32 mSendQueueCount;
+
+   /// @}
+
    enum NetInterfaceConstants {
       ChallengeRetryCount = 4,     /// Number of times to send connect challenge requests before giving up.
       ChallengeRetryTime = 2500,   /// Timeout interval in milliseconds before retrying connect challenge.
@@ -223,6 +260,9 @@ protected:
 
       TimeoutCheckInterval = 1500,     /// Interval in milliseconds between checking for connection timeouts.
       PuzzleSolutionTimeout = 30000,   /// If the server gives us a puzzle that takes more than 30 seconds, time out.
+
+      DefaultConnectCheckThreadCount = 2, /// Number of worker threads checking connect requests, unless told otherwise.
+      MaxPendingConnectChecks = 256,      /// Connect requests arriving while this many are waiting to be checked are dropped; clients will resend them.
    };
 
    /// Computes an identity token for the connecting client based on the address of the client and the
@@ -282,6 +322,14 @@ protected:
    /// connection negotiation.
    void handleConnectRequest(const Address &address, BitStream *stream);
 
+   /// Checks the puzzle solution of a connect request, and does the key exchange if the connection is
+   /// using crypto.  Touches nothing but the check itself, so it can run on a worker thread.
+   static void checkConnectRequest(ConnectRequestCheck *check);
+
+   /// Finishes handling a connect request once it has been checked, by rejecting it, or creating the
+   /// connection and accepting it.
+   void finishConnectRequest(ConnectRequestCheck *check);
+
    /// Sends a connect accept packet to acknowledge the successful acceptance of a connect request.
    void sendConnectAccept(NetConnection *conn);
 
@@ -348,12 +396,23 @@ public:
    /// Sets whether or not this NetInterface allows connections from remote hosts.
    void setAllowsConnections(bool conn) { mAllowConnections = conn; }
 
+   /// Sets the number of worker threads connect requests are checked on.  With 0, they're checked as they
+   /// arrive, on the calling thread.  Any requests still being checked are dropped.
+   void setConnectCheckThreadCount(U32 count);
+
+   /// Returns the number of connect requests waiting to be checked, or for their connections to be set up.
+   S32 getPendingConnectCheckCount();
+
    /// Returns the Socket associated with this NetInterface
    Socket &getSocket() { return mSocket; }
 
-   /// Sends a packet to the remote address over this interface's socket.
+   /// Queues a packet to be sent to the remote address over this interface's socket.  Queued packets go
+   /// out when the queue fills up, or at the end of checkIncomingPackets() and processConnections().
    NetError sendto(const Address &address, BitStream *stream);
 
+   /// Sends any packets queued by sendto().
+   void flushSendQueue();
+
    /// Sends a packet to the remote address after millisecondDelay time has elapsed.
    ///
    /// This is used to simulate network latency on a LAN or single computer.
@@ -217,12 +217,34 @@ class NetObject : public Object
    static bool mIsInitialUpdate; ///< Managed by GhostConnection - set to true when this is an initial update
    SafePtr<NetObject> mServerObject; ///< Direct pointer to the parent object on the server if it is a local connection
    GhostConnection *mOwningConnection; ///< The connection that owns this ghost, if it's a ghost
+
+   /// The encoded output of one packUpdate() call, kept for objects with the SharedUpdates flag.
+   struct SharedUpdate
+   {
+      U32 epoch;           ///< Value of mSharedUpdateEpoch when this was packed; 0 if never used
+      U32 updateMask;
+      bool initialUpdate;
+      U32 retMask;         ///< What packUpdate() returned
+      U32 bitCount;
+      Vector<U8> bits;
+
+      SharedUpdate() { epoch = 0; }
+   };
+
+   enum {
+      MaxSharedUpdates = 4,   ///< Distinct (mask, initial) combinations cached per object per epoch
+   };
+
+   static U32 mSharedUpdateEpoch;   ///< Bumped by collapseDirtyList(), which invalidates all SharedUpdates
+   SharedUpdate *mSharedUpdates;    ///< Allocated the first time the object is packed
 protected:
    enum NetFlag
    {
       IsGhost =            BIT(1),  ///< Set if this is a ghost.
       ScopeLocal =         BIT(2),  ///< If set, this object ghosts only to the local client.
       Ghostable =          BIT(3),  ///< Set if this object can ghost at all.
+      SharedUpdates =      BIT(4),  ///< Set if packUpdate() output depends only on the object and the update mask, never on
+                                    ///  the connection.  See packSharedUpdate().
       MaxNetFlagBit = 15
    };
 
@@ -236,6 +258,13 @@ protected:
 
    /// Returns true if this pack/unpackUpdate is the initial one for the object
    bool isInitialUpdate() { return mIsInitialUpdate; }
+
+   /// Writes the same bits packUpdate() would, but packs each update mask only once between
+   /// calls to collapseDirtyList(), copying the encoded bits to every other connection that
+   /// wants the same update.  Only valid for objects with the SharedUpdates flag, whose
+   /// packUpdate() must not use the connection, string tables or BitStream::writeString(),
+   /// all of which write bits that depend on who is receiving them.
+   U32 packSharedUpdate(GhostConnection *connection, U32 updateMask, BitStream *stream);
 public:
    NetObject();
    ~NetObject();
@@ -244,7 +273,7 @@ public:
 
    /// collapseDirtyList pushes all the mDirtyMaskBits down into
    /// the GhostInfo's for each object, and clears out the dirty
-   /// list.
+   /// list.  Also throws away any updates saved by packSharedUpdate().
    static void collapseDirtyList();
 
    /// Returns the connection from which the current RPC method originated,
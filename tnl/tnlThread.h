@@ -172,6 +172,10 @@ class ThreadQueue : public Object
    Vector<Functor *> mResponseCalls;
    /// Synchronization variable that manages worker threads
    Semaphore mSemaphore;
+   /// Signalled by each worker thread as it exits, so the destructor can wait for them.
+   Semaphore mExitSemaphore;
+   /// Set when the ThreadQueue is being destroyed, to tell the worker threads to exit.
+   bool mQuitting;
    /// Internal Mutex for synchronizing access to thread call vectors.
    Mutex mLock;
    /// Storage variable that tracks whether this is the main thread or a worker thread.
@@ -184,7 +188,8 @@ protected:
    /// Posts a marshalled call onto either the worker thread call list or the response call list.
    void postCall(Functor *theCall);
    /// Dispatches the next available worker thread call.  Called internally by the worker threads when they awaken from the semaphore.
-   void dispatchNextCall();
+   /// Returns false when the thread should exit.
+   bool dispatchNextCall();
    /// helper function to determine if the currently executing thread is a worker thread or the main thread.
    bool isMainThread() { return (bool) mStorage.get(); }
    ThreadStorage &getStorage() { return mStorage; }
@@ -192,8 +197,12 @@ protected:
    virtual void threadStart() { }
 public:
    /// ThreadQueue constructor.  threadCount specifies the number of worker threads that will be created.
+   /// If TNL_NO_THREADS is defined, no threads are created, and worker calls are dispatched on the main
+   /// thread by dispatchResponseCalls().
    ThreadQueue(U32 threadCount);
-   ~ThreadQueue();
+   /// ThreadQueue destructor.  Waits for the worker threads to finish the calls they're working on, then
+   /// deletes any calls that were never dispatched.
+   virtual ~ThreadQueue();
 
    /// Dispatches all ThreadQueue calls queued by worker threads.  This should
    /// be called periodically from a main loop.
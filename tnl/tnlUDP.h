@@ -147,11 +147,25 @@ enum NetError {
 /// The Socket class encapsulates a platform's network socket.
 class Socket
 {
+public:
+   /// Packets moved through this socket, and the system calls it took to move them.
+   struct Stats
+   {
+      U32 packetsReceived;
+      U32 receiveCalls;
+      U32 packetsSent;
+      U32 sendCalls;
+   };
+
+private:
    S32 mPlatformSocket;    ///< The OS-level socket
    U32 mTransportProtocol; ///< The transport type this socket uses.
+   Stats mStats;
+
 public:
    enum {
       DefaultBufferSize = 32768, ///< The default send and receive buffer sizes
+      MaxBatchSize = 32,         ///< Most packets recvBatch() or sendBatch() will move in a single system call
    };
 
    /// Opens a socket on the specified address/port
@@ -177,6 +191,22 @@ public:
    /// @param   bytesRead       Specifies the number of bytes which were actually in the packet.
    NetError recvfrom(Address *address, U8 *buffer, S32 bufferSize, S32 *bytesRead);
 
+   /// Reads up to maxPackets waiting packets, using a single system call where the platform
+   /// allows it (recvmmsg on Linux), and one recvfrom() per packet elsewhere.
+   ///
+   /// @param   addresses       Filled in with the address each packet came from.
+   /// @param   buffers         maxPackets buffers, each bufferSize bytes, to read the packets into.
+   /// @param   sizes           Filled in with the size of each packet.
+   /// @returns The number of packets read; fewer than maxPackets means there are no more waiting.
+   S32 recvBatch(Address *addresses, U8 * const *buffers, S32 bufferSize, S32 *sizes, S32 maxPackets);
+
+   /// Sends count packets, using as few system calls as the platform allows (sendmmsg on Linux).
+   /// Packets that can't be sent are dropped, just as they would be by sendto().  Returns the number sent.
+   S32 sendBatch(const Address *addresses, const U8 * const *buffers, const S32 *sizes, S32 count);
+
+   /// Returns counts of packets and system calls since this socket was opened.
+   const Stats &getStats() const { return mStats; }
+
    /// Returns the Address corresponding to this socket, as bound on the local machine.
    Address getBoundAddress();
 
@@ -189,6 +219,10 @@ public:
    virtual NetError send(const U8 *buffer, S32 bufferSize);
 
    bool isWritable(U32 timeout = 0);
+
+   /// Waits up to timeoutMicros microseconds for incoming data, returning true as soon as some arrives.
+   /// Unlike isWritable(), a timeout of 0 just checks without waiting.
+   bool waitForData(U32 timeoutMicros);
 };
 
 //inline void read(BitStream &s, IPAddress *val)
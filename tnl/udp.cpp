@@ -222,6 +222,7 @@ Socket::Socket(const Address &bindAddress, U32 sendBufferSize, U32 recvBufferSiz
    init();
    mPlatformSocket = INVALID_SOCKET;
    mTransportProtocol = bindAddress.transport;
+   memset(&mStats, 0, sizeof(mStats));
 
    const char *socketType;
 
@@ -352,11 +353,14 @@ NetError Socket::sendto(const Address &address, const U8 *buffer, S32 bufferSize
    socklen_t addressSize;
 
    TNLToSocketAddress(address, &destAddress, &addressSize);
+
+   mStats.sendCalls++;
    if(::sendto(mPlatformSocket, (const char*)buffer, bufferSize, 0,
          &destAddress, addressSize) == SOCKET_ERROR)
       return getLastError();
-   else
-      return NoError;
+
+   mStats.packetsSent++;
+   return NoError;
 }
 
 NetError Socket::recvfrom(Address *address, U8 *buffer, S32 bufferSize, S32 *outSize)
@@ -385,6 +389,8 @@ NetError Socket::recvfrom(Address *address, U8 *buffer, S32 bufferSize, S32 *out
    S32 bytesRead = SOCKET_ERROR;
 
    bytesRead = ::recvfrom(mPlatformSocket, (char *) buffer, bufferSize, 0, &sa, &addrLen);
+   mStats.receiveCalls++;
+
    if(bytesRead == SOCKET_ERROR)
    {
       TNL_JOURNAL_WRITE_BLOCK(Socket::recvfrom,
@@ -393,6 +399,7 @@ NetError Socket::recvfrom(Address *address, U8 *buffer, S32 bufferSize, S32 *out
       return WouldBlock;
    }
 
+   mStats.packetsReceived++;
    SocketToTNLAddress(&sa, address);
 
    *outSize = bytesRead;
@@ -411,6 +418,126 @@ NetError Socket::recvfrom(Address *address, U8 *buffer, S32 bufferSize, S32 *out
    return NoError;
 }
 
+S32 Socket::recvBatch(Address *addresses, U8 * const *buffers, S32 bufferSize, S32 *sizes, S32 maxPackets)
+{
+#if defined(TNL_OS_LINUX)
+   // Journaling records packets one recvfrom() at a time, so let it keep doing that
+   if(Journal::getCurrentMode() == Journal::Inactive)
+   {
+      if(maxPackets > MaxBatchSize)
+         maxPackets = MaxBatchSize;
+
+      mmsghdr messages[MaxBatchSize];
+      iovec iovecs[MaxBatchSize];
+      SOCKADDR sourceAddresses[MaxBatchSize];
+
+      memset(messages, 0, maxPackets * sizeof(mmsghdr));
+
+      for(S32 i = 0; i < maxPackets; i++)
+      {
+         iovecs[i].iov_base = buffers[i];
+         iovecs[i].iov_len = bufferSize;
+
+         messages[i].msg_hdr.msg_iov = &iovecs[i];
+         messages[i].msg_hdr.msg_iovlen = 1;
+         messages[i].msg_hdr.msg_name = &sourceAddresses[i];
+         messages[i].msg_hdr.msg_namelen = sizeof(SOCKADDR);
+      }
+
+      S32 count = recvmmsg(mPlatformSocket, messages, maxPackets, 0, NULL);
+      mStats.receiveCalls++;
+
+      if(count <= 0)
+         return 0;
+
+      for(S32 i = 0; i < count; i++)
+      {
+         SocketToTNLAddress(&sourceAddresses[i], &addresses[i]);
+         sizes[i] = messages[i].msg_len;
+      }
+
+      mStats.packetsReceived += count;
+      return count;
+   }
+#endif
+
+   S32 count = 0;
+
+   while(count < maxPackets && recvfrom(&addresses[count], buffers[count], bufferSize, &sizes[count]) == NoError)
+      count++;
+
+   return count;
+}
+
+
+S32 Socket::sendBatch(const Address *addresses, const U8 * const *buffers, const S32 *sizes, S32 count)
+{
+#if defined(TNL_OS_LINUX)
+   if(Journal::getCurrentMode() == Journal::Inactive)
+   {
+      mmsghdr messages[MaxBatchSize];
+      iovec iovecs[MaxBatchSize];
+      SOCKADDR destAddresses[MaxBatchSize];
+
+      S32 sent = 0;
+      S32 next = 0;
+
+      while(next < count)
+      {
+         S32 batchSize = 0;
+
+         memset(messages, 0, sizeof(messages));
+
+         for(; next < count && batchSize < MaxBatchSize; next++)
+         {
+            if(addresses[next].transport != mTransportProtocol)
+               continue;
+
+            socklen_t addressSize;
+            TNLToSocketAddress(addresses[next], &destAddresses[batchSize], &addressSize);
+
+            iovecs[batchSize].iov_base = (void *) buffers[next];
+            iovecs[batchSize].iov_len = sizes[next];
+
+            messages[batchSize].msg_hdr.msg_iov = &iovecs[batchSize];
+            messages[batchSize].msg_hdr.msg_iovlen = 1;
+            messages[batchSize].msg_hdr.msg_name = &destAddresses[batchSize];
+            messages[batchSize].msg_hdr.msg_namelen = addressSize;
+
+            batchSize++;
+         }
+
+         // sendmmsg() stops at the first packet it can't send; drop that one and carry on with the rest
+         for(S32 i = 0; i < batchSize;)
+         {
+            S32 result = sendmmsg(mPlatformSocket, &messages[i], batchSize - i, 0);
+            mStats.sendCalls++;
+
+            if(result > 0)
+            {
+               sent += result;
+               i += result;
+            }
+            else
+               i++;
+         }
+      }
+
+      mStats.packetsSent += sent;
+      return sent;
+   }
+#endif
+
+   S32 sent = 0;
+
+   for(S32 i = 0; i < count; i++)
+      if(sendto(addresses[i], buffers[i], sizes[i]) == NoError)
+         sent++;
+
+   return sent;
+}
+
+
 NetError Socket::connect(const Address &theAddress)
 {
    SOCKADDR destAddress;
@@ -482,6 +609,22 @@ bool Socket::isWritable(U32 timeoutMillis)
    return FD_ISSET(mPlatformSocket, &fds);
 }
 
+bool Socket::waitForData(U32 timeoutMicros)
+{
+   fd_set fds;
+   FD_ZERO(&fds);
+   FD_SET(mPlatformSocket, &fds);
+
+   timeval timeoutval;
+   timeoutval.tv_sec = timeoutMicros / 1000000;
+   timeoutval.tv_usec = timeoutMicros % 1000000;
+
+   if(::select(mPlatformSocket + 1, &fds, 0, 0, &timeoutval) == SOCKET_ERROR)
+      return false;
+
+   return FD_ISSET(mPlatformSocket, &fds);
+}
+
 #if defined ( TNL_OS_WIN32 )
 void Socket::getInterfaceAddresses(Vector<Address> *addressVector)
 {
@@ -222,6 +222,20 @@ bool isZoneType(U8 x)      // Zones a ship could be in
 }
 
 
+// Engineered turrets and teleporters are added after the static index is built, so they'll be treated as movers
+bool isStaticType(U8 x)
+{
+   return
+         x == BarrierTypeNumber       || x == PolyWallTypeNumber       || x == WallItemTypeNumber            ||
+         x == WallEdgeTypeNumber      || x == WallSegmentTypeNumber    || x == LoadoutZoneTypeNumber         ||
+         x == GoalZoneTypeNumber      || x == NexusTypeNumber          || x == ZoneTypeNumber                ||
+         x == SlipZoneTypeNumber      || x == SpeedZoneTypeNumber      || x == TeleporterTypeNumber          ||
+         x == TurretTypeNumber        || x == ForceFieldProjectorTypeNumber || x == CoreTypeNumber           ||
+         x == ShipSpawnTypeNumber     || x == FlagSpawnTypeNumber      || x == AsteroidSpawnTypeNumber       ||
+         x == TextItemTypeNumber      || x == LineTypeNumber           || x == BotNavMeshZoneTypeNumber;
+}
+
+
 bool isSeekerTarget(U8 x)
 {
    return isShipType(x);
@@ -240,6 +254,18 @@ bool isAnyObjectType(U8 x)
    return true;
 }
 
+
+// For callers that walk GridDatabase::findObjects_fast() one type at a time, so their list of types can't drift 
+// away from the test function that defines it
+void getTypeNumbers(TestFunc testFunc, Vector<U8> &types)
+{
+   types.clear();
+
+   for(S32 i = 0; i < U8_MAX + 1; i++)
+      if(testFunc(U8(i)))
+         types.push_back(U8(i));
+}
+
 ////////////////////////////////////////
 ////////////////////////////////////////
 
@@ -833,6 +859,9 @@ void BfObject::deleteObject(U32 deleteTimeInterval)  // interval defaults to 0
    mOriginalTypeNumber = mObjectTypeNumber;
    mObjectTypeNumber = DeletedTypeNumber;
 
+   if(getDatabase())
+      getDatabase()->onObjectDeleted(this);      // Keep it out of searches by type while it waits to be deleted
+
    if(!mGame)                    // Not in a game
       delete this;
    else
@@ -862,12 +891,12 @@ void BfObject::setScopeAlways()
 
 F32 BfObject::getUpdatePriority(GhostConnection *connection, U32 updateMask, S32 updateSkips)
 {
-   GameConnection *gc = dynamic_cast<GameConnection *>(connection);
-   BfObject *so = gc ? gc->getControlObject() : NULL;
+   // All our ghosting connections are GameConnections, which note where their control object is before writing a packet
+   ControlObjectConnection *conn = static_cast<ControlObjectConnection *>(connection);
    F32 add = 0;
-   if(so)
+   if(conn->hasPriorityFocus())
    {
-      Point center = so->getExtent().getCenter();
+      const Point &center = conn->getPriorityFocusCenter();
 
       Point nearest;
       const Rect &extent = getExtent();
@@ -890,7 +919,7 @@ F32 BfObject::getUpdatePriority(GhostConnection *connection, U32 updateMask, S32
 
       F32 distance = (nearest - center).len();
 
-      Point deltav = getVel() - so->getVel();
+      Point deltav = getVel() - conn->getPriorityFocusVel();
 
 
       // initial scoping factor is distance based.
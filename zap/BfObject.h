@@ -111,6 +111,7 @@ bool isFlagOrShipCollideableType(U8 x);
 bool isVisibleOnCmdrsMapType(U8 x);
 bool isVisibleOnCmdrsMapWithSensorType(U8 x);
 bool isZoneType(U8 x);
+bool isStaticType(U8 x);                     // Objects that stay put once a level is loaded
 bool isSeekerTarget(U8 x);
 bool isMountableItemType(U8 x);
 
@@ -119,6 +120,8 @@ bool isAnyObjectType(U8 x);
 
 typedef bool (*TestFunc)(U8);
 
+void getTypeNumbers(TestFunc testFunc, Vector<U8> &types);   // Every type number the test accepts, in ascending order
+
 class Game;
 class GameConnection;
 class Color;
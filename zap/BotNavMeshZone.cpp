@@ -290,14 +290,11 @@ static BotNavMeshZone *findZoneTouchingCircle(const GridDatabase *botZoneDatabas
 #  define LOG_TIMER
 #endif
 
-static bool mergeBotZoneBuffers(const Vector<DatabaseObject *> &barriers,
-                                const Vector<DatabaseObject *> &turrets,
-                                const Vector<DatabaseObject *> &forceFieldProjectors, 
-                                F32 bufferRadius,   PolyTree &solution)
+static void gatherBotZoneBuffers(const Vector<DatabaseObject *> &barriers,
+                                 const Vector<DatabaseObject *> &turrets,
+                                 const Vector<DatabaseObject *> &forceFieldProjectors, 
+                                 F32 bufferRadius, Vector<Vector<Point> > &inputPolygons)
 {
-
-   Vector<Vector<Point> > inputPolygons;
-
    // Add barriers (PolyWalls are Barriers on the server)
    for(S32 i = 0; i < barriers.size(); i++)
    {
@@ -352,8 +349,49 @@ static bool mergeBotZoneBuffers(const Vector<DatabaseObject *> &barriers,
          inputPolygons[i][j].x = (F32)floor(inputPolygons[i][j].x);
          inputPolygons[i][j].y = (F32)floor(inputPolygons[i][j].y);
       }
+}
+
+
+// Flattens everything that affects the zones we build into a single list of numbers for BotZoneCache to compare
+static void buildBotZoneCacheKey(const Rect *worldExtents, const Vector<Vector<Point> > &inputPolygons,
+                                 const Vector<pair<Point, const Vector<Point> *> > &teleporterData, bool triangulateZones,
+                                 Vector<F32> &key)
+{
+   key.push_back(worldExtents->min.x);
+   key.push_back(worldExtents->min.y);
+   key.push_back(worldExtents->max.x);
+   key.push_back(worldExtents->max.y);
+   key.push_back(triangulateZones ? 1.0f : 0.0f);
+
+   key.push_back(F32(inputPolygons.size()));
+
+   for(S32 i = 0; i < inputPolygons.size(); i++)
+   {
+      key.push_back(F32(inputPolygons[i].size()));
+
+      for(S32 j = 0; j < inputPolygons[i].size(); j++)
+      {
+         key.push_back(inputPolygons[i][j].x);
+         key.push_back(inputPolygons[i][j].y);
+      }
+   }
 
-   return mergePolysToPolyTree(inputPolygons, solution);
+   key.push_back(F32(teleporterData.size()));
+
+   for(S32 i = 0; i < teleporterData.size(); i++)
+   {
+      const Vector<Point> *dests = teleporterData[i].second;
+
+      key.push_back(teleporterData[i].first.x);
+      key.push_back(teleporterData[i].first.y);
+      key.push_back(F32(dests->size()));
+
+      for(S32 j = 0; j < dests->size(); j++)
+      {
+         key.push_back(dests->get(j).x);
+         key.push_back(dests->get(j).y);
+      }
+   }
 }
 
 
@@ -416,7 +454,8 @@ static void linkTeleportersBotNavMeshZoneConnections(const GridDatabase *botZone
 bool BotNavMeshZone::buildBotMeshZones(GridDatabase *botZoneDatabase, Vector<BotNavMeshZone *> *allZones,
                                        const Rect *worldExtents, const Vector<DatabaseObject *> &barrierList,
                                        const Vector<DatabaseObject *> &turretList, const Vector<DatabaseObject *> &forceFieldProjectorList,
-                                       const Vector<pair<Point, const Vector<Point> *> > &teleporterData, bool triangulateZones)
+                                       const Vector<pair<Point, const Vector<Point> *> > &teleporterData, bool triangulateZones,
+                                       BotZoneCache *cache)
 {
 #ifdef LOG_TIMER
    U32 starttime = Platform::getRealMilliseconds();
@@ -434,33 +473,44 @@ bool BotNavMeshZone::buildBotMeshZones(GridDatabase *botZoneDatabase, Vector<Bot
       return false;
    }
 
-   Vector<F32> holes;
-   PolyTree solution;
+   Vector<Vector<Point> > inputPolygons;
 
    // Check if this is some sort of degenerate empty level and manually inject a zone.  Using a square because it looks nice;
    // A triangle would work too, and would be a tiny bit more efficient.
    if(barrierList.size() == 0 && turretList.size() == 0 && forceFieldProjectorList.size() == 0)
    {
-      Vector<Vector<Point> > inputPolygons(1);
       Vector<Point> points(4);
       points.push_back(Point(0, 0));
       points.push_back(Point(3, 0));
       points.push_back(Point(3, 3));
       points.push_back(Point(0, 3));
       inputPolygons.push_back(points);
-
-      if(!mergePolysToPolyTree(inputPolygons, solution))
-         return false;
    }
    else
+      gatherBotZoneBuffers(barrierList, turretList, forceFieldProjectorList, (F32)BufferRadius, inputPolygons);
+
+   // If we've built zones from these exact inputs before, we can skip all the hard work below
+   Vector<F32> cacheKey;
+
+   if(cache)
    {
-      // Merge bot zone buffers from barriers, turrets, and forcefield projectors
-      // The Clipper library is the work horse here.  Its output is essential for the
-      // triangulation.  The output contains the upscaled Clipper points (you will need to downscale)
-      if(!mergeBotZoneBuffers(barrierList, turretList, forceFieldProjectorList, (F32)BufferRadius, solution))
-         return false;
+      buildBotZoneCacheKey(worldExtents, inputPolygons, teleporterData, triangulateZones, cacheKey);
+
+      if(cache->restore(cacheKey, botZoneDatabase))
+      {
+         populateZoneList(botZoneDatabase, allZones);
+         return true;
+      }
    }
 
+   // Merge bot zone buffers from barriers, turrets, and forcefield projectors
+   // The Clipper library is the work horse here.  Its output is essential for the
+   // triangulation.  The output contains the upscaled Clipper points (you will need to downscale)
+   PolyTree solution;
+
+   if(!mergePolysToPolyTree(inputPolygons, solution))
+      return false;
+
 
 #ifdef LOG_TIMER
    U32 done1 = Platform::getRealMilliseconds();
@@ -558,6 +608,9 @@ bool BotNavMeshZone::buildBotMeshZones(GridDatabase *botZoneDatabase, Vector<Bot
 
       buildBotNavMeshZoneConnectionsRecastStyle(allZones, mesh, polyToZoneMap);
       linkTeleportersBotNavMeshZoneConnections(botZoneDatabase, teleporterData);
+
+      if(cache)
+         cache->add(cacheKey, *allZones, triangulateZones);
    }
 
    // If recast failed, build zones from the underlying triangle geometry.  This bit could be made more efficient by using the adjacnecy
@@ -662,6 +715,99 @@ NeighboringZone::NeighboringZone()
 }
 
 
+////////////////////////////////////////
+////////////////////////////////////////
+
+// Destructor
+BotZoneCache::~BotZoneCache()
+{
+   clear();
+}
+
+
+// If we have zones built from key, add copies of them to botZoneDatabase and return true
+bool BotZoneCache::restore(const Vector<F32> &key, GridDatabase *botZoneDatabase)
+{
+   for(S32 i = mSnapshots.size() - 1; i >= 0; i--)
+   {
+      Snapshot *snapshot = mSnapshots[i];
+
+      if(snapshot->key.size() != key.size())
+         continue;
+
+      bool match = true;
+      for(S32 j = 0; j < key.size() && match; j++)
+         match = snapshot->key[j] == key[j];
+
+      if(!match)
+         continue;
+
+      for(S32 j = 0; j < snapshot->zoneIds.size(); j++)
+      {
+         BotNavMeshZone *botzone = new BotNavMeshZone(snapshot->zoneIds[j]);
+
+         if(!snapshot->triangulate)
+            botzone->disableTriangulation();
+
+         const Vector<Point> &outline = snapshot->outlines[j];
+         for(S32 k = 0; k < outline.size(); k++)
+            botzone->addVert(outline[k]);
+
+         botzone->mNeighbors = snapshot->neighbors[j];
+         botzone->addToZoneDatabase(botZoneDatabase);
+      }
+
+      // Most recently used goes to the back, so it's the last to be dropped
+      mSnapshots.erase(i);
+      mSnapshots.push_back(snapshot);
+
+      return true;
+   }
+
+   return false;
+}
+
+
+// Remember zones, which were built from key
+void BotZoneCache::add(const Vector<F32> &key, const Vector<BotNavMeshZone *> &zones, bool triangulate)
+{
+   if(mSnapshots.size() >= MaxSnapshots)
+   {
+      mSnapshots.deleteAndErase(0);
+   }
+
+   Snapshot *snapshot = new Snapshot;
+
+   snapshot->key = key;
+   snapshot->triangulate = triangulate;
+
+   snapshot->zoneIds.resize(zones.size());
+   snapshot->outlines.resize(zones.size());
+   snapshot->neighbors.resize(zones.size());
+
+   for(S32 i = 0; i < zones.size(); i++)
+   {
+      snapshot->zoneIds[i] = zones[i]->getZoneId();
+      snapshot->outlines[i] = *zones[i]->getOutline();
+      snapshot->neighbors[i] = zones[i]->mNeighbors;
+   }
+
+   mSnapshots.push_back(snapshot);
+}
+
+
+void BotZoneCache::clear()
+{
+   mSnapshots.deleteAndClear();
+}
+
+
+S32 BotZoneCache::getSnapshotCount() const
+{
+   return mSnapshots.size();
+}
+
+
 ////////////////////////////////////////
 ////////////////////////////////////////
 
@@ -40,6 +40,41 @@ public:
 
 
 class ServerGame;
+class BotNavMeshZone;
+
+////////////////////////////////////////
+////////////////////////////////////////
+
+// Building zones means clipping, triangulating and merging the whole level, which is by far the slowest part of
+// loading a big level.  The cache remembers the zones built for the last few sets of inputs, so restarting a level,
+// or coming back around to it in the rotation, can just copy them back.  Inputs are compared exactly, so levelgens
+// that move walls around simply miss.
+class BotZoneCache
+{
+private:
+   static const S32 MaxSnapshots = 16;
+
+   struct Snapshot
+   {
+      Vector<F32> key;                             // Everything that went into building the zones, flattened
+      Vector<U16> zoneIds;
+      Vector<Vector<Point> > outlines;
+      Vector<Vector<NeighboringZone> > neighbors;
+      bool triangulate;
+   };
+
+   Vector<Snapshot *> mSnapshots;                  // Most recently used last
+
+public:
+   ~BotZoneCache();     // Destructor
+
+   bool restore(const Vector<F32> &key, GridDatabase *botZoneDatabase);
+   void add(const Vector<F32> &key, const Vector<BotNavMeshZone *> &zones, bool triangulate);
+   void clear();
+
+   S32 getSnapshotCount() const;
+};
+
 
 ////////////////////////////////////////
 ////////////////////////////////////////
@@ -82,7 +117,8 @@ public:
    static bool buildBotMeshZones(GridDatabase *botZoneDatabase, Vector<BotNavMeshZone *> *allZones,
                                  const Rect *worldExtents, const Vector<DatabaseObject *> &barrierList,
                                  const Vector<DatabaseObject *> &turretList, const Vector<DatabaseObject *> &forceFieldProjectorList,
-                                 const Vector<pair<Point, const Vector<Point> *> > &teleporterData, bool triangulateZones);
+                                 const Vector<pair<Point, const Vector<Point> *> > &teleporterData, bool triangulateZones,
+                                 BotZoneCache *cache = NULL);
 
    static bool buildBotNavMeshZoneConnectionsRecastStyle(const Vector<BotNavMeshZone *> *allZones, 
                                                          rcPolyMesh &mesh, const Vector<S32> &polyToZoneMap);
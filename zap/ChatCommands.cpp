@@ -476,6 +476,13 @@ void undeleteLevelHandler(ClientGame *game, const Vector<string> &words)
 }
 
 
+void tickProfileHandler(ClientGame *game, const Vector<string> &words)
+{
+   if(game->hasAdmin("!!! You don't have permission to view the tick profile"))
+      game->getConnectionToServer()->c2sRequestTickProfile();
+}
+
+
 void idleHandler(ClientGame *game, const Vector<string> &words)
 {
    // No sense entering idle if you're already delayed in some capactiy... just sit tight!
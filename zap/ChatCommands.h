@@ -110,6 +110,7 @@ void idleHandler               (ClientGame *game, const Vector<string> &args);
 void showPresetsHandler        (ClientGame *game, const Vector<string> &args);
 void deleteCurrentLevelHandler (ClientGame *game, const Vector<string> &args);
 void undeleteLevelHandler      (ClientGame *game, const Vector<string> &args);
+void tickProfileHandler        (ClientGame *game, const Vector<string> &args);
 void addTimeHandler            (ClientGame *game, const Vector<string> &args);
 void setTimeHandler            (ClientGame *game, const Vector<string> &args);
 void setWinningScoreHandler    (ClientGame *game, const Vector<string> &args);
@@ -82,6 +82,9 @@ ClientGame::ClientGame(const Address &bindAddress, GameSettingsPtr settings, UIM
    mPreviousLevelName = "";
 
    mLocalRemoteClientInfo = NULL;         // Will be set when we join a game
+
+   mLevelGeometryCache.setFolder(GameSettings::getFolderManager()->cacheDir);
+   mLevelGeometryCache.loadAll();
 }
 
 
@@ -268,12 +271,88 @@ void ClientGame::startLoadingLevel(bool engineerEnabled)
 void ClientGame::doneLoadingLevel()
 {
    computeWorldObjectExtents();              // Make sure our world extents reflect all the objects we've loaded
-   Barrier::prepareRenderingGeometry(this);  // Get walls ready to render
+   getGameObjDatabase()->resizeGrid(mWorldExtents);
+   getGameObjDatabase()->buildStaticIndex();
+
+   // Get walls ready to render -- clipping them is slow for big levels, so we keep the results for next time
+   const LevelGeometryCache::CachedLevel *cachedLevel = mLevelGeometryCache.getLevel(mLevelGeometryHash);
+
+   if(cachedLevel)
+   {
+      Barrier::mRenderLineSegments = cachedLevel->edges;
+      mLevelGeometryCache.markUsed(mLevelGeometryHash);
+   }
+   else
+   {
+      Barrier::prepareRenderingGeometry(this);
+
+      Vector<string> evictedHashes;
+
+      if(mReceivedWalls.size() > 0 && 
+         mLevelGeometryCache.addLevel(mLevelGeometryHash, mReceivedWalls, Barrier::mRenderLineSegments, evictedHashes))
+      {
+         // There's no server to tell when we're watching a recording; a real one gets our whole list when we connect
+         GameConnection *connection = getConnectionToServer();
+
+         if(connection && !dynamic_cast<GameRecorderPlayback *>(connection))
+         {
+            if(evictedHashes.size() > 0)
+            {
+               Vector<StringPtr> evicted(evictedHashes.size());
+               for(S32 i = 0; i < evictedHashes.size(); i++)
+                  evicted.push_back(evictedHashes[i].c_str());
+
+               connection->c2sRemoveCachedLevels(evicted);
+            }
+
+            Vector<StringPtr> hashes;
+            hashes.push_back(mLevelGeometryHash.c_str());
+            connection->c2sAddCachedLevels(hashes);
+         }
+      }
+   }
+
+   mReceivedWalls.clear();
 
    getUIManager()->doneLoadingLevel();
 }
 
 
+// Server tells us which walls the level has before sending them; if we told it we have them cached, it won't send them,
+// and we'll build them ourselves
+void ClientGame::setLevelGeometry(const string &wallsHash, bool useCachedWalls)
+{
+   mLevelGeometryHash = wallsHash;
+   mReceivedWalls.clear();
+
+   if(!useCachedWalls)
+      return;
+
+   const LevelGeometryCache::CachedLevel *cachedLevel = mLevelGeometryCache.getLevel(wallsHash);
+
+   TNLAssert(cachedLevel, "Server thinks we have walls we never told it about!");
+   if(!cachedLevel)
+      return;
+
+   deleteObjects((TestFunc)isWallType);
+
+   for(S32 i = 0; i < cachedLevel->walls.size(); i++)
+      cachedLevel->walls[i].constructWalls(this);
+}
+
+
+void ClientGame::addReceivedWall(const WallRec &wall)
+{
+   mReceivedWalls.push_back(wall);
+}
+
+
+void ClientGame::getCachedLevelHashes(Vector<string> &hashes) const
+{
+   mLevelGeometryCache.getHashes(hashes);
+}
+
+
 ClientInfo *ClientGame::getClientInfo() const
 {
    return mClientInfo;
@@ -18,6 +18,7 @@
 #include "SparkTypesEnum.h"
 #include "gameConnection.h"
 #include "MasterTypes.h"
+#include "LevelGeometryCache.h"
 
 #include "SDL_gamecontroller.h"
 
@@ -59,6 +60,10 @@ private:
 
    string mPreviousLevelName;    // For /prevlevel command
 
+   LevelGeometryCache mLevelGeometryCache;
+   string mLevelGeometryHash;       // Identifies the walls of the level being loaded, as told to us by the server
+   Vector<WallRec> mReceivedWalls;  // Walls the server sent us for this level, kept so we can cache them
+
    bool needsRating() const;
 
    static PersonalRating getNextRating(PersonalRating currentRating);
@@ -113,6 +118,10 @@ public:
    void startLoadingLevel(bool engineerEnabled);
    void doneLoadingLevel();
 
+   void setLevelGeometry(const string &wallsHash, bool useCachedWalls);
+   void addReceivedWall(const WallRec &wall);
+   void getCachedLevelHashes(Vector<string> &hashes) const;
+
    void gotTotalLevelRating(S16 rating);
    void gotPlayerLevelRating(S32 rating);
 
@@ -1371,7 +1371,7 @@ ForceFieldProjector::~ForceFieldProjector()
 
 void ForceFieldProjector::initialize()
 {
-   mNetFlags.set(Ghostable);
+   mNetFlags.set(Ghostable | SharedUpdates);
    mObjectTypeNumber = ForceFieldProjectorTypeNumber;
    onGeomChanged();     // Can't be placed on parent, as parent constructor must initalized first
 
@@ -1718,7 +1718,7 @@ ForceField::ForceField(S32 team, Point start, Point end)
    updateGeomAndExtents();
 
    mObjectTypeNumber = ForceFieldTypeNumber;
-   mNetFlags.set(Ghostable);
+   mNetFlags.set(Ghostable | SharedUpdates);
 }
 
 // Destructor
@@ -1999,8 +1999,10 @@ void Turret::initialize()
 {
    mObjectTypeNumber = TurretTypeNumber;
 
+   mTargetsInRangeSignature = 0;
+
    mWeaponFireType = WeaponTurret;
-   mNetFlags.set(Ghostable);
+   mNetFlags.set(Ghostable | SharedUpdates);
 
    onGeomChanged();
 
@@ -2184,6 +2186,176 @@ void Turret::unpackUpdate(GhostConnection *connection, BitStream *stream)
 }
 
 
+// Constructor
+TurretTargetList::TurretTargetList()
+{
+   mDatabase = NULL;
+   mBuiltAt = 0;
+   mBuilt = false;
+}
+
+
+const Vector<SafePtr<BfObject> > &TurretTargetList::getTargets(const GridDatabase *database, U32 tickCount)
+{
+   if(mBuilt && database == mDatabase && tickCount == mBuiltAt)
+      return mTargets;
+
+   mDatabase = database;
+   mBuiltAt = tickCount;
+   mBuilt = true;
+
+   mTargets.clear();
+
+   static Vector<U8> targetTypes;
+
+   if(targetTypes.size() == 0)
+      getTypeNumbers(isTurretTargetType, targetTypes);
+
+   for(S32 i = 0; i < targetTypes.size(); i++)
+   {
+      const Vector<DatabaseObject *> *objects = database->findObjects_fast(targetTypes[i]);
+
+      for(S32 j = 0; j < objects->size(); j++)
+      {
+         BfObject *obj = static_cast<BfObject *>(objects->get(j));
+
+         if(!obj->isDeleted())
+            mTargets.push_back(obj);
+      }
+   }
+
+   return mTargets;
+}
+
+
+void TurretTargetList::clear()
+{
+   mTargets.clear();
+   mBuilt = false;
+}
+
+
+////////////////////////////////////////
+////////////////////////////////////////
+
+struct TurretCandidate
+{
+   BfObject *target;
+   Point delta;         // From our aim point to where we need to shoot to hit it
+   F32 distSquared;
+};
+
+
+static bool sortCandidatesByDist(const TurretCandidate &a, const TurretCandidate &b)
+{
+   return a.distSquared < b.distSquared;
+}
+
+
+static Vector<TurretCandidate> turretCandidates;     // Reused by every turret, every tick
+
+
+// The cheap checks: is potential an enemy we can hit and are facing?  If so, delta is where we'd need to aim.
+bool Turret::isTargetInRange(BfObject *potential, const Point &aimPos, const WeaponInfo &weaponInfo, Point &delta)
+{
+   if(isShipType(potential->getObjectTypeNumber()))
+   {
+      Ship *ship = static_cast<Ship *>(potential);
+
+      // Is it dead or cloaked?  Carrying objects makes ship visible, except in nexus game
+      if(!ship->isVisible(false) || ship->mHasExploded)
+         return false;
+   }
+
+   // Don't target mounted items (like resourceItems and flagItems)
+   if(isMountableItemType(potential->getObjectTypeNumber()))
+      if(static_cast<MountableItem *>(potential)->isMounted())
+         return false;
+
+   if(potential->getTeam() == getTeam())     // Is target on our team?
+      return false;                          // ...if so, skip it!
+
+   // Calculate where we have to shoot to hit this...
+   Point Vs = potential->getVel();
+   F32 S = (F32)weaponInfo.projVelocity;
+   Point d = potential->getPos() - aimPos;
+
+// This could possibly be combined with Robot's getFiringSolution, as it's essentially the same thing
+   F32 t;      // t is set in next statement
+   if(!findLowestRootInInterval(Vs.dot(Vs) - S * S, 2 * Vs.dot(d), d.dot(d), weaponInfo.projLiveTime * 0.001f, t))
+      return false;
+
+   Point leadPos = potential->getPos() + Vs * t;
+
+   // Calculate distance
+   delta = (leadPos - aimPos);
+
+   Point angleCheck = delta;
+   angleCheck.normalize();
+
+   // Check that we're facing it...
+   return angleCheck.dot(mAnchorNormal) > -0.1f;
+}
+
+
+// Walls don't move, so the answer only changes when the target does; we reuse it until the target leaves its cell
+bool Turret::canSeeTarget(BfObject *target, const Point &aimPos)
+{
+   S32 cellX = S32(floor(target->getPos().x / SightingCellSize));
+   S32 cellY = S32(floor(target->getPos().y / SightingCellSize));
+
+   Sighting *sighting = NULL;
+
+   for(S32 i = 0; i < mSightings.size(); i++)
+      if(mSightings[i].target == target)
+      {
+         sighting = &mSightings[i];
+         break;
+      }
+
+   if(sighting)
+   {
+      sighting->seen = true;
+
+      if(sighting->cellX == cellX && sighting->cellY == cellY)
+         return !sighting->blocked;
+   }
+   else
+   {
+      mSightings.push_back(Sighting());
+      sighting = &mSightings.last();
+      sighting->target = target;
+      sighting->seen = true;
+   }
+
+   F32 t;
+   Point n;
+
+   sighting->cellX = cellX;
+   sighting->cellY = cellY;
+   sighting->blocked = findObjectLOS((TestFunc)isWallType, ActualState, aimPos, target->getPos(), t, n) != NULL;
+
+   return !sighting->blocked;
+}
+
+
+// See if we're gonna clobber our own stuff...
+bool Turret::isFriendlyInTheWay(const Point &aimPos, const Point &delta, const WeaponInfo &weaponInfo)
+{
+   F32 t;
+   Point n;
+
+   disableCollision();
+   Point delta2 = delta;
+   delta2.normalize(weaponInfo.projLiveTime * (F32)weaponInfo.projVelocity / 1000.f);
+   BfObject *hitObject = findObjectLOS((TestFunc) isWithHealthType, 0, aimPos, aimPos + delta2, t, n);
+   enableCollision();
+
+   return hitObject && hitObject->getTeam() == getTeam() &&
+         (hitObject->getPos() - aimPos).lenSquared() < delta.lenSquared();
+}
+
+
 // Choose target, aim, and, if possible, fire
 void Turret::idle(IdleCallPath path)
 {
@@ -2198,6 +2370,7 @@ void Turret::idle(IdleCallPath path)
       return;
 
    mFireTimer.update(mCurrentMove.time);
+   mRetargetTimer.update(mCurrentMove.time);
 
    // Choose best target:
    Point aimPos = getPos() + mAnchorNormal * TURRET_OFFSET;
@@ -2207,83 +2380,90 @@ void Turret::idle(IdleCallPath path)
    queryRect.unionPoint(aimPos + cross * TurretPerceptionDistance);
    queryRect.unionPoint(aimPos - cross * TurretPerceptionDistance);
    queryRect.unionPoint(aimPos + mAnchorNormal * TurretPerceptionDistance);
-   fillVector.clear();
-   findObjects((TestFunc)isTurretTargetType, fillVector, queryRect);    // Get all potential targets
+
+   TNLAssert(dynamic_cast<ServerGame *>(getGame()), "Turrets only idle on the server!");
+   const Vector<SafePtr<BfObject> > &targets = static_cast<ServerGame *>(getGame())->getTurretTargetList()->getTargets(getDatabase(), getGame()->getTickCount());
 
    WeaponInfo weaponInfo = WeaponInfo::getWeaponInfo(mWeaponFireType);
 
-   BfObject *bestTarget = NULL;
-   F32 bestRange = F32_MAX;
-   Point bestDelta;
+   // First find everyone we could shoot at, were it not for walls or friends in the way
+   turretCandidates.clear();
+   U32 signature = 0;
 
-   Point delta;
-   for(S32 i = 0; i < fillVector.size(); i++)
+   for(S32 i = 0; i < targets.size(); i++)
    {
-      if(isShipType(fillVector[i]->getObjectTypeNumber()))
-      {
-         Ship *potential = static_cast<Ship *>(fillVector[i]);
+      BfObject *target = targets[i];
 
-         // Is it dead or cloaked?  Carrying objects makes ship visible, except in nexus game
-         if(!potential->isVisible(false) || potential->mHasExploded)
-            continue;
-      }
+      // Something else may have killed it off earlier in this tick
+      if(!target || target->isDeleted())
+         continue;
 
-      // Don't target mounted items (like resourceItems and flagItems)
-      if(isMountableItemType(fillVector[i]->getObjectTypeNumber()))
-         if(static_cast<MountableItem *>(fillVector[i])->isMounted())
-            continue;
-      
-      BfObject *potential = static_cast<BfObject *>(fillVector[i]);
-      if(potential->getTeam() == getTeam())     // Is target on our team?
-         continue;                              // ...if so, skip it!
+      if(!queryRect.intersects(target->getExtent()))
+         continue;
 
-      // Calculate where we have to shoot to hit this...
-      Point Vs = potential->getVel();
-      F32 S = (F32)weaponInfo.projVelocity;
-      Point d = potential->getPos() - aimPos;
+      TurretCandidate candidate;
 
-// This could possibly be combined with Robot's getFiringSolution, as it's essentially the same thing
-      F32 t;      // t is set in next statement
-      if(!findLowestRootInInterval(Vs.dot(Vs) - S * S, 2 * Vs.dot(d), d.dot(d), weaponInfo.projLiveTime * 0.001f, t))
+      if(!isTargetInRange(target, aimPos, weaponInfo, candidate.delta))
          continue;
 
-      Point leadPos = potential->getPos() + Vs * t;
+      candidate.target = target;
+      candidate.distSquared = candidate.delta.lenSquared();
+      turretCandidates.push_back(candidate);
 
-      // Calculate distance
-      delta = (leadPos - aimPos);
-
-      Point angleCheck = delta;
-      angleCheck.normalize();
+      signature += U32(size_t(target)) * 2654435761u;     // Doesn't depend on order
+   }
 
-      // Check that we're facing it...
-      if(angleCheck.dot(mAnchorNormal) <= -0.1f)
-         continue;
+   signature += turretCandidates.size();
 
-      // See if we can see it...
-      Point n;
-      if(findObjectLOS((TestFunc)isWallType, ActualState, aimPos, potential->getPos(), t, n))
-         continue;
+   BfObject *bestTarget = NULL;
+   Point bestDelta;
 
-      // See if we're gonna clobber our own stuff...
-      disableCollision();
-      Point delta2 = delta;
-      delta2.normalize(weaponInfo.projLiveTime * (F32)weaponInfo.projVelocity / 1000.f);
-      BfObject *hitObject = findObjectLOS((TestFunc) isWithHealthType, 0, aimPos, aimPos + delta2, t, n);
-      enableCollision();
+   // If nobody has come or gone since we picked our target, we'll stay on it for a bit without considering the others
+   if(mTarget.isValid() && signature == mTargetsInRangeSignature && mRetargetTimer.getCurrent() > 0)
+   {
+      for(S32 i = 0; i < turretCandidates.size(); i++)
+         if(turretCandidates[i].target == mTarget)
+         {
+            if(canSeeTarget(turretCandidates[i].target, aimPos) && 
+               !isFriendlyInTheWay(aimPos, turretCandidates[i].delta, weaponInfo))
+            {
+               bestTarget = turretCandidates[i].target;
+               bestDelta = turretCandidates[i].delta;
+            }
+            break;
+         }
+   }
 
-      // Skip this target if there's a friendly object in the way
-      if(hitObject && hitObject->getTeam() == getTeam() &&
-        (hitObject->getPos() - aimPos).lenSquared() < delta.lenSquared())         
-         continue;
+   // Otherwise the closest one we can hit wins; the expensive checks only need doing until we find it
+   if(!bestTarget)
+   {
+      turretCandidates.sort(sortCandidatesByDist);
 
-      F32 dist = delta.len();
+      for(S32 i = 0; i < mSightings.size(); i++)
+         mSightings[i].seen = false;
 
-      if(dist < bestRange)
+      for(S32 i = 0; i < turretCandidates.size(); i++)
       {
-         bestDelta  = delta;
-         bestRange  = dist;
-         bestTarget = potential;
+         if(!canSeeTarget(turretCandidates[i].target, aimPos))
+            continue;
+
+         // Skip this target if there's a friendly object in the way
+         if(isFriendlyInTheWay(aimPos, turretCandidates[i].delta, weaponInfo))
+            continue;
+
+         bestTarget = turretCandidates[i].target;
+         bestDelta = turretCandidates[i].delta;
+         break;
       }
+
+      // Forget sightings of anything that we didn't look at this time around
+      for(S32 i = mSightings.size() - 1; i >= 0; i--)
+         if(!mSightings[i].seen || !mSightings[i].target.isValid())
+            mSightings.erase_fast(i);
+
+      mTarget = bestTarget;
+      mTargetsInRangeSignature = signature;
+      mRetargetTimer.reset(TurretRetargetPeriod);
    }
 
    if(!bestTarget)      // No target, nothing to do
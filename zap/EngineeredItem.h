@@ -299,16 +299,54 @@ public:
 ////////////////////////////////////////
 ////////////////////////////////////////
 
+// Everything a turret might want to shoot at, gathered once per tick and shared by all turrets.  The ServerGame owns one.
+// Team, visibility and the like can change during a tick, so each turret still checks those for itself.
+class TurretTargetList
+{
+private:
+   const GridDatabase *mDatabase;
+   U32 mBuiltAt;                      // Game tick when we last gathered targets
+   bool mBuilt;
+   Vector<SafePtr<BfObject> > mTargets;
+
+public:
+   TurretTargetList();     // Constructor
+
+   // Gathers the targets if we haven't already done so for this tick.  Entries may be NULL or deleted; callers must check.
+   const Vector<SafePtr<BfObject> > &getTargets(const GridDatabase *database, U32 tickCount);
+   void clear();           // Forget the targets; call when objects get deleted
+};
+
+
 class Turret : public EngineeredItem
 {
    typedef EngineeredItem Parent;
 
 private:
+   // A wall line of sight check to a target, remembered until the target leaves its cell
+   struct Sighting
+   {
+      SafePtr<BfObject> target;
+      S32 cellX;
+      S32 cellY;
+      bool blocked;
+      bool seen;           // Target was in range last time we looked
+   };
+
    Timer mFireTimer;
    F32 mCurrentAngle;
 
+   SafePtr<BfObject> mTarget;          // What we've been aiming at
+   U32 mTargetsInRangeSignature;       // Summarizes the potential targets that were in range when we chose mTarget
+   Timer mRetargetTimer;               // Until it goes off, we'll stay on mTarget as long as no one enters or leaves our range
+   Vector<Sighting> mSightings;
+
    void initialize();
 
+   bool isTargetInRange(BfObject *potential, const Point &aimPos, const WeaponInfo &weaponInfo, Point &delta);
+   bool canSeeTarget(BfObject *target, const Point &aimPos);
+   bool isFriendlyInTheWay(const Point &aimPos, const Point &delta, const WeaponInfo &weaponInfo);
+
    F32 getSelectionOffsetMagnitude();
 
 #ifndef ZAP_DEDICATED
@@ -333,6 +371,8 @@ public:
                                                       // Also serves as radius of circle of turret's body, where the turret starts
    static const S32 TurretTurnRate = 4;               // How fast can turrets turn to aim?
    static const S32 TurretPerceptionDistance = 800;   // Area to search for potential targets...
+   static const S32 TurretRetargetPeriod = 100;       // How often we look for a better target, when no one's come or gone (ms)
+   static const S32 SightingCellSize = 16;            // Wall line of sight to a target is rechecked when it moves this far
 
    static const S32 AimMask = Parent::FirstFreeMask;
 
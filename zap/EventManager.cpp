@@ -8,6 +8,7 @@
 #include "CoreGame.h"
 #include "playerInfo.h"          // For RobotPlayerInfo constructor
 #include "robot.h"
+#include "TickProfiler.h"
 #include "Zone.h"
 
 //#include "../lua/luaprofiler-2.0.2/src/luaprofiler.h"      // For... the profiler!
@@ -255,7 +256,7 @@ void EventManager::fireEvent(EventType eventType)
    TNLAssert(lua_gettop(L) == 0 || dumpStack(L), "Stack dirty!");
 
    for(S32 i = 0; i < subscriptions[eventType].size(); i++)
-      fire(L, subscriptions[eventType][i].subscriber, eventDefs[eventType].function, subscriptions[eventType][i].context);
+      fire(L, subscriptions[eventType][i].subscriber, eventType, subscriptions[eventType][i].context);
 }
 
 
@@ -275,7 +276,7 @@ void EventManager::fireEvent(EventType eventType, U32 deltaT)
    for(S32 i = 0; i < subscriptions[eventType].size(); i++)
    {
       lua_pushinteger(L, deltaT);   // -- deltaT
-      fire(L, subscriptions[eventType][i].subscriber, eventDefs[eventType].function, subscriptions[eventType][i].context);
+      fire(L, subscriptions[eventType][i].subscriber, eventType, subscriptions[eventType][i].context);
    }
 }
 
@@ -293,7 +294,7 @@ void EventManager::fireEvent(EventType eventType, CoreItem *core)
    for(S32 i = 0; i < subscriptions[eventType].size(); i++)
    {
       core->push(L);                // -- core
-      fire(L, subscriptions[eventType][i].subscriber, eventDefs[eventType].function, subscriptions[eventType][i].context);
+      fire(L, subscriptions[eventType][i].subscriber, eventType, subscriptions[eventType][i].context);
    }
 }
 
@@ -311,7 +312,7 @@ void EventManager::fireEvent(EventType eventType, Ship *ship)
    for(S32 i = 0; i < subscriptions[eventType].size(); i++)
    {
       ship->push(L);                // -- ship
-      fire(L, subscriptions[eventType][i].subscriber, eventDefs[eventType].function, subscriptions[eventType][i].context);
+      fire(L, subscriptions[eventType][i].subscriber, eventType, subscriptions[eventType][i].context);
    }
 }
 
@@ -340,7 +341,7 @@ void EventManager::fireEvent(EventType eventType, Ship *ship, BfObject *damaging
       else
          lua_pushnil(L);
 
-      fire(L, subscriptions[eventType][i].subscriber, eventDefs[eventType].function, subscriptions[eventType][i].context);
+      fire(L, subscriptions[eventType][i].subscriber, eventType, subscriptions[eventType][i].context);
    }
 }
 
@@ -370,7 +371,7 @@ void EventManager::fireEvent(LuaScriptRunner *sender, EventType eventType, const
 
       lua_pushboolean(L, global);   // -- message, player, isGlobal
 
-      fire(L, subscriptions[eventType][i].subscriber, eventDefs[eventType].function, subscriptions[eventType][i].context);
+      fire(L, subscriptions[eventType][i].subscriber, eventType, subscriptions[eventType][i].context);
    }
 }
 
@@ -391,7 +392,7 @@ void EventManager::fireEvent(LuaScriptRunner *player, EventType eventType, LuaPl
          continue;
 
       playerInfo->push(L);          // -- playerInfo
-      fire(L, subscriptions[eventType][i].subscriber, eventDefs[eventType].function, subscriptions[eventType][i].context);
+      fire(L, subscriptions[eventType][i].subscriber, eventType, subscriptions[eventType][i].context);
    }
 }
 
@@ -416,7 +417,7 @@ void EventManager::fireEvent(EventType eventType, Ship *ship, Zone *zone)
          lua_pushinteger(L, zone->getObjectTypeNumber());   // -- ship, zone, zone->objTypeNumber
          lua_pushinteger(L, zone->getUserAssignedId());     // -- ship, zone, zone->objTypeNumber, zone->id
 
-         fire(L, subscriptions[eventType][i].subscriber, eventDefs[eventType].function, subscriptions[eventType][i].context);
+         fire(L, subscriptions[eventType][i].subscriber, eventType, subscriptions[eventType][i].context);
       }
       catch(LuaException &e)
       {
@@ -448,7 +449,7 @@ void EventManager::fireEvent(EventType eventType, MoveObject *object, Zone *zone
          lua_pushinteger(L, zone->getObjectTypeNumber());   // -- object, zone, zone->objTypeNumber
          lua_pushinteger(L, zone->getUserAssignedId());     // -- object, zone, zone->objTypeNumber, zone->id
 
-         fire(L, subscriptions[eventType][i].subscriber, eventDefs[eventType].function, subscriptions[eventType][i].context);
+         fire(L, subscriptions[eventType][i].subscriber, eventType, subscriptions[eventType][i].context);
       }
       catch(LuaException &e)
       {
@@ -480,17 +481,20 @@ void EventManager::fireEvent(EventType eventType, S32 score, S32 team, LuaPlayer
       else
          lua_pushnil(L);
 
-      fire(L, subscriptions[eventType][i].subscriber, eventDefs[eventType].function, subscriptions[eventType][i].context);
+      fire(L, subscriptions[eventType][i].subscriber, eventType, subscriptions[eventType][i].context);
    }
 }
 
 
 // Actually fire the event, called by one of the fireEvent() methods above
 // Returns true if there was an error, false if everything ran ok
-bool EventManager::fire(lua_State *L, LuaScriptRunner *scriptRunner, const char *function, ScriptContext context)
+bool EventManager::fire(lua_State *L, LuaScriptRunner *scriptRunner, EventType eventType, ScriptContext context)
 {
+   // Ticks are mostly robots doing their thinking, and get counted separately from everything else
+   ProfileScope profileScope(eventType == TickEvent ? TickProfiler::PhaseRobots : TickProfiler::PhaseEvents);
+
    setScriptContext(L, context);
-   return scriptRunner->runCmd(function, 0);
+   return scriptRunner->runCmd(eventDefs[eventType].function, 0);
 }
 
 
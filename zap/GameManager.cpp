@@ -6,6 +6,10 @@
 #include "GameManager.h"
 
 #include "ServerGame.h"
+#include "gameNetInterface.h"
+#include "TickProfiler.h"
+
+#include "stringUtils.h"
 
 #ifndef ZAP_DEDICATED
 #  include "UIErrorMessage.h"
@@ -23,6 +27,7 @@ ServerGame *GameManager::mServerGame = NULL;
    Vector<ClientGame *> GameManager::mClientGames;
 #endif
 GameManager::HostingModePhase GameManager::mHostingModePhase = GameManager::NotHosting;
+Timer GameManager::mProfileDumpTimer;
 
 
 // Constructor
@@ -64,8 +69,57 @@ void GameManager::deleteServerGame()
 
 void GameManager::idleServerGame(U32 timeDelta)
 {
+   TickProfiler::beginTick();
+
    if(mServerGame)
       mServerGame->idle(timeDelta);
+
+   // Suspended games do next to nothing, and would only drag the numbers down
+   TickProfiler::endTick(!(mServerGame && mServerGame->isSuspended()));
+
+   dumpTickProfile(timeDelta);
+}
+
+
+// Appends the profiler's report to a file in the log folder every so often, if the INI asks for it
+void GameManager::dumpTickProfile(U32 timeDelta)
+{
+   if(!mServerGame)
+      return;
+
+   U32 interval = mServerGame->getSettings()->getIniSettings()->tickProfileDumpInterval * 1000;
+
+   if(interval == 0)
+      return;
+
+   if(mProfileDumpTimer.getPeriod() != interval)
+      mProfileDumpTimer.reset(interval, interval);
+
+   if(!mProfileDumpTimer.update(timeDelta))
+      return;
+
+   mProfileDumpTimer.reset();
+
+   Vector<string> lines;
+   mServerGame->getPerformanceReport(lines);
+
+   string report = "Tick profile at " + getTimeStamp() + "\n";
+   for(S32 i = 0; i < lines.size(); i++)
+      report += "   " + lines[i] + "\n";
+
+   string filename = joindir(mServerGame->getSettings()->getFolderManager()->logDir, "tickprofile.log");
+
+   if(!writeFile(filename, report + "\n", true))
+      logprintf(LogConsumer::LogError, "Could not write tick profile to %s", filename.c_str());
+}
+
+
+// Read whatever packets are waiting for the ServerGame; used by the fixed tick scheduler, which sleeps until packets
+// arrive and would otherwise wake up to the same unread packets over and over until the next tick
+void GameManager::checkIncomingPackets()
+{
+   if(mServerGame)
+      mServerGame->getNetInterface()->checkIncomingPackets();
 }
 
 
@@ -8,6 +8,8 @@
 
 #include "tnlVector.h"
 
+#include "Timer.h"
+
 using namespace TNL;
 
 namespace Zap
@@ -31,7 +33,14 @@ public:
    };
 
 private:
+   // There is only ever one ServerGame per process.  The Lua state, the EventManager and the object add target are all
+   // process-wide, and lots of code finds "the" ServerGame through getServerGame(), so to host several games, run
+   // several bitfighterd processes.
    static ServerGame *mServerGame;
+
+   static Timer mProfileDumpTimer;
+   static void dumpTickProfile(U32 timeDelta);
+
 #ifndef ZAP_DEDICATED
    static Vector<ClientGame *> mClientGames;
 #endif
@@ -47,6 +56,7 @@ public:
    static ServerGame *getServerGame();
    static void deleteServerGame();
    static void idleServerGame(U32 timeDelta);
+   static void checkIncomingPackets();         // Read packets for the ServerGame between ticks
 
    // ClientGame related
 #ifndef ZAP_DEDICATED
@@ -64,6 +64,7 @@ enum ParamId {
    MUSIC_DIR,
    FONTS_DIR,
    RECORD_DIR,
+   CACHE_DIR,
 
    SIMULATED_LOSS,
    SIMULATED_LAG,
@@ -42,6 +42,12 @@
 #include <math.h>
 #include <deque>
 
+// SSE2 is part of every x86-64 processor; elsewhere we'll fall back to plain C++
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#  define BF_USE_SSE2
+#  include <emmintrin.h>
+#endif
+
 using namespace TNL;
 using namespace ClipperLib;
 
@@ -436,6 +442,86 @@ bool circleIntersectsSegment(Point center, float radius, Point start, Point end,
 }
 
 
+// Scalar version of the per-circle test in sweptCircleHitTimes()
+static inline F32 sweptCircleHitTime(const Point &pos, const Point &vel, F32 radius, F32 x, F32 y, F32 otherRadius, F32 maxTime)
+{
+   F32 px = pos.x - x;
+   F32 py = pos.y - y;
+   F32 R = radius + otherRadius;
+
+   F32 halfB = px * vel.x + py * vel.y;
+   if(halfB >= 0)                   // Not approaching
+      return -1;
+
+   F32 c = px * px + py * py - R * R;
+   if(c <= 0)                       // Already overlapping
+      return 0;
+
+   F32 a = vel.x * vel.x + vel.y * vel.y;
+   F32 determinant = halfB * halfB - a * c;
+   if(determinant < 0)
+      return -1;
+
+   // Same numerically stable root finding as findLowestRootInInterval(); since halfB < 0 and c > 0, both roots are positive
+   F32 q = sqrt(determinant) - halfB;
+   F32 t = min(q / a, c / q);
+
+   return t <= maxTime ? t : -1;
+}
+
+
+// Find when a circle at pos, moving at vel, would first touch each of count other circles, given as arrays of x, y and
+// radius so we can test four at a time with SSE.  Each hitTimes entry will be the time of collision, 0 if the circles
+// already overlap, or -1 if they won't collide before maxTime.  Circles moving apart never collide, even if they overlap;
+// that's how MoveObject::findFirstCollision() lets objects that are stuck together escape.
+void sweptCircleHitTimes(const Point &pos, const Point &vel, F32 radius, const F32 *x, const F32 *y, const F32 *radii, S32 count,
+                         F32 maxTime, F32 *hitTimes)
+{
+   S32 i = 0;
+
+#ifdef BF_USE_SSE2
+   const __m128 posX  = _mm_set1_ps(pos.x);
+   const __m128 posY  = _mm_set1_ps(pos.y);
+   const __m128 velX  = _mm_set1_ps(vel.x);
+   const __m128 velY  = _mm_set1_ps(vel.y);
+   const __m128 rad   = _mm_set1_ps(radius);
+   const __m128 a     = _mm_set1_ps(vel.x * vel.x + vel.y * vel.y);
+   const __m128 tMax  = _mm_set1_ps(maxTime);
+   const __m128 zero  = _mm_setzero_ps();
+   const __m128 noHit = _mm_set1_ps(-1);
+
+   for(; i + 4 <= count; i += 4)
+   {
+      __m128 px = _mm_sub_ps(posX, _mm_loadu_ps(x + i));
+      __m128 py = _mm_sub_ps(posY, _mm_loadu_ps(y + i));
+      __m128 R  = _mm_add_ps(rad, _mm_loadu_ps(radii + i));
+
+      __m128 halfB = _mm_add_ps(_mm_mul_ps(px, velX), _mm_mul_ps(py, velY));
+      __m128 c = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(px, px), _mm_mul_ps(py, py)), _mm_mul_ps(R, R));
+      __m128 determinant = _mm_sub_ps(_mm_mul_ps(halfB, halfB), _mm_mul_ps(a, c));
+
+      // Lanes that end up unused may divide by zero or take the root of a negative number; that's harmless
+      __m128 q = _mm_sub_ps(_mm_sqrt_ps(determinant), halfB);
+      __m128 t = _mm_min_ps(_mm_div_ps(q, a), _mm_div_ps(c, q));
+
+      __m128 approaching = _mm_cmplt_ps(halfB, zero);
+      __m128 overlapping = _mm_cmple_ps(c, zero);
+      __m128 hit = _mm_and_ps(_mm_cmpge_ps(determinant, zero), _mm_cmple_ps(t, tMax));
+
+      // Pick 0 for overlapping lanes, t for hits, -1 for everything else
+      __m128 result = _mm_or_ps(_mm_and_ps(hit, t), _mm_andnot_ps(hit, noHit));
+      result = _mm_andnot_ps(overlapping, result);                  // Overlapping lanes become 0
+      result = _mm_or_ps(_mm_and_ps(approaching, result), _mm_andnot_ps(approaching, noHit));
+
+      _mm_storeu_ps(hitTimes + i, result);
+   }
+#endif
+
+   for(; i < count; i++)
+      hitTimes[i] = sweptCircleHitTime(pos, vel, radius, x[i], y[i], radii[i], maxTime);
+}
+
+
 // Do segments sit on same virtual line?
 bool segmentsColinear(const Point &p1, const Point &p2, const Point &p3, const Point &p4)
 {
@@ -88,6 +88,8 @@ bool polygonsIntersect(const Vector<Point> &p1, const Vector<Point> &p2);
 bool polygonIntersectsSegment(const Vector<Point> &points, const Point &start, const Point &end);  // This is four times faster than the Detailed one.
 bool polygonIntersectsSegmentDetailed(const Point *poly, U32 vertexCount, bool format, const Point &start, const Point &end, float &collisionTime, Point &normal);
 bool circleIntersectsSegment(Point center, F32 radius, Point start, Point end, float &collisionTime);
+void sweptCircleHitTimes(const Point &pos, const Point &vel, F32 radius, const F32 *x, const F32 *y, const F32 *radii, S32 count,
+                         F32 maxTime, F32 *hitTimes);    // Swept circle vs. many circles; see GeomUtils.cpp
 
 Point findCentroid(const Vector<Point> &polyPoints);
 F32 area(const Vector<Point> &polyPoints);
@@ -0,0 +1,315 @@
+//------------------------------------------------------------------------------
+// Copyright Chris Eykamp
+// See LICENSE.txt for full copyright information
+//------------------------------------------------------------------------------
+
+#include "LevelGeometryCache.h"
+
+#include "game.h"          // For Game::md5
+#include "stringUtils.h"
+
+#include <sstream>
+#include <stdio.h>
+
+
+namespace Zap
+{
+
+static const char *CacheFileExtension = "walls";
+static const char *OrderFilename = "recently_used.txt";     // Hashes, least recently used first
+
+
+// Floats are written with enough digits to read back exactly, and everything goes on one line, so the text is
+// the same wherever it's written and read
+static void appendFloat(string &out, F32 value)
+{
+   char buf[32];
+   dSprintf(buf, sizeof(buf), " %.9g", value);
+   out += buf;
+}
+
+
+// Walls with no points never get sent, so they're left out here too
+static string serializeWalls(const Vector<WallRec> &walls)
+{
+   S32 count = 0;
+   for(S32 i = 0; i < walls.size(); i++)
+      if(walls[i].verts.size() > 0)
+         count++;
+
+   string out = itos(count);
+
+   for(S32 i = 0; i < walls.size(); i++)
+   {
+      const WallRec &wall = walls[i];
+
+      if(wall.verts.size() == 0)
+         continue;
+
+      appendFloat(out, wall.width);
+      out += wall.solid ? " 1 " : " 0 ";
+      out += itos(wall.verts.size());
+
+      for(S32 j = 0; j < wall.verts.size(); j++)
+         appendFloat(out, wall.verts[j]);
+   }
+
+   return out;
+}
+
+
+// Returns false if the data is truncated or doesn't make sense
+static bool readWalls(istringstream &in, Vector<WallRec> &walls)
+{
+   S32 count;
+   in >> count;
+
+   if(!in || count < 0)
+      return false;
+
+   for(S32 i = 0; i < count; i++)
+   {
+      F32 width;
+      S32 solid, vertCount;
+      in >> width >> solid >> vertCount;
+
+      if(!in || vertCount <= 0)
+         return false;
+
+      Vector<F32> verts(vertCount);
+      for(S32 j = 0; j < vertCount; j++)
+      {
+         F32 vert;
+         in >> vert;
+         verts.push_back(vert);
+      }
+
+      if(!in)
+         return false;
+
+      walls.push_back(WallRec(width, solid != 0, verts));
+   }
+
+   return true;
+}
+
+
+static bool readEdges(istringstream &in, Vector<Point> &edges)
+{
+   S32 count;
+   in >> count;
+
+   if(!in || count < 0)
+      return false;
+
+   edges.reserve(count);
+
+   for(S32 i = 0; i < count; i++)
+   {
+      F32 x, y;
+      in >> x >> y;
+      edges.push_back(Point(x, y));
+   }
+
+   return !in.fail();
+}
+
+
+////////////////////////////////////////
+////////////////////////////////////////
+
+// Constructor
+LevelGeometryCache::LevelGeometryCache(const string &folder)
+{
+   mFolder = folder;
+}
+
+
+// Destructor
+LevelGeometryCache::~LevelGeometryCache()
+{
+   // Do nothing
+}
+
+
+void LevelGeometryCache::setFolder(const string &folder)
+{
+   mFolder = folder;
+}
+
+
+string LevelGeometryCache::getFilename(const string &hash) const
+{
+   return joindir(mFolder, hash + "." + CacheFileExtension);
+}
+
+
+// A file only gets used if its contents still hash to its name, so a damaged file can't give us the wrong walls.
+// Levels missing from the saved order are treated as the oldest.
+void LevelGeometryCache::loadAll()
+{
+   mLevels.clear();
+
+   if(mFolder == "")
+      return;
+
+   Vector<string> files;
+   string extensions[] = { CacheFileExtension };
+   getFilesFromFolder(mFolder, files, extensions, ARRAYSIZE(extensions));
+
+   Vector<CachedLevel> levels;
+
+   for(S32 i = 0; i < files.size(); i++)
+   {
+      string hash = files[i].substr(0, files[i].length() - strlen(CacheFileExtension) - 1);
+
+      istringstream in(readFile(joindir(mFolder, files[i])));
+
+      CachedLevel level;
+      level.hash = hash;
+
+      if(!readWalls(in, level.walls) || !readEdges(in, level.edges))
+         continue;
+
+      if(getWallsHash(level.walls) != hash)
+         continue;
+
+      levels.push_back(level);
+   }
+
+   Vector<string> order;
+   istringstream orderIn(readFile(joindir(mFolder, OrderFilename)));
+   string hash;
+   while(orderIn >> hash)
+      order.push_back(hash);
+
+   for(S32 i = 0; i < levels.size(); i++)
+      if(!order.contains(levels[i].hash))
+         mLevels.push_back(levels[i]);
+
+   for(S32 i = 0; i < order.size(); i++)
+      for(S32 j = 0; j < levels.size(); j++)
+         if(levels[j].hash == order[i] && !getLevel(order[i]))
+         {
+            mLevels.push_back(levels[j]);
+            break;
+         }
+
+   Vector<string> evictedHashes;
+   while(mLevels.size() > MaxLevels)
+      evictOldest(evictedHashes);
+
+   saveOrder();
+}
+
+
+const LevelGeometryCache::CachedLevel *LevelGeometryCache::getLevel(const string &hash) const
+{
+   for(S32 i = 0; i < mLevels.size(); i++)
+      if(mLevels[i].hash == hash)
+         return &mLevels[i];
+
+   return NULL;
+}
+
+
+// Moves the level to the back of the line for eviction
+void LevelGeometryCache::markUsed(const string &hash)
+{
+   for(S32 i = 0; i < mLevels.size(); i++)
+      if(mLevels[i].hash == hash)
+      {
+         if(i == mLevels.size() - 1)
+            return;
+
+         CachedLevel level = mLevels[i];
+         mLevels.erase(i);
+         mLevels.push_back(level);
+         saveOrder();
+         return;
+      }
+}
+
+
+void LevelGeometryCache::getHashes(Vector<string> &hashes) const
+{
+   hashes.clear();
+
+   for(S32 i = 0; i < mLevels.size(); i++)
+      hashes.push_back(mLevels[i].hash);
+}
+
+
+S32 LevelGeometryCache::getLevelCount() const
+{
+   return mLevels.size();
+}
+
+
+void LevelGeometryCache::evictOldest(Vector<string> &evictedHashes)
+{
+   remove(getFilename(mLevels[0].hash).c_str());
+   evictedHashes.push_back(mLevels[0].hash);
+   mLevels.erase(0);
+}
+
+
+void LevelGeometryCache::saveOrder() const
+{
+   if(mFolder == "")
+      return;
+
+   string contents;
+
+   for(S32 i = 0; i < mLevels.size(); i++)
+      contents += mLevels[i].hash + "\n";
+
+   writeFile(joindir(mFolder, OrderFilename), contents);
+}
+
+
+// Returns true if the level was added, which we won't do if we've already got it.  If we were full, the least
+// recently used level gets dropped to make room, and its hash goes in evictedHashes, so the server can be told.
+bool LevelGeometryCache::addLevel(const string &hash, const Vector<WallRec> &walls, const Vector<Point> &edges,
+                                  Vector<string> &evictedHashes)
+{
+   if(mFolder == "" || getLevel(hash))
+      return false;
+
+   if(getWallsHash(walls) != hash)
+      return false;
+
+   string contents = serializeWalls(walls) + " " + itos(edges.size());
+
+   for(S32 i = 0; i < edges.size(); i++)
+   {
+      appendFloat(contents, edges[i].x);
+      appendFloat(contents, edges[i].y);
+   }
+
+   if(!makeSureFolderExists(mFolder) || !writeFile(getFilename(hash), contents))
+      return false;
+
+   while(mLevels.size() >= MaxLevels)
+      evictOldest(evictedHashes);
+
+   CachedLevel level;
+   level.hash = hash;
+   level.walls = walls;
+   level.edges = edges;
+   mLevels.push_back(level);
+
+   saveOrder();
+
+   return true;
+}
+
+
+// Identifies a set of walls; the server and client each work this out from the walls they have
+string LevelGeometryCache::getWallsHash(const Vector<WallRec> &walls)
+{
+   return Game::md5.getHashFromString(serializeWalls(walls));
+}
+
+
+}
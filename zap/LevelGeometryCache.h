@@ -0,0 +1,71 @@
+//------------------------------------------------------------------------------
+// Copyright Chris Eykamp
+// See LICENSE.txt for full copyright information
+//------------------------------------------------------------------------------
+
+#ifndef _LEVEL_GEOMETRY_CACHE_H_
+#define _LEVEL_GEOMETRY_CACHE_H_
+
+#include "barrier.h"       // For WallRec def
+
+#include "Point.h"
+#include "tnlVector.h"
+
+#include <string>
+
+using namespace TNL;
+using namespace std;
+
+namespace Zap
+{
+
+// Keeps the walls of levels we've played, along with their clipped edges, in files named for the hash of the
+// walls.  The client tells servers which hashes it has, so they can skip sending walls for those levels, and it
+// can skip clipping the edges, which is the slowest part of loading a big level.
+//
+// Everything gets read in up front, so anything we tell a server we have is guaranteed to still be there when
+// the server takes us up on it.  Once we're full, each new level pushes out the one we've gone longest without
+// using, and the client tells the server to forget it.  Levels are kept in that order, and the order is saved
+// alongside the files so it carries over to the next session.
+class LevelGeometryCache
+{
+public:
+   static const S32 MaxLevels = 64;
+
+   struct CachedLevel
+   {
+      string hash;
+      Vector<WallRec> walls;
+      Vector<Point> edges;       // As Barrier::mRenderLineSegments would have them
+   };
+
+private:
+   string mFolder;
+   Vector<CachedLevel> mLevels;        // Least recently used first
+
+   string getFilename(const string &hash) const;
+   void evictOldest(Vector<string> &evictedHashes);
+   void saveOrder() const;
+
+public:
+   explicit LevelGeometryCache(const string &folder = "");
+   virtual ~LevelGeometryCache();
+
+   void setFolder(const string &folder);
+   void loadAll();                        // Reads in every valid level file in our folder
+
+   const CachedLevel *getLevel(const string &hash) const;
+   void markUsed(const string &hash);
+   void getHashes(Vector<string> &hashes) const;
+   S32 getLevelCount() const;
+
+   bool addLevel(const string &hash, const Vector<WallRec> &walls, const Vector<Point> &edges, 
+                 Vector<string> &evictedHashes);
+
+   static string getWallsHash(const Vector<WallRec> &walls);
+};
+
+
+}
+
+#endif
@@ -49,7 +49,7 @@ const S32 LineItem::MAX_LINE_WIDTH = 255;
  */
 LineItem::LineItem(lua_State *L)
 { 
-   mNetFlags.set(Ghostable);
+   mNetFlags.set(Ghostable | SharedUpdates);
    setNewGeometry(geomPolyLine);
    mObjectTypeNumber = LineTypeNumber;
 
@@ -12,6 +12,7 @@
 #include "game.h"
 #include "ServerGame.h"
 #include "GeomUtils.h"
+#include "TickProfiler.h"
 
 #include "GameTypesEnum.h"
 #include "TeamConstants.h"
@@ -70,6 +71,9 @@ LuaScriptRunner::LuaScriptRunner()
    mScriptId = "script" + itos(mNextScriptId++);
    mScriptType = ScriptTypeInvalid;
 
+   mTimerHeldTime = 0;
+   mTimerQuietTime = 0;
+
    LUAW_CONSTRUCTOR_INITIALIZATIONS;
 }
 
@@ -296,6 +300,11 @@ bool LuaScriptRunner::loadScript(bool cacheScript)
 
 bool LuaScriptRunner::runString(const string &code)
 {
+   ProfileScope profileScope(TickProfiler::PhaseLua);
+
+   catchUpTimer();
+   mTimerQuietTime = 0;       // Code may schedule timer events we don't know about
+
    luaL_loadstring(L, code.c_str());
    setEnvironment();
    return !lua_pcall(L, 0, 0, 0);
@@ -336,9 +345,46 @@ bool LuaScriptRunner::runMain(const Vector<string> &args)
 }
 
 
+// Give the script's Timer any time tickTimer() has been holding back.  Nothing will fire, as nothing was due, but any
+// events the script schedules from here on will be timed from the right starting point.  Leaves the stack as it was.
+void LuaScriptRunner::catchUpTimer()
+{
+   if(mTimerHeldTime == 0)
+      return;
+
+   U32 heldTime = mTimerHeldTime;
+   mTimerHeldTime = 0;
+
+   // Not using loadFunction() or logError() here, as they clear the stack
+   lua_getfield(L, LUA_REGISTRYINDEX, getScriptId());        // -- <<args>>, env
+   lua_getfield(L, -1, "_tickTimer");                        // -- <<args>>, env, _tickTimer
+   lua_remove(L, -2);                                        // -- <<args>>, _tickTimer
+
+   if(!lua_isfunction(L, -1))
+   {
+      lua_pop(L, 1);                                         // -- <<args>>
+      return;
+   }
+
+   lua_pushnil(L);                                           // -- <<args>>, _tickTimer, nil     (_tickTimer ignores self)
+   lua_pushnumber(L, heldTime);                              // -- <<args>>, _tickTimer, nil, heldTime
+
+   if(lua_pcall(L, 2, 0, 0))                                 // -- <<args>>, error msg
+   {
+      logprintf(LogConsumer::LogError, "%s Error updating timer: %s", getErrorMessagePrefix(), lua_tostring(L, -1));
+      lua_pop(L, 1);                                         // -- <<args>>
+   }
+}
+
+
 // Returns true if there was an error, false if everything ran ok
 bool LuaScriptRunner::runCmd(const char *function, S32 returnValues)
 {
+   ProfileScope profileScope(TickProfiler::PhaseLua);
+
+   catchUpTimer();
+   mTimerQuietTime = 0;       // Whatever we're about to run might schedule timer events we don't know about
+
    S32 args = lua_gettop(L);  // Number of args on stack     // -- <<args>>
 
    pushStackTracer();                                        // -- <<args>>, _stackTracer
@@ -88,6 +88,12 @@ protected:
 
    bool mSubscriptions[EventManager::EventTypes];  // Keep track of which events we're subscribed to for rapid unsubscription upon death or destruction
 
+   // Scripts only need _tickTimer() called when one of their timers is due, so we hold on to elapsed time until then
+   U32 mTimerHeldTime;           // Time that hasn't been passed to the script's Timer yet
+   U32 mTimerQuietTime;          // How long the Timer has told us it can go without being called
+
+   void catchUpTimer();
+
    // Sub-classes that override this should still call this with Parent::prepareEnvironment()
    virtual bool prepareEnvironment();
 
@@ -163,14 +169,30 @@ public:
    void tickTimer(U32 deltaT)          
    {
       TNLAssert(lua_gettop(L) == 0 || dumpStack(L), "Stack dirty!");
+
+      // Nothing due yet?  Then save a trip into Lua.  Timer events fire once their time has been exceeded.
+      mTimerHeldTime += deltaT;
+      if(mTimerHeldTime <= mTimerQuietTime)
+         return;
+
       clearStack(L);
 
       luaW_push<T>(L, static_cast<T *>(this));           // -- this
-      lua_pushnumber(L, deltaT);                         // -- this, deltaT
+      lua_pushnumber(L, mTimerHeldTime);                 // -- this, deltaT
+
+      mTimerHeldTime = 0;
 
       // Note that we don't care if this generates an error... if it does the error handler will
       // print a nice message, then call killScript().
-      runCmd("_tickTimer", 0);
+      if(!runCmd("_tickTimer", 1))                       // -- time until next event, or nil
+      {
+         if(lua_isnumber(L, -1) && lua_tonumber(L, -1) < U32_MAX)
+            mTimerQuietTime = lua_tonumber(L, -1) > 0 ? U32(lua_tonumber(L, -1)) : 0;
+         else
+            mTimerQuietTime = U32_MAX;                   // Nothing scheduled
+
+         clearStack(L);
+      }
    }
 
 
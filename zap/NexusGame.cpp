@@ -937,7 +937,7 @@ void NexusFlagItem::sendHome()
 NexusZone::NexusZone(lua_State *L)
 {
    mObjectTypeNumber = NexusTypeNumber;
-   mNetFlags.set(Ghostable);
+   mNetFlags.set(Ghostable | SharedUpdates);
    
    if(L)
    {
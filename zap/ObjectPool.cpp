@@ -0,0 +1,155 @@
+//------------------------------------------------------------------------------
+// Copyright Chris Eykamp
+// See LICENSE.txt for full copyright information
+//------------------------------------------------------------------------------
+
+#include "ObjectPool.h"
+
+#include "stringUtils.h"
+
+#include "tnlAssert.h"
+
+#include <new>
+
+
+namespace Zap
+{
+
+ObjectPool *ObjectPool::mFirstPool = NULL;
+
+
+// Constructor
+ObjectPool::ObjectPool(const char *name, size_t blockSize)
+{
+   TNLAssert(blockSize >= sizeof(void *), "Blocks need room for the free list!");
+
+   mName = name;
+   mBlockSize = blockSize;
+   mFreeList = NULL;
+
+   mHeapAllocations = 0;
+   mReuses = 0;
+   mLiveCount = 0;
+
+   mNextPool = mFirstPool;
+   mFirstPool = this;
+}
+
+
+// Destructor -- only pools made for testing ever get here
+ObjectPool::~ObjectPool()
+{
+   TNLAssert(mLiveCount == 0, "Deleting a pool that's still in use!");
+
+   while(mFreeList)
+   {
+      void *next = *(void **)mFreeList;
+      ::operator delete(mFreeList);
+      mFreeList = next;
+   }
+
+   for(ObjectPool **pool = &mFirstPool; *pool; pool = &(*pool)->mNextPool)
+      if(*pool == this)
+      {
+         *pool = mNextPool;
+         break;
+      }
+}
+
+
+void *ObjectPool::allocate(size_t size)
+{
+   if(size != mBlockSize)
+      return ::operator new(size);
+
+   mLiveCount++;
+
+   if(mFreeList)
+   {
+      void *block = mFreeList;
+      mFreeList = *(void **)block;
+      mReuses++;
+
+      return block;
+   }
+
+   mHeapAllocations++;
+   return ::operator new(size);
+}
+
+
+void ObjectPool::release(void *block, size_t size)
+{
+   if(!block)
+      return;
+
+   if(size != mBlockSize)
+   {
+      ::operator delete(block);
+      return;
+   }
+
+   TNLAssert(mLiveCount > 0, "Releasing more than we handed out!");
+   mLiveCount--;
+
+   *(void **)block = mFreeList;
+   mFreeList = block;
+}
+
+
+const char *ObjectPool::getName() const
+{
+   return mName;
+}
+
+
+U32 ObjectPool::getHeapAllocations() const
+{
+   return mHeapAllocations;
+}
+
+
+U32 ObjectPool::getReuses() const
+{
+   return mReuses;
+}
+
+
+U32 ObjectPool::getLiveCount() const
+{
+   return mLiveCount;
+}
+
+
+U32 ObjectPool::getTotalHeapAllocations()
+{
+   U32 total = 0;
+
+   for(ObjectPool *pool = mFirstPool; pool; pool = pool->mNextPool)
+      total += pool->mHeapAllocations;
+
+   return total;
+}
+
+
+U32 ObjectPool::getTotalReuses()
+{
+   U32 total = 0;
+
+   for(ObjectPool *pool = mFirstPool; pool; pool = pool->mNextPool)
+      total += pool->mReuses;
+
+   return total;
+}
+
+
+// Appends one line per pool, e.g. "Projectile: 12 live, 40 from heap, 3172 reused"
+void ObjectPool::getReport(Vector<string> &lines)
+{
+   for(ObjectPool *pool = mFirstPool; pool; pool = pool->mNextPool)
+      lines.push_back(string(pool->mName) + ": " + itos(pool->mLiveCount) + " live, " + 
+                      itos(pool->mHeapAllocations) + " from heap, " + itos(pool->mReuses) + " reused");
+}
+
+
+} /* namespace Zap */
@@ -0,0 +1,82 @@
+//------------------------------------------------------------------------------
+// Copyright Chris Eykamp
+// See LICENSE.txt for full copyright information
+//------------------------------------------------------------------------------
+
+#ifndef _OBJECT_POOL_H_
+#define _OBJECT_POOL_H_
+
+#include "tnlTypes.h"
+#include "tnlVector.h"
+
+#include <string>
+#include <stddef.h>
+
+using namespace TNL;
+using namespace std;
+
+namespace Zap
+{
+
+// Recycles the memory of objects that come and go by the thousand, such as projectiles, so firing doesn't mean a
+// trip to the heap once a level is under way.  Blocks are kept on a free list and never handed back.  Requests for
+// any size other than the pool's go straight to the heap, so subclasses of a pooled class are safe, if not pooled.
+//
+// Pools are only used from the main thread.
+class ObjectPool
+{
+private:
+   const char *mName;
+   size_t mBlockSize;
+   void *mFreeList;           // Blocks ready for reuse; each one holds a pointer to the next
+
+   U32 mHeapAllocations;      // Blocks we've had to get from the heap
+   U32 mReuses;               // Blocks handed out from the free list
+   U32 mLiveCount;            // Blocks currently in use
+
+   ObjectPool *mNextPool;     // All pools are linked, for reporting
+   static ObjectPool *mFirstPool;
+
+public:
+   ObjectPool(const char *name, size_t blockSize);    // Constructor
+   virtual ~ObjectPool();                             // Destructor
+
+   void *allocate(size_t size);
+   void release(void *block, size_t size);
+
+   const char *getName() const;
+   U32 getHeapAllocations() const;
+   U32 getReuses() const;
+   U32 getLiveCount() const;
+
+   static U32 getTotalHeapAllocations();    // Summed over all pools -- steady state combat shouldn't move this much
+   static U32 getTotalReuses();
+   static void getReport(Vector<string> &lines);
+};
+
+
+// Put BF_DECLARE_POOLED_CLASS in a class declaration, and BF_IMPLEMENT_POOLED_CLASS(ClassName) in its .cpp, to have
+// new and delete of that class go through its own pool.  Pools are created on first use and never destroyed, so
+// objects deleted while the program is shutting down don't end up in a pool that's already gone.
+#define BF_DECLARE_POOLED_CLASS                                   \
+   static ObjectPool *getObjectPool();                            \
+   static void *operator new(size_t size);                        \
+   static void operator delete(void *block, size_t size)
+
+#define BF_IMPLEMENT_POOLED_CLASS(className)                      \
+   ObjectPool *className::getObjectPool()                         \
+   {                                                              \
+      static ObjectPool *pool = new ObjectPool(#className, sizeof(className)); \
+      return pool;                                                \
+   }                                                              \
+   void *className::operator new(size_t size)                     \
+   {                                                              \
+      return getObjectPool()->allocate(size);                     \
+   }                                                              \
+   void className::operator delete(void *block, size_t size)      \
+   {                                                              \
+      getObjectPool()->release(block, size);                      \
+   }
+
+} /* namespace Zap */
+#endif
@@ -24,6 +24,10 @@
 #include "GeomUtils.h"
 
 #include "GameRecorder.h"
+#include "TickProfiler.h"
+#include "ObjectPool.h"
+#include "EngineeredItem.h"
+#include "Zone.h"
 
 #include "IniFile.h"
 
@@ -122,6 +126,9 @@ ServerGame::ServerGame(const Address &address, GameSettingsPtr settings, LevelSo
    GameManager::setHostingModePhase(GameManager::NotHosting);
 
    mGameRecorderServer = NULL;
+
+   mTurretTargetList = new TurretTargetList();     // Deleted in destructor
+   mZoneIndex = new ZoneIndex();                   // Deleted in destructor
 }
 
 
@@ -144,6 +151,9 @@ ServerGame::~ServerGame()
 
    if(mGameRecorderServer)
       delete mGameRecorderServer;
+
+   delete mTurretTargetList;
+   delete mZoneIndex;
 }
 
 
@@ -159,6 +169,7 @@ void ServerGame::cleanUp()
       delete dynamic_cast<Object *>(fillVector[i]);
 
    mVoteTimer = 0;
+   mTurretTargetList->clear();
 
    Parent::cleanUp();
 }
@@ -642,6 +653,8 @@ void ServerGame::cycleLevel(S32 nextLevel)
    }
 
    computeWorldObjectExtents();                       // Compute world Extents nice and early
+   getGameObjDatabase()->resizeGrid(mWorldExtents);   // Size our spatial index to suit the level
+   getGameObjDatabase()->buildStaticIndex();          // Walls, zones and such won't move, so index them separately
 
    if(!mGameRecorderServer && !mShuttingDown && getSettings()->getIniSettings()->enableGameRecording)
       mGameRecorderServer = new GameRecorderServer(this);
@@ -686,7 +699,8 @@ void ServerGame::cycleLevel(S32 nextLevel)
 
    mGameType->mBotZoneCreationFailed = !BotNavMeshZone::buildBotMeshZones(mBotZoneDatabase, &mAllZones,
                                                                           getWorldExtents(), barrierList, turretList,
-                                                                          forceFieldProjectorList, teleporterData, triangulate);
+                                                                          forceFieldProjectorList, teleporterData, triangulate,
+                                                                          &mBotZoneCache);
    // Clear team info for all clients
    resetAllClientTeams();
 
@@ -748,6 +762,21 @@ void ServerGame::onConnectedToMaster()
 }
 
 
+// Where our time has gone lately, how many system calls batching has saved us on the network, and how
+// often the short-lived object pools have kept us off the heap
+void ServerGame::getPerformanceReport(Vector<string> &lines)
+{
+   TickProfiler::getReport(lines);
+
+   const Socket::Stats &stats = getNetInterface()->getSocket().getStats();
+
+   lines.push_back("Packets in: " + itos(stats.packetsReceived) + " in " + itos(stats.receiveCalls) + " calls; " +
+                   "out: " + itos(stats.packetsSent) + " in " + itos(stats.sendCalls) + " calls");
+
+   ObjectPool::getReport(lines);
+}
+
+
 void ServerGame::sendLevelStatsToMaster()
 {
    // Send level stats to master, but don't bother in test mode -- don't want to gum things up with a bunch of one-off levels
@@ -1402,6 +1431,8 @@ void ServerGame::idle(U32 timeDelta)
    if(GameManager::getHostingModePhase() == GameManager::LoadingLevels)
       return;
 
+   ProfileScope profileScope(TickProfiler::PhaseServerIdle);
+
    Parent::idle(timeDelta);
 
    processSimulatedStutter(timeDelta);
@@ -1423,7 +1454,11 @@ void ServerGame::idle(U32 timeDelta)
    if(timeDelta > MaxTimeDelta)   // Prevents timeDelta from going too high, usually when after the server was frozen
       timeDelta = 100;
 
-   mNetInterface->checkIncomingPackets();
+   {
+      ProfileScope networkScope(TickProfiler::PhaseNetwork);
+      mNetInterface->checkIncomingPackets();
+   }
+
    checkConnectionToMaster(timeDelta);                   // Connect to master server if not connected
 
    mSettings->getBanList()->updateKickList(timeDelta);   // Unban players who's bans have expired
@@ -1445,6 +1480,11 @@ void ServerGame::idle(U32 timeDelta)
 
    if(mGameSuspended)     // If game is suspended, we need do nothing more
    {
+      ProfileScope networkScope(TickProfiler::PhaseNetwork);
+
+      if(mGameType)
+         mGameType->invalidateTeamVisibility();    // Players may have left, taking their ships with them
+
       mNetInterface->processConnections();
       return;
    }
@@ -1477,9 +1517,9 @@ void ServerGame::idle(U32 timeDelta)
          mLevelGens.deleteAndErase_fast(index);
    }
 
-   // Compute new world extents -- these might change if a ship flies far away, for example...
-   // In practice, we could probably just set it and forget it when we load a level.
-   // Compute it here to save recomputing it for every robot and other method that relies on it.
+   // Update world extents -- these might change if a ship flies far away, for example...
+   // The database keeps track of them as objects move, so this is cheap; grab them here so robots and
+   // other methods that rely on them see a consistent value for the whole tick.
    computeWorldObjectExtents();
 
    U32 botControlTickElapsed = botControlTickTimer.getElapsed();
@@ -1497,27 +1537,33 @@ void ServerGame::idle(U32 timeDelta)
    
    const Vector<DatabaseObject *> *gameObjects = mGameObjDatabase->findObjects_fast();
 
-   // Visit each game object, handling moves and running its idle method
-   for(S32 i = gameObjects->size() - 1; i >= 0; i--)
+   // Object idle time, not counting collisions or Lua, which are charged to phases of their own
    {
-      BfObject *obj = static_cast<BfObject *>((*gameObjects)[i]);
+      ProfileScope objectIdleScope(TickProfiler::PhaseObjectIdle);
+
+      // Visit each game object, handling moves and running its idle method
+      for(S32 i = gameObjects->size() - 1; i >= 0; i--)
+      {
+         BfObject *obj = static_cast<BfObject *>((*gameObjects)[i]);
 
-      if(obj->isDeleted())
-         continue;
+         if(obj->isDeleted())
+            continue;
 
-      // Here is where the time gets set for all the various object moves
-      Move thisMove = obj->getCurrentMove();
-      thisMove.time = timeDelta;
+         // Here is where the time gets set for all the various object moves
+         Move thisMove = obj->getCurrentMove();
+         thisMove.time = timeDelta;
 
-      // Give the object its move, then have it idle
-      obj->setCurrentMove(thisMove);
-      obj->idle(BfObject::ServerIdleMainLoop);
+         // Give the object its move, then have it idle
+         obj->setCurrentMove(thisMove);
+         obj->idle(BfObject::ServerIdleMainLoop);
+      }
    }
 
    if(mGameType)
       mGameType->idle(BfObject::ServerIdleMainLoop, timeDelta);
 
    processDeleteList(timeDelta);
+   mTurretTargetList->clear();      // Might be holding some of what we just deleted
 
    // Load a new level if the time is out on the current one
    if(mLevelSwitchTimer.update(timeDelta))
@@ -1558,11 +1604,16 @@ void ServerGame::idle(U32 timeDelta)
       return;
    }
 
+   // Everything has moved, so teams' shared scoping results need working out again
+   if(mGameType)
+      mGameType->invalidateTeamVisibility();
 
    if(mGameRecorderServer)
       mGameRecorderServer->idle(timeDelta);
 
-   mNetInterface->processConnections(); // Update to other clients right after idling everything else, so clients get more up to date information
+   // Update to other clients right after idling everything else, so clients get more up to date information
+   ProfileScope networkScope(TickProfiler::PhaseNetwork);
+   mNetInterface->processConnections();
 }
 
 
@@ -1965,6 +2016,18 @@ GridDatabase *ServerGame::getBotZoneDatabase() const
 }
 
 
+TurretTargetList *ServerGame::getTurretTargetList()
+{
+   return mTurretTargetList;
+}
+
+
+ZoneIndex *ServerGame::getZoneIndex()
+{
+   return mZoneIndex;
+}
+
+
 const Vector<BotNavMeshZone *> *ServerGame::getBotZones() const
 {
    return &mAllZones;
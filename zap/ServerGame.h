@@ -30,6 +30,8 @@ class ItemSpawn;
 struct LevelInfo;
 
 class GameRecorderServer;
+class TurretTargetList;
+class ZoneIndex;
 
 static const string UploadPrefix = "upload_";
 static const string DownloadPrefix = "download_";
@@ -87,6 +89,9 @@ private:
 
    RobotManager mRobotManager;
 
+   TurretTargetList *mTurretTargetList;      // Shared by all turrets, so they don't each need to search for targets
+   ZoneIndex *mZoneIndex;                    // Shared by everything that moves, so they don't each need to search for zones
+
    Vector<LuaLevelGenerator *> mLevelGens;
    Vector<LuaLevelGenerator *> mLevelGenDeleteList;
 
@@ -119,6 +124,7 @@ private:
 
    GridDatabase *mBotZoneDatabase;
    Vector<BotNavMeshZone *> mAllZones;
+   BotZoneCache mBotZoneCache;            // Zones from recently played levels, so we needn't build them again
    
 public:
    ServerGame(const Address &address, GameSettingsPtr settings, LevelSourcePtr levelSource, bool testMode, bool dedicated, bool hostOnServer = false);    // Constructor
@@ -181,6 +187,7 @@ public:
    void makeEmptyLevelIfNoGameType();
    void cycleLevel(S32 newLevelIndex = NEXT_LEVEL);
    void sendLevelStatsToMaster();
+   void getPerformanceReport(Vector<string> &lines);
 
    void onConnectedToMaster();
 
@@ -259,6 +266,8 @@ public:
    void queueVoiceChatBuffer(const SFXHandle &effect, const ByteBufferPtr &p) const;
 
    LuaGameInfo *getGameInfo();
+   TurretTargetList *getTurretTargetList();
+   ZoneIndex *getZoneIndex();
 
    /////
    // BotNavMeshZone management
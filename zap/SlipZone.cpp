@@ -22,7 +22,7 @@ using namespace LuaArgs;
 SlipZone::SlipZone(lua_State *L)
 {
    setTeam(0);
-   mNetFlags.set(Ghostable);
+   mNetFlags.set(Ghostable | SharedUpdates);
    mObjectTypeNumber = SlipZoneTypeNumber;
    slipAmount = 0.1f;
 
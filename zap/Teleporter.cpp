@@ -180,7 +180,7 @@ Teleporter::~Teleporter()
 void Teleporter::initialize(const Point &pos, const Point &dest, Ship *engineeringShip)
 {
    mObjectTypeNumber = TeleporterTypeNumber;
-   mNetFlags.set(Ghostable);
+   mNetFlags.set(Ghostable | SharedUpdates);
 
    mTime = 0;
    mTeleporterCooldown = TeleporterCooldown;    // Teleporters can have non-standard cooldown periods, but start with default
@@ -0,0 +1,360 @@
+//------------------------------------------------------------------------------
+// Copyright Chris Eykamp
+// See LICENSE.txt for full copyright information
+//------------------------------------------------------------------------------
+
+#include "TickProfiler.h"
+
+#include "stringUtils.h"
+
+#include "tnlAssert.h"
+#include "tnlPlatform.h"
+
+#include <math.h>
+
+
+namespace Zap
+{
+
+TickProfiler::TimerFunc TickProfiler::mTimer = Platform::getHighPrecisionTimerValue;
+bool TickProfiler::mEnabled = true;
+bool TickProfiler::mRecording = false;
+
+TickProfiler::Phase TickProfiler::mStack[MaxDepth];
+S32 TickProfiler::mDepth = 0;
+S64 TickProfiler::mLastSwitchTime = 0;
+S64 TickProfiler::mTickStartTime = 0;
+
+S64 TickProfiler::mTickExclusive[PhaseCount];
+S64 TickProfiler::mTickInclusive[PhaseCount];
+S64 TickProfiler::mOpenedTime[PhaseCount];
+S32 TickProfiler::mOpenCount[PhaseCount];
+S64 TickProfiler::mPhaseTime[PhaseCount];
+
+TickProfiler::Slice TickProfiler::mSlices[WindowSlices];
+S32 TickProfiler::mCurrentSlice = 0;
+U32 TickProfiler::mSliceStartTime = 0;
+
+
+// Bucket i holds times from 2^(i/2) up to 2^((i+1)/2) microseconds; the first also takes anything shorter
+static F64 getBucketLowerBound(S32 bucket)
+{
+   return bucket == 0 ? 0 : pow(2.0, bucket * 0.5) / 1000;
+}
+
+
+static F64 getBucketUpperBound(S32 bucket)
+{
+   return pow(2.0, (bucket + 1) * 0.5) / 1000;
+}
+
+
+void TickProfiler::Histogram::clear()
+{
+   for(S32 i = 0; i < BucketCount; i++)
+      counts[i] = 0;
+
+   samples = 0;
+   totalMs = 0;
+   maxMs = 0;
+}
+
+
+void TickProfiler::Histogram::add(F64 ms)
+{
+   S32 bucket = 0;
+
+   if(ms * 1000 >= 1)
+      bucket = S32(2 * log(ms * 1000) / log(2.0));
+
+   if(bucket >= BucketCount)
+      bucket = BucketCount - 1;
+
+   counts[bucket]++;
+   samples++;
+   totalMs += ms;
+
+   if(ms > maxMs)
+      maxMs = ms;
+}
+
+
+void TickProfiler::Histogram::addHistogram(const Histogram &other)
+{
+   for(S32 i = 0; i < BucketCount; i++)
+      counts[i] += other.counts[i];
+
+   samples += other.samples;
+   totalMs += other.totalMs;
+
+   if(other.maxMs > maxMs)
+      maxMs = other.maxMs;
+}
+
+
+// Finds the bucket the percentile falls in, and assumes samples are spread evenly across it
+F64 TickProfiler::Histogram::getPercentile(F64 percentile) const
+{
+   if(samples == 0)
+      return 0;
+
+   F64 target = percentile * samples;
+   U32 seen = 0;
+
+   for(S32 i = 0; i < BucketCount; i++)
+   {
+      if(counts[i] == 0 || seen + counts[i] < target)
+      {
+         seen += counts[i];
+         continue;
+      }
+
+      F64 lower = getBucketLowerBound(i);
+      F64 upper = getBucketUpperBound(i);
+      F64 ms = lower + (upper - lower) * (target - seen) / counts[i];
+
+      return ms < maxMs ? ms : maxMs;
+   }
+
+   return maxMs;
+}
+
+
+void TickProfiler::Slice::clear()
+{
+   tickTime.clear();
+
+   for(S32 i = 0; i < PhaseCount; i++)
+   {
+      inclusive[i].clear();
+      exclusiveMs[i] = 0;
+   }
+}
+
+
+////////////////////////////////////////
+////////////////////////////////////////
+
+void TickProfiler::setTimer(TimerFunc timer)
+{
+   TNLAssert(!mRecording, "Can't change clocks in the middle of a tick!");
+
+   mTimer = timer ? timer : Platform::getHighPrecisionTimerValue;
+}
+
+
+void TickProfiler::setEnabled(bool enabled)
+{
+   mEnabled = enabled;
+}
+
+
+bool TickProfiler::isEnabled()
+{
+   return mEnabled;
+}
+
+
+bool TickProfiler::isRecording()
+{
+   return mRecording;
+}
+
+
+void TickProfiler::beginTick()
+{
+   TNLAssert(!mRecording, "Already in a tick!");
+
+   mRecording = mEnabled;
+
+   if(!mRecording)
+      return;
+
+   for(S32 i = 0; i < PhaseCount; i++)
+   {
+      mTickExclusive[i] = 0;
+      mTickInclusive[i] = 0;
+      mOpenCount[i] = 0;
+   }
+
+   mDepth = 0;
+   mTickStartTime = mTimer();
+   mLastSwitchTime = mTickStartTime;
+}
+
+
+void TickProfiler::endTick(bool keep)
+{
+   if(!mRecording)
+      return;
+
+   TNLAssert(mDepth == 0, "ProfileScope still open at end of tick!");
+
+   mRecording = false;
+
+   S64 now = mTimer();
+
+   for(S32 i = 0; i < PhaseCount; i++)
+      mPhaseTime[i] += mTickExclusive[i];
+
+   if(!keep)
+      return;
+
+   advanceWindow(Platform::getRealMilliseconds());
+
+   Slice &slice = mSlices[mCurrentSlice];
+
+   slice.tickTime.add(Platform::getHighPrecisionMilliseconds(now - mTickStartTime));
+
+   for(S32 i = 0; i < PhaseCount; i++)
+   {
+      slice.inclusive[i].add(Platform::getHighPrecisionMilliseconds(mTickInclusive[i]));
+      slice.exclusiveMs[i] += Platform::getHighPrecisionMilliseconds(mTickExclusive[i]);
+   }
+}
+
+
+// Start a fresh slice every SliceLength, dropping the oldest; a long quiet spell clears out the whole window
+void TickProfiler::advanceWindow(U32 now)
+{
+   if(mSliceStartTime == 0)
+      mSliceStartTime = now;
+
+   U32 slicesToAdvance = (now - mSliceStartTime) / SliceLength;
+
+   if(slicesToAdvance > U32(WindowSlices))
+      slicesToAdvance = WindowSlices;
+
+   for(U32 i = 0; i < slicesToAdvance; i++)
+   {
+      mCurrentSlice = (mCurrentSlice + 1) % WindowSlices;
+      mSlices[mCurrentSlice].clear();
+   }
+
+   if(slicesToAdvance > 0)
+      mSliceStartTime = now - (now - mSliceStartTime) % SliceLength;
+}
+
+
+void TickProfiler::chargeCurrentPhase(S64 now)
+{
+   if(mDepth > 0 && mDepth <= MaxDepth)
+      mTickExclusive[mStack[mDepth - 1]] += now - mLastSwitchTime;
+
+   mLastSwitchTime = now;
+}
+
+
+void TickProfiler::push(Phase phase)
+{
+   S64 now = mTimer();
+
+   chargeCurrentPhase(now);
+
+   if(mDepth < MaxDepth)
+      mStack[mDepth] = phase;
+
+   mDepth++;
+
+   if(mOpenCount[phase]++ == 0)
+      mOpenedTime[phase] = now;
+}
+
+
+void TickProfiler::pop(Phase phase)
+{
+   TNLAssert(mDepth > 0, "Unbalanced ProfileScopes!");
+
+   S64 now = mTimer();
+
+   chargeCurrentPhase(now);
+   mDepth--;
+
+   if(--mOpenCount[phase] == 0)
+      mTickInclusive[phase] += now - mOpenedTime[phase];
+}
+
+
+void TickProfiler::reset()
+{
+   for(S32 i = 0; i < PhaseCount; i++)
+      mPhaseTime[i] = 0;
+
+   for(S32 i = 0; i < WindowSlices; i++)
+      mSlices[i].clear();
+
+   mCurrentSlice = 0;
+   mSliceStartTime = 0;
+}
+
+
+F64 TickProfiler::getPhaseMs(Phase phase)
+{
+   return Platform::getHighPrecisionMilliseconds(mPhaseTime[phase]);
+}
+
+
+const char *TickProfiler::getPhaseName(Phase phase)
+{
+   static const char *names[] = { "server idle", "object idle", "collisions", "robot ticks", "events", "Lua",
+                                  "network", "scoping", "packet writing" };
+
+   TNLAssert(ARRAYSIZE(names) == PhaseCount, "Phase names out of sync!");
+
+   return names[phase];
+}
+
+
+static string formatMs(F64 ms)
+{
+   return ftos(F32(ms), 3) + "ms";
+}
+
+
+// One line for ticks as a whole, then one per phase, covering the rolling window
+void TickProfiler::getReport(Vector<string> &lines)
+{
+   Histogram tickTime;
+   Histogram inclusive[PhaseCount];
+   F64 exclusiveMs[PhaseCount];
+
+   tickTime.clear();
+   for(S32 i = 0; i < PhaseCount; i++)
+   {
+      inclusive[i].clear();
+      exclusiveMs[i] = 0;
+   }
+
+   for(S32 i = 0; i < WindowSlices; i++)
+   {
+      tickTime.addHistogram(mSlices[i].tickTime);
+
+      for(S32 j = 0; j < PhaseCount; j++)
+      {
+         inclusive[j].addHistogram(mSlices[i].inclusive[j]);
+         exclusiveMs[j] += mSlices[i].exclusiveMs[j];
+      }
+   }
+
+   if(tickTime.samples == 0)
+   {
+      lines.push_back("No ticks recorded");
+      return;
+   }
+
+   lines.push_back(itos(tickTime.samples) + " ticks: p50 " + formatMs(tickTime.getPercentile(0.5)) +
+                   ", p99 " + formatMs(tickTime.getPercentile(0.99)) + ", max " + formatMs(tickTime.maxMs));
+
+   // Own time per tick and share of all tick time, then percentiles of per-tick time including nested phases
+   for(S32 i = 0; i < PhaseCount; i++)
+   {
+      F64 share = tickTime.totalMs > 0 ? 100 * exclusiveMs[i] / tickTime.totalMs : 0;
+
+      lines.push_back(string(getPhaseName(Phase(i))) + ": " + formatMs(exclusiveMs[i] / tickTime.samples) + "/tick (" +
+                      ftos(F32(share), 1) + "%), incl. p50 " + formatMs(inclusive[i].getPercentile(0.5)) +
+                      ", p99 " + formatMs(inclusive[i].getPercentile(0.99)) + ", max " + formatMs(inclusive[i].maxMs));
+   }
+}
+
+
+} /* namespace Zap */
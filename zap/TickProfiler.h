@@ -0,0 +1,141 @@
+//------------------------------------------------------------------------------
+// Copyright Chris Eykamp
+// See LICENSE.txt for full copyright information
+//------------------------------------------------------------------------------
+
+#ifndef _TICK_PROFILER_H_
+#define _TICK_PROFILER_H_
+
+#include "tnlTypes.h"
+#include "tnlVector.h"
+
+#include <string>
+
+using namespace TNL;
+using namespace std;
+
+namespace Zap
+{
+
+// Splits the server's time between the main things it does each tick.  Code we want to measure opens a ProfileScope
+// for its phase.  Scopes can nest; each phase's exclusive time is what's left after taking out any scopes nested
+// inside it, so exclusive times add up to the tick, while its inclusive time covers everything it set off.
+//
+// Only time between beginTick() and endTick() is counted, so a client game running in the same process doesn't
+// muddy the numbers.  Per-tick results go into histograms covering the last minute or so, which is what getReport()
+// describes.  Costs two timer reads per scope, so it's cheap enough to leave on all the time.  Main thread only.
+class TickProfiler
+{
+public:
+   enum Phase {
+      PhaseServerIdle,        // Anything in ServerGame::idle() not covered by the phases below
+      PhaseObjectIdle,
+      PhaseCollisions,
+      PhaseRobots,            // onTick handlers, which are mostly robots
+      PhaseEvents,            // All other Lua events
+      PhaseLua,               // Running Lua code, whoever asked for it
+      PhaseNetwork,           // Reading and sending packets, not counting scoping or packet writing
+      PhaseScoping,
+      PhasePacketWriting,
+      PhaseCount
+   };
+
+   typedef S64 (*TimerFunc)();               // Returns high precision timer units
+
+private:
+   static const S32 MaxDepth = 32;
+   static const S32 BucketCount = 40;              // Half-octave buckets, from under 1us to over a second
+   static const S32 WindowSlices = 6;
+   static const U32 SliceLength = 10 * 1000;       // So the rolling window covers the last 50-60 seconds
+
+   struct Histogram
+   {
+      U32 counts[BucketCount];
+      U32 samples;
+      F64 totalMs;
+      F64 maxMs;
+
+      void clear();
+      void add(F64 ms);
+      void addHistogram(const Histogram &other);
+      F64 getPercentile(F64 percentile) const;
+   };
+
+   struct Slice
+   {
+      Histogram tickTime;
+      Histogram inclusive[PhaseCount];
+      F64 exclusiveMs[PhaseCount];
+
+      void clear();
+   };
+
+   static TimerFunc mTimer;
+   static bool mEnabled;
+   static bool mRecording;                   // True between beginTick() and endTick(), if enabled
+
+   static Phase mStack[MaxDepth];
+   static S32 mDepth;                        // Can exceed MaxDepth, in which case the deepest scopes go uncounted
+   static S64 mLastSwitchTime;               // When the innermost scope last started or resumed
+   static S64 mTickStartTime;
+
+   // All in high precision timer units
+   static S64 mTickExclusive[PhaseCount];
+   static S64 mTickInclusive[PhaseCount];
+   static S64 mOpenedTime[PhaseCount];       // When the outermost scope for each phase opened...
+   static S32 mOpenCount[PhaseCount];        // ...and how many are open, so recursion isn't counted twice
+   static S64 mPhaseTime[PhaseCount];        // Exclusive time since last reset()
+
+   static Slice mSlices[WindowSlices];
+   static S32 mCurrentSlice;
+   static U32 mSliceStartTime;
+
+   static void chargeCurrentPhase(S64 now);
+   static void advanceWindow(U32 now);
+
+public:
+   static void setTimer(TimerFunc timer);    // For tests that need to control the clock; NULL restores the real one
+   static void setEnabled(bool enabled);
+   static bool isEnabled();
+   static bool isRecording();
+
+   static void beginTick();
+   static void endTick(bool keep);           // Pass false to leave this tick out of the histograms (e.g. nothing was running)
+
+   static void push(Phase phase);
+   static void pop(Phase phase);
+
+   static void reset();                      // Zero the totals and clear the histograms
+   static F64 getPhaseMs(Phase phase);       // Total exclusive time charged to phase since last reset
+   static const char *getPhaseName(Phase phase);
+
+   static void getReport(Vector<string> &lines);
+};
+
+
+// Charges the time until it goes out of scope to phase
+class ProfileScope
+{
+private:
+   TickProfiler::Phase mPhase;
+   bool mActive;     // Profiler could start or stop recording while we're open
+
+public:
+   explicit ProfileScope(TickProfiler::Phase phase)
+   {
+      mPhase = phase;
+      mActive = TickProfiler::isRecording();
+
+      if(mActive)
+         TickProfiler::push(phase);
+   }
+
+   ~ProfileScope()
+   {
+      if(mActive)
+         TickProfiler::pop(mPhase);
+   }
+};
+
+} /* namespace Zap */
+#endif
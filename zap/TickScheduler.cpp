@@ -0,0 +1,172 @@
+//------------------------------------------------------------------------------
+// Copyright Chris Eykamp
+// See LICENSE.txt for full copyright information
+//------------------------------------------------------------------------------
+
+#include "TickScheduler.h"
+
+#include "Intervals.h"
+#include "stringUtils.h"
+
+#include "tnlAssert.h"
+
+#include <math.h>
+
+
+namespace Zap
+{
+
+
+TickScheduler::TickScheduler(U32 ticksPerSecond)
+{
+   mMaxCatchUpTicks = DefaultMaxCatchUpTicks;
+   mTickPeriod = 0;
+
+   setTickRate(ticksPerSecond);
+}
+
+
+TickScheduler::~TickScheduler()
+{
+   // Do nothing
+}
+
+
+// Changing the rate restarts the schedule on the next call to getTicksDue()
+void TickScheduler::setTickRate(U32 ticksPerSecond)
+{
+   mTickPeriod = ticksPerSecond > 0 ? F64(ONE_SECOND) / F64(ticksPerSecond) : 0;
+
+   mNextTickTime = 0;
+   mTickRemainder = 0;
+   mStarted = false;
+
+   mTicksRun = 0;
+   mTicksDropped = 0;
+   mTotalLateness = 0;
+   mMaxLateness = 0;
+   mLastReportTime = 0;
+}
+
+
+void TickScheduler::setMaxCatchUpTicks(U32 maxTicks)
+{
+   TNLAssert(maxTicks > 0, "Need to be able to run at least one tick!");
+   mMaxCatchUpTicks = maxTicks;
+}
+
+
+F64 TickScheduler::getTickPeriod() const
+{
+   return mTickPeriod;
+}
+
+
+S32 TickScheduler::getTicksDue(F64 currentTime)
+{
+   if(mTickPeriod <= 0)
+      return 0;
+
+   if(!mStarted)
+   {
+      mNextTickTime = currentTime;
+      mLastReportTime = currentTime;
+      mStarted = true;
+   }
+
+   U32 ticks = 0;
+
+   while(currentTime >= mNextTickTime && ticks < mMaxCatchUpTicks)
+   {
+      F64 lateness = currentTime - mNextTickTime;
+
+      mTotalLateness += lateness;
+      if(lateness > mMaxLateness)
+         mMaxLateness = lateness;
+
+      mNextTickTime += mTickPeriod;
+      ticks++;
+   }
+
+   // Still behind after running as many ticks as we're willing to?  Then the time is lost -- skip over the
+   // missed deadlines (keeping the original phase) rather than spiralling into ever longer catch-up bursts.
+   if(currentTime >= mNextTickTime)
+   {
+      U32 skipped = U32(floor((currentTime - mNextTickTime) / mTickPeriod)) + 1;
+      mNextTickTime += skipped * mTickPeriod;
+      mTicksDropped += skipped;
+   }
+
+   mTicksRun += ticks;
+
+   return S32(ticks);
+}
+
+
+U32 TickScheduler::getTickLength()
+{
+   mTickRemainder += mTickPeriod;
+
+   U32 length = U32(mTickRemainder);
+   mTickRemainder -= length;
+
+   return length;
+}
+
+
+F64 TickScheduler::getTimeUntilNextTick(F64 currentTime) const
+{
+   if(!mStarted || currentTime >= mNextTickTime)
+      return 0;
+
+   return mNextTickTime - currentTime;
+}
+
+
+bool TickScheduler::isReportDue(F64 currentTime) const
+{
+   return mStarted && currentTime - mLastReportTime >= ONE_MINUTE;
+}
+
+
+string TickScheduler::getJitterReport(F64 currentTime)
+{
+   string report = "Tick scheduler: " + itos(mTicksRun) + " ticks at " + ftos(F32(mTickPeriod), 3) + "ms, " +
+                   "lateness avg " + ftos(F32(getAverageLateness()), 3) + "ms, max " + ftos(F32(mMaxLateness), 3) + "ms, " +
+                   itos(mTicksDropped) + " dropped";
+
+   mTicksRun = 0;
+   mTicksDropped = 0;
+   mTotalLateness = 0;
+   mMaxLateness = 0;
+   mLastReportTime = currentTime;
+
+   return report;
+}
+
+
+U32 TickScheduler::getTicksRun() const
+{
+   return mTicksRun;
+}
+
+
+U32 TickScheduler::getTicksDropped() const
+{
+   return mTicksDropped;
+}
+
+
+F64 TickScheduler::getAverageLateness() const
+{
+   return mTicksRun > 0 ? mTotalLateness / mTicksRun : 0;
+}
+
+
+F64 TickScheduler::getMaxLateness() const
+{
+   return mMaxLateness;
+}
+
+
+} /* namespace Zap */
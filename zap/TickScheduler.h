@@ -0,0 +1,66 @@
+//------------------------------------------------------------------------------
+// Copyright Chris Eykamp
+// See LICENSE.txt for full copyright information
+//------------------------------------------------------------------------------
+
+#ifndef _TICK_SCHEDULER_H_
+#define _TICK_SCHEDULER_H_
+
+#include "tnlTypes.h"
+
+#include <string>
+
+using namespace TNL;
+using namespace std;
+
+namespace Zap
+{
+
+// Drives the dedicated server at a fixed simulation rate.  All times passed in are in (fractional)
+// milliseconds from a monotonic clock; the scheduler itself never reads the clock, which keeps it testable.
+class TickScheduler
+{
+private:
+   F64 mTickPeriod;           // Length of one tick, in ms
+   F64 mNextTickTime;         // Deadline of the next tick
+   F64 mTickRemainder;        // Fractional ms not yet handed out by getTickLength()
+   U32 mMaxCatchUpTicks;      // Most ticks we'll run back-to-back before giving up on lost time
+   bool mStarted;
+
+   // Jitter stats, reset every time a report is generated
+   U32 mTicksRun;
+   U32 mTicksDropped;
+   F64 mTotalLateness;
+   F64 mMaxLateness;
+   F64 mLastReportTime;
+
+public:
+   static const U32 DefaultMaxCatchUpTicks = 5;
+
+   explicit TickScheduler(U32 ticksPerSecond = 0);  // Constructor
+   virtual ~TickScheduler();                       // Destructor
+
+   void setTickRate(U32 ticksPerSecond);
+   void setMaxCatchUpTicks(U32 maxTicks);
+   F64 getTickPeriod() const;
+
+   // Number of ticks that should be run now; each one needs a call to getTickLength()
+   S32 getTicksDue(F64 currentTime);
+
+   // Length, in whole ms, of the next tick to run.  Fractions are carried over so the lengths add up to the real rate.
+   U32 getTickLength();
+
+   // How long we can sleep before the next tick is due; 0 if one is due already
+   F64 getTimeUntilNextTick(F64 currentTime) const;
+
+   bool isReportDue(F64 currentTime) const;
+   string getJitterReport(F64 currentTime);     // Also resets the stats
+
+   U32 getTicksRun() const;
+   U32 getTicksDropped() const;
+   F64 getAverageLateness() const;
+   F64 getMaxLateness() const;
+};
+
+} /* namespace Zap */
+#endif
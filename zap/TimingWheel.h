@@ -0,0 +1,186 @@
+//------------------------------------------------------------------------------
+// Copyright Chris Eykamp
+// See LICENSE.txt for full copyright information
+//------------------------------------------------------------------------------
+
+#ifndef _TIMING_WHEEL_H_
+#define _TIMING_WHEEL_H_
+
+#include "tnlTypes.h"
+#include "tnlVector.h"
+#include "tnlAssert.h"
+
+using namespace TNL;
+
+namespace Zap
+{
+
+// Holds items until their delay has passed, for things like the delete list, where lots of items are waiting but
+// only a few come due on any tick.  Items live in a hierarchy of wheels of 256 slots each: the first wheel has a slot
+// for each of the next 256ms, the second one for each of the 256 blocks of 256ms after that, and so on.  Items get
+// moved down a wheel each time their block comes around, so the cost of advance() depends on the number of items
+// coming due, not the number waiting.
+//
+// An item scheduled with delay d comes out of the first advance() that takes the total elapsed time past d, which is
+// the same rule as counting down a timer and checking timeDelta > remaining.
+template <class T>
+class TimingWheel
+{
+private:
+   static const U32 SlotBits = 8;
+   static const U32 SlotsPerWheel = 1 << SlotBits;
+   static const U32 SlotMask = SlotsPerWheel - 1;
+   static const U32 WheelCount = 4;                    // Enough to cover all of a U32 worth of ms
+
+   struct Entry
+   {
+      U32 deadline;
+      T item;
+   };
+
+   Vector<Entry> mSlots[WheelCount][SlotsPerWheel];
+   U32 mCurrentTime;
+   S32 mCount;
+
+   void insert(const Entry &entry);
+   void cascade(U32 wheel);
+
+public:
+   static const U32 MaxDelay = 0x7FFFFFFF;
+
+   TimingWheel();    // Constructor
+
+   void schedule(const T &item, U32 delay);
+
+   // Moves the clock forward, and appends anything that has come due to expired, in order of deadline
+   void advance(U32 timeDelta, Vector<T> &expired);
+
+   // Appends everything still waiting to items, and empties the wheel
+   void removeAll(Vector<T> &items);
+
+   S32 getCount() const;
+};
+
+
+template <class T>
+TimingWheel<T>::TimingWheel()
+{
+   mCurrentTime = 0;
+   mCount = 0;
+}
+
+
+template <class T>
+void TimingWheel<T>::schedule(const T &item, U32 delay)
+{
+   if(delay > MaxDelay)
+      delay = MaxDelay;
+
+   Entry entry;
+   entry.deadline = mCurrentTime + delay + 1;
+   entry.item = item;
+
+   insert(entry);
+   mCount++;
+}
+
+
+// Items go in the lowest wheel whose range reaches their deadline
+template <class T>
+void TimingWheel<T>::insert(const Entry &entry)
+{
+   U32 timeLeft = entry.deadline - mCurrentTime;
+
+   U32 wheel = 0;
+   while(wheel < WheelCount - 1 && timeLeft >= (1u << (SlotBits * (wheel + 1))))
+      wheel++;
+
+   mSlots[wheel][(entry.deadline >> (SlotBits * wheel)) & SlotMask].push_back(entry);
+}
+
+
+// Our clock has just entered a new block on this wheel; spread its items over the wheels below
+template <class T>
+void TimingWheel<T>::cascade(U32 wheel)
+{
+   Vector<Entry> &slot = mSlots[wheel][(mCurrentTime >> (SlotBits * wheel)) & SlotMask];
+
+   for(S32 i = 0; i < slot.size(); i++)
+      insert(slot[i]);
+
+   slot.clear();
+}
+
+
+template <class T>
+void TimingWheel<T>::advance(U32 timeDelta, Vector<T> &expired)
+{
+   // Nothing to do but keep the time
+   if(mCount == 0)
+   {
+      mCurrentTime += timeDelta;
+      return;
+   }
+
+   for(U32 i = 0; i < timeDelta; i++)
+   {
+      mCurrentTime++;
+
+      // Higher wheels first, so their items can end up in the lower wheels' slots being cascaded right after
+      if((mCurrentTime & SlotMask) == 0)
+      {
+         for(U32 wheel = WheelCount - 1; wheel > 0; wheel--)
+            if((mCurrentTime & ((1u << (SlotBits * wheel)) - 1)) == 0)
+               cascade(wheel);
+      }
+
+      Vector<Entry> &slot = mSlots[0][mCurrentTime & SlotMask];
+
+      if(slot.size() == 0)
+         continue;
+
+      for(S32 j = 0; j < slot.size(); j++)
+      {
+         TNLAssert(slot[j].deadline == mCurrentTime, "Item is in the wrong slot!");
+         expired.push_back(slot[j].item);
+      }
+
+      mCount -= slot.size();
+      slot.clear();
+
+      if(mCount == 0)
+      {
+         mCurrentTime += timeDelta - i - 1;
+         return;
+      }
+   }
+}
+
+
+template <class T>
+void TimingWheel<T>::removeAll(Vector<T> &items)
+{
+   for(U32 wheel = 0; wheel < WheelCount; wheel++)
+      for(U32 i = 0; i < SlotsPerWheel; i++)
+      {
+         Vector<Entry> &slot = mSlots[wheel][i];
+
+         for(S32 j = 0; j < slot.size(); j++)
+            items.push_back(slot[j].item);
+
+         slot.clear();
+      }
+
+   mCount = 0;
+}
+
+
+template <class T>
+S32 TimingWheel<T>::getCount() const
+{
+   return mCount;
+}
+
+
+} /* namespace Zap */
+#endif
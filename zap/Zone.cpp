@@ -11,6 +11,8 @@
 
 #include "gameObjectRender.h"
 
+#include <math.h>
+
 namespace Zap
 {
 
@@ -51,6 +53,16 @@ Zone *Zone::clone() const
 }
 
 
+// Let the ZoneIndex know it needs rebuilding
+void Zone::onGeomChanged()
+{
+   Parent::onGeomChanged();
+
+   if(getDatabase())
+      getDatabase()->onTypeGeomChanged(getObjectTypeNumber());
+}
+
+
 void Zone::render()
 {
    // Do nothing -- zones aren't rendered in-game
@@ -236,6 +248,274 @@ void GameZone::unpackUpdate(GhostConnection *connection, BitStream *stream)
 }
 
 
-};
+////////////////////////////////////////
+////////////////////////////////////////
+
+// Constructor
+ZoneIndex::ZoneIndex()
+{
+   mDatabase = NULL;
+   mGeneration = 0;
+   mCellShift = MinCellShift;
+   mCellsWide = 0;
+}
+
+
+static const Vector<U8> &getZoneTypes()
+{
+   static Vector<U8> zoneTypes;
+
+   if(zoneTypes.size() == 0)
+      getTypeNumbers(isZoneType, zoneTypes);
+
+   return zoneTypes;
+}
+
+
+bool ZoneIndex::isCurrent(const GridDatabase *database) const
+{
+   if(database != mDatabase || mChangeCounts.size() == 0)
+      return false;
+
+   const Vector<U8> &zoneTypes = getZoneTypes();
+
+   for(S32 i = 0; i < zoneTypes.size(); i++)
+      if(database->getTypeChangeCount(zoneTypes[i]) != mChangeCounts[i])
+         return false;
+
+   return true;
+}
+
+
+U32 ZoneIndex::refresh(const GridDatabase *database)
+{
+   if(!isCurrent(database))
+      rebuild(database);
+
+   return mGeneration;
+}
+
+
+// True if every point of rect is inside the polygon
+static bool polygonCoversRect(const Vector<Point> &poly, const Rect &rect)
+{
+   if(!polygonContainsPoint(poly.address(), poly.size(), rect.getCenter()))
+      return false;
+
+   // Center is inside, so unless the outline passes through the rect, all the rest of it is too
+   for(S32 i = 0; i < poly.size(); i++)
+      if(rect.intersects(poly[i], poly[i == poly.size() - 1 ? 0 : i + 1]))
+         return false;
+
+   return true;
+}
+
+
+void ZoneIndex::rebuild(const GridDatabase *database)
+{
+   mDatabase = database;
+   mGeneration++;
+
+   const Vector<U8> &zoneTypes = getZoneTypes();
+
+   mChangeCounts.resize(zoneTypes.size());
+   mCellStarts.clear();
+   mCellZones.clear();
+   mTriangles.clear();
+   mCellTriangles.clear();
+
+   Vector<Zone *> zones;
+   Rect bounds;
+
+   for(S32 i = 0; i < zoneTypes.size(); i++)
+   {
+      mChangeCounts[i] = database->getTypeChangeCount(zoneTypes[i]);
+
+      const Vector<DatabaseObject *> *objects = database->findObjects_fast(zoneTypes[i]);
+
+      for(S32 j = 0; j < objects->size(); j++)
+      {
+         Zone *zone = static_cast<Zone *>(objects->get(j));
+
+         if(zone->isDeleted() || zone->getCollisionPoly()->size() < 3)
+            continue;
+
+         if(zones.size() == 0)
+            bounds.set(zone->getExtent());
+         else
+            bounds.unionRect(zone->getExtent());
+
+         zones.push_back(zone);
+      }
+   }
+
+   if(zones.size() == 0)
+   {
+      mCellsWide = 0;
+      return;
+   }
+
+   // Pick the smallest cells that won't take an unreasonable amount of memory
+   mCellShift = MinCellShift;
+
+   while(true)
+   {
+      mCells.set(S32(floor(bounds.min.x)) >> mCellShift, S32(floor(bounds.min.y)) >> mCellShift,
+                 S32(floor(bounds.max.x)) >> mCellShift, S32(floor(bounds.max.y)) >> mCellShift);
+
+      mCellsWide = mCells.maxx - mCells.minx + 1;
+
+      if(S64(mCellsWide) * S64(mCells.maxy - mCells.miny + 1) <= MaxCells)
+         break;
+
+      mCellShift++;
+   }
+
+   S32 cellCount = mCellsWide * (mCells.maxy - mCells.miny + 1);
+   F32 cellSize = F32(1 << mCellShift);
+
+   // Work out what each zone has in each cell it reaches, then sort the results by cell
+   Vector<CellZone> found;
+   Vector<S32> foundCells;
+   Vector<Point> triangles;
 
+   for(S32 i = 0; i < zones.size(); i++)
+   {
+      const Vector<Point> &outline = *zones[i]->getCollisionPoly();
+
+      // Triangulating it ourselves means we'll notice if it fails, as it can with self-intersecting outlines
+      bool triangulated = Triangulate::Process(outline, triangles);
+      S32 firstPoint = mTriangles.size();
+
+      if(triangulated)
+         for(S32 j = 0; j < triangles.size(); j++)
+            mTriangles.push_back(triangles[j]);
+
+      const Rect &extent = zones[i]->getExtent();
+      S32 minx = S32(floor(extent.min.x)) >> mCellShift;
+      S32 miny = S32(floor(extent.min.y)) >> mCellShift;
+      S32 maxx = S32(floor(extent.max.x)) >> mCellShift;
+      S32 maxy = S32(floor(extent.max.y)) >> mCellShift;
+
+      for(S32 y = miny; y <= maxy; y++)
+         for(S32 x = minx; x <= maxx; x++)
+         {
+            Rect cellRect(x * cellSize, y * cellSize, (x + 1) * cellSize, (y + 1) * cellSize);
+
+            CellZone cellZone;
+            cellZone.zone = zones[i];
+            cellZone.firstTriangle = mCellTriangles.size();
+            cellZone.lastTriangle = mCellTriangles.size();
+            cellZone.coversCell = false;
+            cellZone.useOutline = !triangulated;
+
+            if(triangulated)
+            {
+               if(polygonCoversRect(outline, cellRect))
+                  cellZone.coversCell = true;
+               else
+               {
+                  for(S32 j = firstPoint; j < mTriangles.size(); j += 3)
+                  {
+                     Rect triangleRect(mTriangles[j], mTriangles[j + 1]);
+                     triangleRect.unionPoint(mTriangles[j + 2]);
+
+                     if(triangleRect.intersectsOrBorders(cellRect))
+                        mCellTriangles.push_back(j);
+                  }
+
+                  cellZone.lastTriangle = mCellTriangles.size();
+
+                  if(cellZone.firstTriangle == cellZone.lastTriangle)    // Zone's extent reaches here, but not the zone itself
+                     continue;
+               }
+            }
+
+            found.push_back(cellZone);
+            foundCells.push_back((y - mCells.miny) * mCellsWide + (x - mCells.minx));
+         }
+   }
+
+   mCellStarts.resize(cellCount + 1);
+
+   for(S32 i = 0; i < mCellStarts.size(); i++)
+      mCellStarts[i] = 0;
+
+   for(S32 i = 0; i < foundCells.size(); i++)
+      mCellStarts[foundCells[i] + 1]++;
+
+   for(S32 i = 1; i < mCellStarts.size(); i++)
+      mCellStarts[i] += mCellStarts[i - 1];
+
+   // Each cell lists its zones in the order we found them
+   mCellZones.resize(found.size());
+
+   Vector<S32> fillPos(mCellStarts);
+
+   for(S32 i = 0; i < found.size(); i++)
+      mCellZones[fillPos[foundCells[i]]++] = found[i];
+}
+
+
+S32 ZoneIndex::getCell(const Point &pos) const
+{
+   if(mCellsWide == 0)
+      return -1;
 
+   S32 x = S32(floor(pos.x)) >> mCellShift;
+   S32 y = S32(floor(pos.y)) >> mCellShift;
+
+   if(x < mCells.minx || x > mCells.maxx || y < mCells.miny || y > mCells.maxy)
+      return -1;
+
+   S32 cell = (y - mCells.miny) * mCellsWide + (x - mCells.minx);
+
+   return mCellStarts[cell] == mCellStarts[cell + 1] ? -1 : cell;
+}
+
+
+// Works with triangles wound either way; points on the edges count as inside
+static bool triangleContainsPoint(const Point *triangle, const Point &point)
+{
+   F32 d1 = (triangle[1].x - triangle[0].x) * (point.y - triangle[0].y) - (triangle[1].y - triangle[0].y) * (point.x - triangle[0].x);
+   F32 d2 = (triangle[2].x - triangle[1].x) * (point.y - triangle[1].y) - (triangle[2].y - triangle[1].y) * (point.x - triangle[1].x);
+   F32 d3 = (triangle[0].x - triangle[2].x) * (point.y - triangle[2].y) - (triangle[0].y - triangle[2].y) * (point.x - triangle[2].x);
+
+   bool hasNegative = d1 < 0 || d2 < 0 || d3 < 0;
+   bool hasPositive = d1 > 0 || d2 > 0 || d3 > 0;
+
+   return !(hasNegative && hasPositive);
+}
+
+
+void ZoneIndex::findZones(S32 cell, const Point &pos, Vector<SafePtr<Zone> > &zoneList) const
+{
+   if(cell < 0)
+      return;
+
+   for(S32 i = mCellStarts[cell]; i < mCellStarts[cell + 1]; i++)
+   {
+      const CellZone &cellZone = mCellZones[i];
+
+      // Zones marked for deletion stay in the database for a bit, but objects shouldn't be in them any more
+      if(cellZone.zone->isDeleted())
+         continue;
+
+      bool inside = cellZone.coversCell;
+
+      if(!inside && cellZone.useOutline)
+      {
+         const Vector<Point> *outline = cellZone.zone->getCollisionPoly();
+         inside = polygonContainsPoint(outline->address(), outline->size(), pos);
+      }
+
+      for(S32 j = cellZone.firstTriangle; !inside && j < cellZone.lastTriangle; j++)
+         inside = triangleContainsPoint(&mTriangles[mCellTriangles[j]], pos);
+
+      if(inside)
+         zoneList.push_back(SafePtr<Zone>(cellZone.zone));
+   }
+}
+
+
+};
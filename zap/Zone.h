@@ -27,6 +27,7 @@ public:
 
    virtual const Vector<Point> *getCollisionPoly() const;     // More precise boundary for precise collision detection
    virtual bool collide(BfObject *hitObject);
+   virtual void onGeomChanged();
 
    /////
    // Editor methods
@@ -76,6 +77,59 @@ public:
 };
 
 
+////////////////////////////////////////
+////////////////////////////////////////
+
+// Tells moving objects which zones they're in without searching the database.  Zones hardly ever move, so we keep them
+// on a grid of our own, and for each cell remember just the triangles of each zone that reach into it, or that the zone
+// covers the whole cell.  Rebuilt whenever a zone is added, removed or reshaped.  The ServerGame owns one.
+class ZoneIndex
+{
+private:
+   // One zone that reaches into a cell
+   struct CellZone
+   {
+      Zone *zone;
+      S32 firstTriangle;      // Triangles overlapping the cell are listed in mCellTriangles[firstTriangle] up to lastTriangle
+      S32 lastTriangle;
+      bool coversCell;        // No need to look at the triangles, every point in the cell is inside the zone
+      bool useOutline;        // Zone couldn't be triangulated, so test against its outline
+   };
+
+   const GridDatabase *mDatabase;
+   Vector<U32> mChangeCounts;       // Database's type change counts for each zone type when we were built
+   U32 mGeneration;                 // Goes up every time we rebuild
+
+   S32 mCellShift;
+   IntRect mCells;                  // Range of cells we cover; there are no zones outside of it
+   S32 mCellsWide;
+   Vector<S32> mCellStarts;         // Zones reaching into cell i are mCellZones[mCellStarts[i]] up to mCellStarts[i + 1]
+   Vector<CellZone> mCellZones;
+   Vector<Point> mTriangles;        // Every zone's triangles, 3 points each
+   Vector<S32> mCellTriangles;      // Indices of the first point of triangles in mTriangles, see CellZone
+
+   bool isCurrent(const GridDatabase *database) const;
+   void rebuild(const GridDatabase *database);
+
+public:
+   enum {
+      MinCellShift = 6,       // 64 pixel cells, unless that would make too many
+      MaxCells = 1 << 16,
+   };
+
+   ZoneIndex();      // Constructor
+
+   // Rebuilds if the zones in database have changed; returns our generation, so callers can tell whether their
+   // own results are still good
+   U32 refresh(const GridDatabase *database);
+
+   S32 getCell(const Point &pos) const;      // Returns -1 if no zones reach pos
+
+   // Append zones containing pos to zoneList; cell must be getCell(pos)
+   void findZones(S32 cell, const Point &pos, Vector<SafePtr<Zone> > &zoneList) const;
+};
+
+
 };
 
 
@@ -0,0 +1,37 @@
+#
+# Headless server benchmark, built from the same sources as the dedicated server
+# 
+add_executable(bitfighter_bench
+	EXCLUDE_FROM_ALL
+	${SHARED_SOURCES}
+	${EXTRA_SOURCES}
+	${CMAKE_SOURCE_DIR}/bitfighter_bench/main_bench.cpp
+	${CMAKE_SOURCE_DIR}/bitfighter_bench/GridBench.cpp
+)
+
+add_dependencies(bitfighter_bench
+	tnl
+	${LUA_LIB}
+	tomcrypt
+	clipper
+	poly2tri
+)
+
+target_link_libraries(bitfighter_bench
+	${SHARED_LIBS}
+)
+
+set_target_properties(bitfighter_bench
+	PROPERTIES
+	RUNTIME_OUTPUT_DIRECTORY ${CMAKE_SOURCE_DIR}/exe
+)
+
+get_property(BENCH_DEFS TARGET bitfighter_bench PROPERTY COMPILE_DEFINITIONS)
+set_target_properties(bitfighter_bench
+	PROPERTIES
+	COMPILE_DEFINITIONS "${BENCH_DEFS};ZAP_DEDICATED"
+)
+
+set_target_properties(bitfighter_bench PROPERTIES COMPILE_DEFINITIONS_DEBUG "TNL_DEBUG")
+
+BF_PLATFORM_SET_TARGET_PROPERTIES(bitfighter_bench)
@@ -92,6 +92,8 @@ IniSettings::IniSettings()
    allowGetMap = false;               // Disabled by default -- many admins won't want this
 
    maxDedicatedFPS = 100;             // Max FPS on dedicated server
+   fixedTickRate = 0;                 // Dedicated server runs freely by default
+   tickProfileDumpInterval = 0;       // Only on request
    maxFPS = 100;                      // Max FPS on client/non-dedicated server
 
    masterAddress = MASTER_SERVER_LIST_ADDRESS;   // Default address of our master server
@@ -661,6 +663,14 @@ static void loadHostConfiguration(CIniFile *ini, IniSettings *iniSettings)
       iniSettings->maxDedicatedFPS = fps; 
    // TODO: else warn?
 
+   S32 tickRate = ini->GetValueI(section, "FixedTickRate", iniSettings->fixedTickRate);
+   if(tickRate >= 0 && tickRate <= 1000)
+      iniSettings->fixedTickRate = tickRate;
+
+   S32 dumpInterval = ini->GetValueI(section, "TickProfileDumpInterval", iniSettings->tickProfileDumpInterval);
+   if(dumpInterval >= 0 && dumpInterval <= 24 * 60 * 60)
+      iniSettings->tickProfileDumpInterval = dumpInterval;
+
    iniSettings->logStats = ini->GetValueYN(section, "LogStats", iniSettings->logStats);
 
    //iniSettings->SendStatsToMaster = (lcase(ini->GetValue(section, "SendStatsToMaster", "yes")) != "no");
@@ -1791,6 +1801,10 @@ static void writeHost(CIniFile *ini, IniSettings *iniSettings)
       addComment(" KickIdlePlayers - If true, the server will kick players that are considered idle.");
       addComment(" AlertsVolume - Volume of audio alerts when players join or leave game from 0 (mute) to 10 (full bore).");
       addComment(" MaxFPS - Maximum FPS the dedicaetd server will run at.  Higher values use more CPU, lower may increase lag (default = 100).");
+      addComment(" FixedTickRate - If non-zero, the dedicated server simulates at exactly this many ticks per second, sleeping between");
+      addComment("                 ticks instead of polling.  MaxFPS is ignored when this is set (default = 0, i.e. off).");
+      addComment(" TickProfileDumpInterval - If non-zero, every this many seconds the server appends a summary of where its time went");
+      addComment("                           to tickprofile.log in the log folder (default = 0, i.e. never).");
       addComment(" RandomLevels - When current level ends, this can enable randomly switching to any available levels.");
       addComment(" SkipUploads - When current level ends, enables skipping all uploaded levels.");
       addComment(" AllowGetMap - When getmap is allowed, anyone can download the current level using the /getmap command.");
@@ -1827,6 +1841,8 @@ static void writeHost(CIniFile *ini, IniSettings *iniSettings)
    ini->setValueYN(section, "AllowGetMap", iniSettings->allowGetMap);
    ini->setValueYN(section, "AllowDataConnections", iniSettings->allowDataConnections);
    ini->SetValueI (section, "MaxFPS", iniSettings->maxDedicatedFPS);
+   ini->SetValueI (section, "FixedTickRate", iniSettings->fixedTickRate);
+   ini->SetValueI (section, "TickProfileDumpInterval", iniSettings->tickProfileDumpInterval);
    ini->setValueYN(section, "LogStats", iniSettings->logStats);
 
    ini->setValueYN(section, "RandomLevels", S32(iniSettings->randomLevels) );
@@ -2044,7 +2060,8 @@ FolderManager::FolderManager()
 // Constructor
 FolderManager::FolderManager(const string &levelDir,    const string &robotDir,  const string &sfxDir,        const string &musicDir, 
                              const string &iniDir,      const string &logDir,    const string &screenshotDir, const string &luaDir,
-                             const string &rootDataDir, const string &pluginDir, const string &fontsDir,      const string &recordDir) :
+                             const string &rootDataDir, const string &pluginDir, const string &fontsDir,      const string &recordDir,
+                             const string &cacheDir) :
                levelDir      (levelDir),
                robotDir      (robotDir),
                sfxDir        (sfxDir),
@@ -2056,7 +2073,8 @@ FolderManager::FolderManager(const string &levelDir,    const string &robotDir,
                rootDataDir   (rootDataDir),
                pluginDir     (pluginDir),
                fontsDir      (fontsDir),
-               recordDir     (recordDir)
+               recordDir     (recordDir),
+               cacheDir      (cacheDir)
 {
    // Do nothing (more)
 }
@@ -2104,6 +2122,7 @@ void FolderManager::resolveDirs(GameSettings *settings)
    folderManager->screenshotDir = resolutionHelper(cmdLineDirs.screenshotDir, rootDataDir, "screenshots");
    folderManager->musicDir      = resolutionHelper(cmdLineDirs.musicDir,      rootDataDir, "music");
    folderManager->recordDir     = resolutionHelper(cmdLineDirs.recordDir,     rootDataDir, "record");
+   folderManager->cacheDir      = resolutionHelper(cmdLineDirs.cacheDir,      rootDataDir, "cache");
 
    // rootDataDir not used for these folders
    folderManager->sfxDir        = resolutionHelper(cmdLineDirs.sfxDir,        "", "sfx");
@@ -2126,6 +2145,7 @@ void FolderManager::resolveDirs(const string &root)
    screenshotDir = joindir(root, "screenshots");
    musicDir      = joindir(root, "music");
    recordDir     = joindir(root, "record");
+   cacheDir      = joindir(root, "cache");
 
    // root not used for these folders
    sfxDir        = joindir("", "sfx");
@@ -47,7 +47,8 @@ struct FolderManager
 
    FolderManager(const string &levelDir,    const string &robotDir,  const string &sfxDir,        const string &musicDir, 
                  const string &iniDir,      const string &logDir,    const string &screenshotDir, const string &luaDir,
-                 const string &rootDataDir, const string &pluginDir, const string &fontsDir,      const string &recordDir);
+                 const string &rootDataDir, const string &pluginDir, const string &fontsDir,      const string &recordDir,
+                 const string &cacheDir);
 
    string levelDir;
    string robotDir;
@@ -61,6 +62,7 @@ struct FolderManager
    string pluginDir;
    string fontsDir;
    string recordDir;
+   string cacheDir;
 
    void resolveDirs(GameSettings *settings);                                  
    void resolveDirs(const string &root);
@@ -199,6 +201,8 @@ public:
    bool allowDataConnections;       // Specify whether data connections are allowed on this computer
 
    U32 maxDedicatedFPS;
+   U32 fixedTickRate;               // Dedicated server ticks per second; 0 means run freely, capped by maxDedicatedFPS
+   U32 tickProfileDumpInterval;     // Seconds between writing the server's tick profile to the log folder; 0 for never
    U32 maxFPS;
 
 
@@ -8,6 +8,7 @@
 #include "game.h"
 
 #include "ship.h"
+#include "TickProfiler.h"
 
 #include <math.h>
 
@@ -32,6 +33,7 @@ ControlObjectConnection::ControlObjectConnection()
    mIsBusy = false;
    mBusyTime = 0;
    mNeedReplayMoves = false;
+   mHasPriorityFocus = false;
 }
 
 
@@ -129,6 +131,8 @@ static U8 CLIENTCONTROLBITS = 16;
 
 void ControlObjectConnection::writePacket(BitStream *bstream, PacketNotify *notify)
 {
+   ProfileScope profileScope(TickProfiler::PhasePacketWriting);
+
    if(isConnectionToServer())
    {
       S8 firstSendIndex = highSendIndex[0];
@@ -168,10 +172,14 @@ void ControlObjectConnection::writePacket(BitStream *bstream, PacketNotify *noti
    else     // We're on the server, sending packet to client.  I think...
    {
       S32 ghostIndex = -1;
+      mHasPriorityFocus = controlObject.isValid();
+
       if(controlObject.isValid())
       {
          ghostIndex = getGhostIndex(controlObject);
          mServerPosition = controlObject->getPos();
+         mPriorityFocusCenter = controlObject->getExtent().getCenter();
+         mPriorityFocusVel = controlObject->getVel();
       }
 
       // We only compress points relative if we know that the
@@ -360,6 +368,24 @@ bool ControlObjectConnection::getObjectMovedThisGame()
 }
 
 
+bool ControlObjectConnection::hasPriorityFocus() const
+{
+   return mHasPriorityFocus;
+}
+
+
+const Point &ControlObjectConnection::getPriorityFocusCenter() const
+{
+   return mPriorityFocusCenter;
+}
+
+
+const Point &ControlObjectConnection::getPriorityFocusVel() const
+{
+   return mPriorityFocusVel;
+}
+
+
 void ControlObjectConnection::writeCompressedPoint(const Point &p, BitStream *stream)
 {
    if(!mCompressPointsRelative)
@@ -65,6 +65,12 @@ private:
 
    U32 mBusyTime;          // How long have we been busy (see mIsBusy)
 
+   // Where the control object was when we started writing the current packet, so that
+   // BfObject::getUpdatePriority() doesn't have to look it up for every ghost
+   bool mHasPriorityFocus;
+   Point mPriorityFocusCenter;
+   Point mPriorityFocusVel;
+
    void onGotNewMove(const Move &move);
 
 protected:
@@ -100,6 +106,10 @@ public:
 
    bool isDataToTransmit();
 
+   bool hasPriorityFocus() const;
+   const Point &getPriorityFocusCenter() const;
+   const Point &getPriorityFocusVel() const;
+
    void writeCompressedPoint(const Point &p, BitStream *stream);
    void readCompressedPoint(Point &p, BitStream *stream);
 
@@ -82,6 +82,7 @@ Game::Game(const Address &theBindAddress, GameSettingsPtr settings) : mGameObjDa
    mReadyToConnectToMaster = false;
 
    mCurrentTime = 0;
+   mTickCount = 0;
    mGameSuspended = false;
 
    mRobotCount = 0;
@@ -123,6 +124,12 @@ U32 Game::getCurrentTime()
 }
 
 
+U32 Game::getTickCount() const
+{
+   return mTickCount;
+}
+
+
 const Vector<SafePtr<BfObject> > &Game::getScopeAlwaysList()
 {
    return mScopeAlwaysList;
@@ -1107,37 +1114,32 @@ void Game::processAnonymousMasterConnection()
 // Called by both ClientGame::idle and ServerGame::idle
 void Game::idle(U32 timeDelta)
 {
+   mTickCount++;
    mSecondaryThread->idle();
 }
 
 
-Game::DeleteRef::DeleteRef(BfObject *o, U32 d)
-{
-   theObject = o;
-   delay = d;
-}
-
-
 void Game::addToDeleteList(BfObject *theObject, U32 delay)
 {
    TNLAssert(!theObject->isGhost(), "Can't delete ghosting Object");
-   mPendingDeleteObjects.push_back(DeleteRef(theObject, delay));
+   mPendingDeleteObjects.schedule(theObject, delay);
 }
 
 
-// Cycle through our pending delete list, and either delete an object or update its timer
+// Delete any objects on our pending delete list whose time has come; pass U32_MAX to delete them all
 void Game::processDeleteList(U32 timeDelta)
 {
-   for(S32 i = 0; i < mPendingDeleteObjects.size(); i++) 
-      if(timeDelta > mPendingDeleteObjects[i].delay)
-      {
-         BfObject *g = mPendingDeleteObjects[i].theObject;
-         delete g;
-         mPendingDeleteObjects.erase_fast(i);
-         i--;
-      }
-      else
-         mPendingDeleteObjects[i].delay -= timeDelta;
+   mExpiredDeleteObjects.clear();
+
+   if(timeDelta == U32_MAX)
+      mPendingDeleteObjects.removeAll(mExpiredDeleteObjects);
+   else
+      mPendingDeleteObjects.advance(timeDelta, mExpiredDeleteObjects);
+
+   for(S32 i = 0; i < mExpiredDeleteObjects.size(); i++)
+      delete mExpiredDeleteObjects[i].getPointer();
+
+   mExpiredDeleteObjects.clear();
 }
 
 
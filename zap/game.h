@@ -18,6 +18,7 @@
 #include "md5wrapper.h"
 
 #include "Timer.h"
+#include "TimingWheel.h"
 #include "Rect.h"
 
 #include "tnlNetObject.h"
@@ -210,19 +211,13 @@ protected:
 
    virtual void cleanUp();
    
-   struct DeleteRef
-   {
-      SafePtr<BfObject> theObject;
-      U32 delay;
-
-      DeleteRef(BfObject *o = NULL, U32 d = 0);
-   };
-
    shared_ptr<GridDatabase> mGameObjDatabase;                // Database for all normal objects
 
-   Vector<DeleteRef> mPendingDeleteObjects;
+   TimingWheel<SafePtr<BfObject> > mPendingDeleteObjects;
+   Vector<SafePtr<BfObject> > mExpiredDeleteObjects;        // Scratch list for processDeleteList()
    Vector<SafePtr<BfObject> > mScopeAlwaysList;
    U32 mCurrentTime;
+   U32 mTickCount;                                          // Bumped every idle, even ones that take no time
 
    U32 mLevelDatabaseId;
 
@@ -372,6 +367,7 @@ public:
    F32 getLegacyGridSize() const;
 
    U32 getCurrentTime();
+   U32 getTickCount() const;
    virtual bool isServer() const = 0;        // Implemented by ClientGame (returns false) and ServerGame (returns true)
 
    void checkConnectionToMaster(U32 timeDelta);
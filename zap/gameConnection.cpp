@@ -14,6 +14,7 @@
 #include "gameNetInterface.h"
 #include "gameType.h"
 #include "LevelSource.h"
+#include "LevelGeometryCache.h"
 
 #include "SoundSystemEnums.h"
 #include "GameRecorder.h"
@@ -1053,6 +1054,40 @@ TNL_IMPLEMENT_RPC(GameConnection, c2sReleaseCommanderMap, (), (),
 }
 
 
+bool GameConnection::hasCachedLevel(const string &wallsHash) const
+{
+   return mCachedLevelHashes.contains(wallsHash);
+}
+
+
+// Client tells us which levels' walls it has cached; sent on connect, and again whenever it caches another level
+TNL_IMPLEMENT_RPC(GameConnection, c2sAddCachedLevels, (Vector<StringPtr> wallsHashes), (wallsHashes),
+   NetClassGroupGameMask, RPCGuaranteedOrdered, RPCDirClientToServer, 0)
+{
+   for(S32 i = 0; i < wallsHashes.size() && mCachedLevelHashes.size() < LevelGeometryCache::MaxLevels; i++)
+   {
+      string hash = wallsHashes[i].getString();
+
+      if(hash.length() == 32 && !mCachedLevelHashes.contains(hash))    // 32 == length of an md5 hex string
+         mCachedLevelHashes.push_back(hash);
+   }
+}
+
+
+// Client's cache was full, so it dropped these levels to make room for the one it just added
+TNL_IMPLEMENT_RPC(GameConnection, c2sRemoveCachedLevels, (Vector<StringPtr> wallsHashes), (wallsHashes),
+   NetClassGroupGameMask, RPCGuaranteedOrdered, RPCDirClientToServer, 0)
+{
+   for(S32 i = 0; i < wallsHashes.size(); i++)
+   {
+      S32 index = mCachedLevelHashes.getIndex(wallsHashes[i].getString());
+
+      if(index != -1)
+         mCachedLevelHashes.erase_fast(index);
+   }
+}
+
+
 // 18 bits == 262144, enough for -100000 to 100000  (Ship::EnergyMax is 100000)
 // This way we can credit negative energy as well
 TNL_IMPLEMENT_RPC(GameConnection, s2cCreditEnergy, (SignedInt<18> energy), (energy), NetClassGroupGameMask, RPCGuaranteed, RPCDirServerToClient, 0)
@@ -1384,6 +1419,26 @@ TNL_IMPLEMENT_RPC(GameConnection, c2sShowNextLevel, (), (), NetClassGroupGameMas
 }
 
 
+// Admin wants to know where the server's time has been going
+TNL_IMPLEMENT_RPC(GameConnection, c2sRequestTickProfile, (), (), NetClassGroupGameMask, RPCGuaranteed, RPCDirClientToServer, 0)
+{
+   if(!mClientInfo->isAdmin())
+   {
+      s2cDisplayErrorMessage("!!! Need admin permission");
+      return;
+   }
+
+   Vector<string> lines;
+   mServerGame->getPerformanceReport(lines);
+
+   Vector<StringTableEntry> message;
+   for(S32 i = 0; i < lines.size(); i++)
+      message.push_back(lines[i].c_str());
+
+   s2cDisplayMessageBox("Server Tick Profile", "Press [[Esc]] to continue", message);
+}
+
+
 TNL_IMPLEMENT_RPC(GameConnection, c2sRequestShutdown, (U16 time, StringPtr reason), (time, reason), 
                   NetClassGroupGameMask, RPCGuaranteedOrdered, RPCDirClientToServer, 0)
 {
@@ -2397,6 +2452,19 @@ void GameConnection::onConnectionEstablished_client()
 
    if(mSettings->getIniSettings()->voiceChatVolLevel == 0)
       s2rVoiceChatEnable(false);
+
+   // Let the server know which levels it won't need to send us walls for
+   Vector<string> hashes;
+   mClientGame->getCachedLevelHashes(hashes);
+
+   if(hashes.size() > 0)
+   {
+      Vector<StringPtr> hashPtrs(hashes.size());
+      for(S32 i = 0; i < hashes.size(); i++)
+         hashPtrs.push_back(hashes[i].c_str());
+
+      c2sAddCachedLevels(hashPtrs);
+   }
 #endif
 }
 
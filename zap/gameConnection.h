@@ -69,6 +69,8 @@ private:
    bool mWantsScoreboardUpdates;    // Indicates if client has requested scoreboard streaming (e.g. pressing Tab key)
    bool mReadyForRegularGhosts;
 
+   Vector<string> mCachedLevelHashes;     // Levels whose walls the client already has, so we needn't send them
+
    StringTableEntry mClientNameNonUnique; // For authentication, not unique name
 
    Timer mAuthenticationTimer;
@@ -240,6 +242,10 @@ public:
    TNL_DECLARE_RPC(c2sRequestCommanderMap, ());
    TNL_DECLARE_RPC(c2sReleaseCommanderMap, ());
 
+   bool hasCachedLevel(const string &wallsHash) const;
+   TNL_DECLARE_RPC(c2sAddCachedLevels, (Vector<StringPtr> wallsHashes));
+   TNL_DECLARE_RPC(c2sRemoveCachedLevels, (Vector<StringPtr> wallsHashes));
+
    TNL_DECLARE_RPC(s2cCreditEnergy, (SignedInt<18> energy));
    TNL_DECLARE_RPC(s2cSetFastRechargeTime, (U32 time));
 
@@ -265,6 +271,7 @@ public:
 
    TNL_DECLARE_RPC(c2sRequestLevelChange, (S32 newLevelIndex, bool isRelative));
    TNL_DECLARE_RPC(c2sShowNextLevel, ());
+   TNL_DECLARE_RPC(c2sRequestTickProfile, ());
    TNL_DECLARE_RPC(c2sRequestShutdown, (U16 time, StringPtr reason));
    TNL_DECLARE_RPC(c2sRequestCancelShutdown, ());
    TNL_DECLARE_RPC(s2cInitiateShutdown, (U16 time, StringTableEntry name, StringPtr reason, bool originator));
@@ -21,6 +21,7 @@
 #include "game.h"
 #include "GameRecorder.h"
 #include "Teleporter.h"
+#include "TickProfiler.h"
 
 #ifndef ZAP_DEDICATED
 #  include "gameObjectRender.h"
@@ -33,6 +34,7 @@
 #include "Colors.h"
 
 #include "stringUtils.h"
+#include "LevelGeometryCache.h"
 
 #include "tnlThread.h"
 #include <math.h>
@@ -97,6 +99,15 @@ GameType::GameType(S32 winningScore) : mScoreboardUpdateTimer(THREE_SECONDS), mG
 
    mObjectsExpected = 0;
    mGame = NULL;
+
+   mVisibilityGeneration = 1;
+}
+
+
+GameType::TeamVisibility::TeamVisibility()
+{
+   cmdrMapGeneration = 0;
+   spyBugGeneration = 0;
 }
 
 
@@ -1122,6 +1133,7 @@ bool GameType::isTeamGame() const
 void GameType::addWall(const WallRec &wall, Game *game)
 {
    mWalls.push_back(wall);       // Add wall to our list of walls
+   mWallsHash = "";
    wall.constructWalls(game);    // Build it!
 }
 
@@ -1257,17 +1269,14 @@ Vector<AbstractSpawn *> GameType::getSpawnPoints(TypeNumber typeNumber, S32 team
 
    Vector<AbstractSpawn *> spawnPoints;
 
-   const Vector<DatabaseObject *> *objects = getGame()->getGameObjDatabase()->findObjects_fast();
+   const Vector<DatabaseObject *> *objects = getGame()->getGameObjDatabase()->findObjects_fast(typeNumber);
 
    for(S32 i = 0; i < objects->size(); i++)
    {
-      if(objects->get(i)->getObjectTypeNumber() == typeNumber)
-      {
-         AbstractSpawn *spawn = static_cast<AbstractSpawn *>(objects->get(i));
+      AbstractSpawn *spawn = static_cast<AbstractSpawn *>(objects->get(i));
 
-         if(!checkTeam || spawn->getTeam() == teamIndex || spawn->getTeam() == TEAM_NEUTRAL)
-            spawnPoints.push_back(spawn);
-      }
+      if(!checkTeam || spawn->getTeam() == teamIndex || spawn->getTeam() == TEAM_NEUTRAL)
+         spawnPoints.push_back(spawn);
    }
 
    return spawnPoints;
@@ -1331,9 +1340,22 @@ static void markAllMountedItemsAsBeingInScope(Ship *ship, GameConnection *conn)
 }
 
 
+static void markAllObjectsAsBeingInScope(const Vector<DatabaseObject *> &objects, GameConnection *conn)
+{
+   for(S32 i = 0; i < objects.size(); i++)
+   {
+      conn->objectInScope(static_cast<BfObject *>(objects[i]));
+      if(isShipType(objects[i]->getObjectTypeNumber()))
+         markAllMountedItemsAsBeingInScope(static_cast<Ship *>(objects[i]), conn);
+   }
+}
+
+
 // Runs only on server, I think
 void GameType::performScopeQuery(GhostConnection *connection)
 {
+   ProfileScope profileScope(TickProfiler::PhaseScoping);
+
    GameConnection *conn = (GameConnection *) connection;
    ClientInfo *clientInfo = conn->getClientInfo();
    BfObject *co = conn->getControlObject();
@@ -1362,42 +1384,152 @@ void GameType::performScopeQuery(GhostConnection *connection)
       conn->objectInScope(co);            // Put controlObject in scope ==> This is where the update mask gets set to 0xFFFFFFFF
    }
 
-   // What does the spy bug see?
+   // What do the spy bugs see?  In team games, everyone sees what their team's bugs see...
+   if(isTeamGame())
+   {
+      markAllObjectsAsBeingInScope(getSpyBugObjects(clientInfo->getTeamIndex()), conn);
+      return;
+   }
+
+   // ...otherwise everyone sees what neutral bugs see, but only the owner sees what the rest see
+   markAllObjectsAsBeingInScope(getSpyBugObjects(TEAM_NEUTRAL), conn);
+
+   const Vector<DatabaseObject *> *spyBugs = mGame->getGameObjDatabase()->findObjects_fast(SpyBugTypeNumber);
+   Vector<SpyBug *> ownSpyBugs;
+
+   for(S32 i = 0; i < spyBugs->size(); i++)
+   {
+      SpyBug *spyBug = static_cast<SpyBug *>(spyBugs->get(i));
+
+      if(spyBug->getTeam() != TEAM_NEUTRAL && spyBug->isVisibleToPlayer(clientInfo, false))
+         ownSpyBugs.push_back(spyBug);
+   }
+
+   if(ownSpyBugs.size() > 0)
+   {
+      Vector<DatabaseObject *> seen;
+      findObjectsSeenBySpyBugs(ownSpyBugs, seen);
+      markAllObjectsAsBeingInScope(seen, conn);
+   }
+}
+
+
+// Server only -- call before connections write packets, after anything has moved or been deleted
+void GameType::invalidateTeamVisibility()
+{
+   mVisibilityGeneration++;
+}
+
+
+GameType::TeamVisibility &GameType::getTeamVisibility(S32 teamIndex)
+{
+   S32 slot = teamIndex - NO_TEAM;     // So the special teams get slots too
+   TNLAssert(slot >= 0, "Unexpected team index!");
+
+   if(slot >= mTeamVisibility.size())
+      mTeamVisibility.resize(slot + 1);
+
+   return mTeamVisibility[slot];
+}
+
+
+// Everything the ships on a team can see on the commander's map.  Ships see everything in range on their own
+// screens, but only some kinds of things on their teammates'; it's up to the caller to add its own ship's view.
+const Vector<DatabaseObject *> &GameType::getCmdrMapObjects(S32 teamIndex)
+{
+   TeamVisibility &visibility = getTeamVisibility(teamIndex);
+
+   if(visibility.cmdrMapGeneration == mVisibilityGeneration)
+      return visibility.cmdrMapObjects;
+
+   visibility.cmdrMapGeneration = mVisibilityGeneration;
+   visibility.cmdrMapObjects.clear();
+
    bool sameQuery = false;  // helps speed up by not repeatedly finding same objects
 
+   for(S32 i = 0; i < mGame->getClientCount(); i++)
+   {
+      ClientInfo *clientInfo = mGame->getClientInfo(i);
+
+      if(clientInfo->getTeamIndex() != teamIndex)      // Wrong team
+         continue;
+
+      Ship *ship = clientInfo->getShip();
+      if(!ship)       // Can happen!
+         continue;
+
+      Rect queryRect(ship->getActualPos(), ship->getActualPos());
+      queryRect.expand(mGame->getScopeRange(ship->hasModule(ModuleSensor)));
+
+      TestFunc testFunc = ship->hasModule(ModuleSensor) ? &isVisibleOnCmdrsMapWithSensorType : &isVisibleOnCmdrsMapType;
+
+      mGame->getGameObjDatabase()->findObjects(testFunc, visibility.cmdrMapObjects, queryRect, sameQuery);
+      sameQuery = true;
+   }
+
+   return visibility.cmdrMapObjects;
+}
+
+
+// Everything seen by the team's spy bugs, or the neutral ones, which everyone can see through
+const Vector<DatabaseObject *> &GameType::getSpyBugObjects(S32 teamIndex)
+{
+   TeamVisibility &visibility = getTeamVisibility(teamIndex);
+
+   if(visibility.spyBugGeneration == mVisibilityGeneration)
+      return visibility.spyBugObjects;
+
+   visibility.spyBugGeneration = mVisibilityGeneration;
+   visibility.spyBugObjects.clear();
+
    const Vector<DatabaseObject *> *spyBugs = mGame->getGameObjDatabase()->findObjects_fast(SpyBugTypeNumber);
-   const Point scopeRange(SpyBug::SPY_BUG_RADIUS, SpyBug::SPY_BUG_RADIUS * FloatSqrt3Half);  // Bounding box of hexagon
+   Vector<SpyBug *> teamSpyBugs;
 
-   for(S32 i = spyBugs->size()-1; i >= 0; i--)
+   for(S32 i = 0; i < spyBugs->size(); i++)
    {
-      SpyBug *sb = static_cast<SpyBug *>(spyBugs->get(i));
-//      shared_ptr<SpyBug> sb = shared_ptr<SpyBug>(sb);
+      SpyBug *spyBug = static_cast<SpyBug *>(spyBugs->get(i));
 
-      if(sb->isVisibleToPlayer(clientInfo, isTeamGame()))
-      {
-         Point pos = sb->getActualPos();
-         Rect queryRect(pos, pos);
+      if(spyBug->getTeam() == TEAM_NEUTRAL || spyBug->getTeam() == teamIndex)
+         teamSpyBugs.push_back(spyBug);
+   }
 
-         queryRect.expand(scopeRange);
+   findObjectsSeenBySpyBugs(teamSpyBugs, visibility.spyBugObjects);
 
-         fillVector.clear();
-         mGame->getGameObjDatabase()->findObjects((TestFunc)isAnyObjectType, fillVector, queryRect, sameQuery);
-         sameQuery = true;
+   return visibility.spyBugObjects;
+}
 
-         for(S32 j = 0; j < fillVector.size(); j++)
-         {
-            // Some objects don't have geometry (ForceFields).  Is this a bug?
-            if(!fillVector[j]->hasGeometry())
-               continue;
 
-            if(!pointInHexagon(fillVector[j]->getPos(), pos, SpyBug::SPY_BUG_RADIUS))
-               continue;
+// Adds everything inside any of the spy bugs' hexagons to objects
+void GameType::findObjectsSeenBySpyBugs(const Vector<SpyBug *> &spyBugs, Vector<DatabaseObject *> &objects)
+{
+   if(spyBugs.size() == 0)
+      return;
 
-            connection->objectInScope(static_cast<BfObject *>(fillVector[j]));
-            if(isShipType(fillVector[j]->getObjectTypeNumber()))
-               markAllMountedItemsAsBeingInScope(static_cast<Ship *>(fillVector[j]), conn);
+   const Point scopeRange(SpyBug::SPY_BUG_RADIUS, SpyBug::SPY_BUG_RADIUS * FloatSqrt3Half);  // Bounding box of hexagon
+
+   // Objects near more than one bug will only be found once
+   fillVector.clear();
+   for(S32 i = 0; i < spyBugs.size(); i++)
+   {
+      Point pos = spyBugs[i]->getActualPos();
+      Rect queryRect(pos, pos);
+
+      queryRect.expand(scopeRange);
+      mGame->getGameObjDatabase()->findObjects((TestFunc)isAnyObjectType, fillVector, queryRect, i > 0);
+   }
+
+   for(S32 i = 0; i < fillVector.size(); i++)
+   {
+      // Some objects don't have geometry (ForceFields).  Is this a bug?
+      if(!fillVector[i]->hasGeometry())
+         continue;
+
+      for(S32 j = 0; j < spyBugs.size(); j++)
+         if(pointInHexagon(fillVector[i]->getPos(), spyBugs[j]->getActualPos(), SpyBug::SPY_BUG_RADIUS))
+         {
+            objects.push_back(fillVector[i]);
+            break;
          }
-      }
    }
 }
 
@@ -1424,66 +1556,27 @@ void GameType::performProxyScopeQuery(BfObject *scopeObject, ClientInfo *clientI
    //   }
    //}
 
-   // If we're in commander's map mode, then we can see what our teammates can see.  
-   // This will also scope what we can see.
-
    GameConnection *connection = clientInfo->getConnection();
    TNLAssert(connection, "NULL gameConnection!");
 
+   // If we're in commander's map mode, then we can see what our teammates can see.  Everyone on the team
+   // shares the same list, built by whoever gets here first this tick.
    if(isTeamGame() && connection->isInCommanderMap())
-   {
-      S32 teamId = clientInfo->getTeamIndex();
-      fillVector.clear();
-      bool sameQuery = false;  // helps speed up by not repeatedly finding same objects
-
-      for(S32 i = 0; i < mGame->getClientCount(); i++)
-      {
-         ClientInfo *clientInfo = mGame->getClientInfo(i);
-
-         if(clientInfo->getTeamIndex() != teamId)      // Wrong team
-            continue;
-
-         Ship *ship = clientInfo->getShip();
-         if(!ship)       // Can happen!
-            continue;
-
-         Rect queryRect(ship->getActualPos(), ship->getActualPos());
-         queryRect.expand(mGame->getScopeRange(ship->hasModule(ModuleSensor)));
-
-         TestFunc testFunc;
-         if(scopeObject == ship)    
-            testFunc = &isAnyObjectType;
-         else
-            if(ship && ship->hasModule(ModuleSensor))
-               testFunc = &isVisibleOnCmdrsMapWithSensorType;
-            else     // No sensor
-               testFunc = &isVisibleOnCmdrsMapType;
+      markAllObjectsAsBeingInScope(getCmdrMapObjects(clientInfo->getTeamIndex()), connection);
 
-         mGame->getGameObjDatabase()->findObjects(testFunc, fillVector, queryRect, sameQuery);
-         sameQuery = true;
-      }
-   }
-   else     // Not a team game OR not in commander's map -- Do a simple query of the objects within scope range of the ship
-   {
-      // Note that if we make mine visibility controlled by server, here's where we'd put the code
-      Point pos = scopeObject->getPos();
-      TNLAssert(dynamic_cast<Ship *>(scopeObject), "Control object not a ship!");
-      Ship *co = static_cast<Ship *>(scopeObject);
+   // Either way, we can see all the objects within scope range of our own ship
+   // Note that if we make mine visibility controlled by server, here's where we'd put the code
+   Point pos = scopeObject->getPos();
+   TNLAssert(dynamic_cast<Ship *>(scopeObject), "Control object not a ship!");
+   Ship *co = static_cast<Ship *>(scopeObject);
 
-      Rect queryRect(pos, pos);
-      queryRect.expand( mGame->getScopeRange(co->hasModule(ModuleSensor)) );
+   Rect queryRect(pos, pos);
+   queryRect.expand( mGame->getScopeRange(co->hasModule(ModuleSensor)) );
 
-      fillVector.clear();
-      mGame->getGameObjDatabase()->findObjects((TestFunc)isAnyObjectType, fillVector, queryRect);
-   }
+   fillVector.clear();
+   mGame->getGameObjDatabase()->findObjects((TestFunc)isAnyObjectType, fillVector, queryRect);
 
-   // Set object-in-scope for all objects found above
-   for(S32 i = 0; i < fillVector.size(); i++)
-   {
-      connection->objectInScope(static_cast<BfObject *>(fillVector[i]));
-      if(isShipType(fillVector[i]->getObjectTypeNumber()))
-         markAllMountedItemsAsBeingInScope(static_cast<Ship *>(fillVector[i]), connection);
-   }
+   markAllObjectsAsBeingInScope(fillVector, connection);
 
    // Make bots visible if showAllBots has been activated
    if(mShowAllBots && connection->isInCommanderMap())
@@ -2302,13 +2395,11 @@ GAMETYPE_RPC_S2C(GameType, s2cAddClient,
    clientGame->onPlayerJoined(clientInfo, isMyClient, playAlert, showMessage);
 
 
-   const Vector<DatabaseObject*> &database = *(getGame()->getGameObjDatabase()->findObjects_fast());
+   fillVector.clear();
+   getGame()->getGameObjDatabase()->findObjects((TestFunc)isShipType, fillVector);
 
-   for(S32 i = database.size()-1; i >= 0; i--)
-   {
-      if(database[i]->getObjectTypeNumber() == PlayerShipTypeNumber || database[i]->getObjectTypeNumber() == RobotShipTypeNumber)
-         ((Ship*)database[i])->findClientInfoFromName();
-   }
+   for(S32 i = fillVector.size()-1; i >= 0; i--)
+      ((Ship*)fillVector[i])->findClientInfoFromName();
 #endif
 }
 
@@ -2593,17 +2684,25 @@ void GameType::onGhostAvailable(GhostConnection *theConnection)
    //   s2cClientJoinedTeam(Robot::robots[i]->getName(), Robot::robots[i]->getTeam());
    //}
 
-   // Sending an empty list clears the barriers
-   // FIXME:  Why is this the chosen mechanism to do this?
-   Vector<F32> v;
-   s2cAddWalls(v, 0, false);
+   // Clients that have played this level before can build the walls from their cache
+   bool useCachedWalls = mWalls.size() > 0 && static_cast<GameConnection *>(theConnection)->hasCachedLevel(getWallsHash());
+
+   s2cSetLevelGeometry(getWallsHash().c_str(), useCachedWalls);
 
-   for(S32 i = 0; i < mWalls.size(); i++)
+   if(!useCachedWalls)
    {
-      // If players somehow create 0-point walls, don't send them to the client
-      // or it will remove all walls previously added
-      if(mWalls[i].verts.size() != 0)
-         s2cAddWalls(mWalls[i].verts, mWalls[i].width, mWalls[i].solid);
+      // Sending an empty list clears the barriers
+      // FIXME:  Why is this the chosen mechanism to do this?
+      Vector<F32> v;
+      s2cAddWalls(v, 0, false);
+
+      for(S32 i = 0; i < mWalls.size(); i++)
+      {
+         // If players somehow create 0-point walls, don't send them to the client
+         // or it will remove all walls previously added
+         if(mWalls[i].verts.size() != 0)
+            s2cAddWalls(mWalls[i].verts, mWalls[i].width, mWalls[i].solid);
+      }
    }
 
    broadcastNewRemainingTime();
@@ -2645,6 +2744,15 @@ GAMETYPE_RPC_C2S(GameType, c2sSyncMessagesComplete, (U32 sequence), (sequence))
 }
 
 
+// Sent ahead of the walls, so the client knows which level geometry it's about to get, or that it can use its own copy
+GAMETYPE_RPC_S2C(GameType, s2cSetLevelGeometry, (StringPtr wallsHash, bool useCachedWalls), (wallsHash, useCachedWalls))
+{
+#ifndef ZAP_DEDICATED
+   static_cast<ClientGame *>(mGame)->setLevelGeometry(wallsHash.getString(), useCachedWalls);
+#endif
+}
+
+
 // Gets called multiple times as barriers are added
 TNL_IMPLEMENT_NETOBJECT_RPC(GameType, s2cAddWalls, (Vector<F32> verts, F32 width, bool solid), (verts, width, solid), NetClassGroupGameMask, RPCGuaranteedOrderedBigData, RPCToGhost, 0)
 {
@@ -2656,6 +2764,10 @@ TNL_IMPLEMENT_NETOBJECT_RPC(GameType, s2cAddWalls, (Vector<F32> verts, F32 width
    {
       WallRec wall(width, solid, verts);
       wall.constructWalls(mGame);
+
+#ifndef ZAP_DEDICATED
+      static_cast<ClientGame *>(mGame)->addReceivedWall(wall);    // So it can be cached
+#endif
    }
 }
 
@@ -3986,6 +4098,16 @@ const Vector<WallRec> *GameType::getBarrierList()
 }
 
 
+// Server only
+const string &GameType::getWallsHash()
+{
+   if(mWallsHash == "")
+      mWallsHash = LevelGeometryCache::getWallsHash(mWalls);
+
+   return mWallsHash;
+}
+
+
 // Send a message to all clients
 void GameType::broadcastMessage(GameConnection::MessageColors color, SFXProfiles sfx, const StringTableEntry &message)
 {
@@ -63,6 +63,7 @@ private:
    bool mShowAllBots;
 
    Vector<WallRec> mWalls;
+   string mWallsHash;               // Identifies mWalls to clients that cache level geometry; "" until someone asks
 
    S32 mWinningScore;               // Game over when team (or player in individual games) gets this score
    S32 mLeadingTeam;                // Team with highest score
@@ -93,6 +94,26 @@ private:
 
    Vector<SafePtr<MoveItem> > mCacheResendItem;  // Speed up c2sResendItemStatus
 
+   // What a team can see through its ships on the commander's map, and through its spy bugs.  Built the first time a
+   // connection on the team needs it each tick, then reused by all of its teammates.
+   struct TeamVisibility
+   {
+      U32 cmdrMapGeneration;
+      U32 spyBugGeneration;
+      Vector<DatabaseObject *> cmdrMapObjects;
+      Vector<DatabaseObject *> spyBugObjects;
+
+      TeamVisibility();
+   };
+
+   Vector<TeamVisibility> mTeamVisibility;   // Indexed by team index - NO_TEAM, so neutral spy bugs get a slot too
+   U32 mVisibilityGeneration;                // Bumping this makes everything in mTeamVisibility stale
+
+   TeamVisibility &getTeamVisibility(S32 teamIndex);
+   const Vector<DatabaseObject *> &getCmdrMapObjects(S32 teamIndex);
+   const Vector<DatabaseObject *> &getSpyBugObjects(S32 teamIndex);
+   void findObjectsSeenBySpyBugs(const Vector<SpyBug *> &spyBugs, Vector<DatabaseObject *> &objects);
+
    void idle_client(U32 deltaT);
    void idle_server(U32 deltaT);
 
@@ -202,6 +223,7 @@ public:
 
 
    const Vector<WallRec> *getBarrierList();
+   const string &getWallsHash();
 
    S32 mObjectsExpected;            // Count of objects we expect to get with this level (for display purposes only)
 
@@ -381,11 +403,13 @@ public:
    bool makeSureTeamCountIsNotZero();
    void performScopeQuery(GhostConnection *connection);
    virtual void performProxyScopeQuery(BfObject *scopeObject, ClientInfo *clientInfo);
+   void invalidateTeamVisibility();
 
    virtual void onGhostAvailable(GhostConnection *theConnection);
    TNL_DECLARE_RPC(s2cSetLevelInfo, (StringTableEntry levelName, StringPtr levelDesc, StringPtr musicName, S32 teamScoreLimit,
                                      StringTableEntry levelCreds, S32 objectCount, 
                                      bool levelHasLoadoutZone, bool engineerEnabled, bool engineerAbuseEnabled, U32 levelDatabaseId));
+   TNL_DECLARE_RPC(s2cSetLevelGeometry, (StringPtr wallsHash, bool useCachedWalls));
    TNL_DECLARE_RPC(s2cAddWalls, (Vector<F32> barrier, F32 width, bool solid));
    TNL_DECLARE_RPC(s2cAddTeam, (StringTableEntry teamName, F32 r, F32 g, F32 b, U32 score, bool firstTeam));
    TNL_DECLARE_RPC(s2cAddClient, (StringTableEntry clientName, bool isAuthenticated, Int<BADGE_COUNT> badges, 
@@ -28,7 +28,7 @@ TNL_IMPLEMENT_NETOBJECT(GoalZone);
 // Combined Lua / C++ constructor
 GoalZone::GoalZone(lua_State *L)
 {
-   mNetFlags.set(Ghostable);
+   mNetFlags.set(Ghostable | SharedUpdates);
    mObjectTypeNumber = GoalZoneTypeNumber;
 
    mFlashCount = 0;
@@ -7,16 +7,15 @@
 #include "moveObject.h"    // For def of ActualState
 #include "WallSegmentManager.h"
 #include "GeomUtils.h"
+#include "MathUtils.h"     // For CLAMP
 
 #include "tnlLog.h"
 
+#include <math.h>
+
 namespace Zap
 {
 
-U32 GridDatabase::mQueryId = 0;
-ClassChunker<DatabaseBucketEntry> *GridDatabase::mChunker = NULL;
-U32 GridDatabase::mCountGridDatabase = 0;
-
 static U32 getNextId() 
 {
    static U32 nextId = 0;
@@ -24,16 +23,95 @@ static U32 getNextId()
 }
 
 // Constructor
-GridDatabase::GridDatabase(bool createWallSegmentManager)
+DatabaseQuery::DatabaseQuery()
+{
+   mQueryId = 0;
+   mDatabase = NULL;
+   resetCounts();
+}
+
+
+void DatabaseQuery::resetCounts()
+{
+   mCellsVisited = 0;
+   mObjectsChecked = 0;
+}
+
+
+U32 DatabaseQuery::getCellsVisited() const
+{
+   return mCellsVisited;
+}
+
+
+U32 DatabaseQuery::getObjectsChecked() const
+{
+   return mObjectsChecked;
+}
+
+
+// Start a new search, unless sameQuery is set, in which case objects found by the previous search will be skipped
+void DatabaseQuery::beginQuery(const GridDatabase *database, bool sameQuery)
 {
-   if(mChunker == NULL)
-      mChunker = new ClassChunker<DatabaseBucketEntry>();        // Static shared by all databases, reference counted and deleted in destructor
+   TNLAssert(!sameQuery || database == mDatabase, "Can't continue a query on a different database!");
+
+   if(!sameQuery || database != mDatabase)
+   {
+      mQueryId++;
+
+      if(mQueryId == 0)    // Wrapped around; old stamps could now look current, so clear them out
+      {
+         for(S32 i = 0; i < mVisitStamps.size(); i++)
+            mVisitStamps[i] = 0;
+
+         mQueryId = 1;
+      }
+   }
+
+   mDatabase = database;
+
+   // Make sure we have a stamp for every slot the database has handed out
+   if(mVisitStamps.size() < database->mSlotCount)
+   {
+      S32 oldSize = mVisitStamps.size();
+      mVisitStamps.resize(database->mSlotCount);
+
+      for(S32 i = oldSize; i < mVisitStamps.size(); i++)
+         mVisitStamps[i] = 0;
+   }
+}
+
+
+bool DatabaseQuery::markVisited(const DatabaseObject *object)
+{
+   U32 &stamp = mVisitStamps[object->mDatabaseSlot];
+
+   if(stamp == mQueryId)
+      return false;
+
+   stamp = mQueryId;
+   return true;
+}
 
-   mCountGridDatabase++;
 
-   for(U32 i = 0; i < BucketRowCount; i++)
-      for(U32 j = 0; j < BucketRowCount; j++)
-         mBuckets[i][j].nextInBucket = NULL;
+////////////////////////////////////////
+////////////////////////////////////////
+
+// Constructor
+GridDatabase::GridDatabase(bool createWallSegmentManager)
+{
+   mCellShift = DefaultCellShift;
+   mSlotCount = 0;
+   mNextListOrder = 0;
+   mUseStaticIndex = false;
+   mExtentsDirty = true;
+   clearCells();
+
+   for(S32 i = 0; i < U8_MAX + 1; i++)
+   {
+      mTypeChangeCounts[i] = 0;
+      mTypeListShuffled[i] = false;
+   }
 
    if(createWallSegmentManager)
       mWallSegmentManager = new WallSegmentManager();    // Gets deleted in destructor
@@ -59,18 +137,8 @@ GridDatabase::~GridDatabase()
 {
    removeEverythingFromDatabase();
 
-   TNLAssert(mChunker != NULL || mCountGridDatabase != 0, "Running GridDatabase destructor without initalizing?");
-
    if(mWallSegmentManager)
       delete mWallSegmentManager;
-
-   mCountGridDatabase--;
-
-   if(mCountGridDatabase == 0)
-   {
-      delete mChunker;
-      mChunker = NULL;
-   }
 }
 
 
@@ -102,15 +170,15 @@ void GridDatabase::copyObjects(const GridDatabase *source)
 {
    // Preallocate some memory to make copying a little more efficient
    mAllObjects.reserve(source->mAllObjects.size());
-   mGoalZones .reserve(source->mGoalZones.size());
-   mFlags     .reserve(source->mFlags.size());
-   mSpyBugs   .reserve(source->mSpyBugs.size());
 
+   for(S32 i = 0; i < U8_MAX + 1; i++)
+      mObjectsByType[i].reserve(source->mObjectsByType[i].size());
 
    for(S32 i = 0; i < source->mAllObjects.size(); i++)
       addToDatabase(source->mAllObjects[i]->clone());
 
    sortObjects(mAllObjects);
+   rebuildTypeLists();        // So each type list is in the same order as mAllObjects again
 }
 
 
@@ -120,42 +188,41 @@ void GridDatabase::addToDatabase(DatabaseObject *theObject)
    TNLAssert(theObject->mDatabase != this, "Already added to database, trying to add to same database again!");
    TNLAssert(!theObject->mDatabase,        "Already added to database, trying to add to different database!");
    TNLAssert(theObject->getExtentSet(),    "Object extents were never set!");
-   TNLAssert(!theObject->mBucketList,       "BucketList must be NULL");
 
    if(theObject->mDatabase)      // Should never happen
       return;
 
    theObject->mDatabase = this;
 
-   static IntRect bins;
-   fillBins(theObject->getExtent(), bins);
+   if(mFreeSlots.size() > 0)
+   {
+      theObject->mDatabaseSlot = mFreeSlots.last();
+      mFreeSlots.erase_fast(mFreeSlots.size() - 1);
+   }
+   else
+      theObject->mDatabaseSlot = mSlotCount++;
 
-   for(S32 x = bins.minx; bins.maxx - x >= 0; x++)
-      for(S32 y = bins.miny; bins.maxy - y >= 0; y++)
-      {
-         DatabaseBucketEntry *be = mChunker->alloc();
-         DatabaseBucketEntryBase *base = &mBuckets[x & BucketMask][y & BucketMask];
-         be->theObject = theObject;
-         if(base->nextInBucket)
-            base->nextInBucket->prevInBucket = be;
-         be->nextInBucket = base->nextInBucket;
-         be->prevInBucket = base;
-         base->nextInBucket = be;
-         be->nextInBucketForThisObject = theObject->mBucketList;
-         theObject->mBucketList = be;
-      }
+   if(mCircleRadius.size() < mSlotCount)
+   {
+      mCircleX.resize(mSlotCount);
+      mCircleY.resize(mSlotCount);
+      mCircleRadius.resize(mSlotCount);
+   }
+
+   mCircleRadius[theObject->mDatabaseSlot] = -1;      // Slot may be recycled; objects mirror their circles themselves
+
+   IntRect bins;
+   fillBins(theObject->getExtent(), bins);
+   addToCells(theObject, bins);
 
    // Add the object to our non-spatial "database" as well
    mAllObjects.push_back(theObject);
 
-   U8 type = theObject->getObjectTypeNumber();
-   if(type == GoalZoneTypeNumber)
-      mGoalZones.push_back(theObject);
-   else if(type == FlagTypeNumber)
-      mFlags.push_back(theObject);
-   else if(type == SpyBugTypeNumber)
-      mSpyBugs.push_back(theObject);
-   
+   if(!theObject->isDeleted())
+      addToTypeList(theObject);
+
+   growExtents(theObject->mExtent);
+
    //sortObjects(mAllObjects);  // problem: Barriers in-game don't have mGeometry (it is NULL)
 }
 
@@ -170,26 +237,29 @@ void GridDatabase::addToDatabase(const Vector<DatabaseObject *> &objects)
 
 void GridDatabase::removeEverythingFromDatabase()
 {
-   for(S32 x = 0; x < BucketRowCount; x++)
+   for(S32 i = 0; i < mAllObjects.size(); i++)
    {
-      for(S32 y = 0; y < BucketRowCount; y++)
-      {
-         for(DatabaseBucketEntry *walk = mBuckets[x & BucketMask][y & BucketMask].nextInBucket; walk; )
-         {
-            DatabaseBucketEntry *rem = walk;
-            walk->theObject->mDatabase = NULL;  // make sure object don't point to this database anymore
-            walk->theObject->mBucketList = NULL;
-            walk = rem->nextInBucket;
-            mChunker->free(rem);
-         }
-         mBuckets[x & BucketMask][y & BucketMask].nextInBucket = NULL;
-      }
+      mAllObjects[i]->mDatabase = NULL;   // Make sure objects don't point to this database anymore
+      mAllObjects[i]->mDatabaseSlot = -1;
    }
 
-   // Clear out our specialty lists -- since objects are also in mAllObjects, they'll be deleted below
-   mGoalZones.clear();
-   mFlags.clear();
-   mSpyBugs.clear();
+   mSlotCount = 0;
+   mFreeSlots.clear();
+   mCircleX.clear();
+   mCircleY.clear();
+   mCircleRadius.clear();
+
+   mUseStaticIndex = false;      // Next level will have to build its own
+   mExtentsDirty = true;
+   clearCells();
+
+   // Clear out our type lists -- since objects are also in mAllObjects, they'll be deleted below
+   for(S32 i = 0; i < U8_MAX + 1; i++)
+   {
+      mObjectsByType[i].clear();
+      mTypeListShuffled[i] = false;
+      mTypeChangeCounts[i]++;
+   }
 
    mAllObjects.deleteAndClear();
    
@@ -210,29 +280,519 @@ static void eraseObject_fast(Vector<DatabaseObject *> *objects, DatabaseObject *
 }
 
 
+void GridDatabase::addToTypeList(DatabaseObject *object)
+{
+   Vector<DatabaseObject *> &list = mObjectsByType[object->getObjectTypeNumber()];
+
+   object->mIndexedTypeNumber = object->getObjectTypeNumber();
+   object->mTypeListIndex = list.size();
+   object->mListOrder = mNextListOrder++;
+   list.push_back(object);
+
+   mTypeChangeCounts[object->mIndexedTypeNumber]++;
+}
+
+
+// Objects get their type changed when they're marked as deleted, so we remember which list we put them in.  We fill the
+// hole with the last object, so the list is no longer in mAllObjects order; searches that promise that order sort.
+void GridDatabase::removeFromTypeList(DatabaseObject *object)
+{
+   S32 index = object->mTypeListIndex;
+
+   if(index == -1)      // Already taken out when it was marked as deleted
+      return;
+
+   Vector<DatabaseObject *> &list = mObjectsByType[object->mIndexedTypeNumber];
+
+   TNLAssert(list[index] == object, "Type list is out of sync!");
+
+   list.erase_fast(index);
+
+   if(index < list.size())
+   {
+      list[index]->mTypeListIndex = index;
+      mTypeListShuffled[object->mIndexedTypeNumber] = true;
+   }
+
+   object->mTypeListIndex = -1;
+   mTypeChangeCounts[object->mIndexedTypeNumber]++;
+}
+
+
+// Refile every object in mAllObjects order, for when mAllObjects has been reordered
+void GridDatabase::rebuildTypeLists()
+{
+   for(S32 i = 0; i < U8_MAX + 1; i++)
+   {
+      mObjectsByType[i].clear();
+      mTypeListShuffled[i] = false;
+   }
+
+   mNextListOrder = 0;
+
+   for(S32 i = 0; i < mAllObjects.size(); i++)
+      if(!mAllObjects[i]->isDeleted())
+         addToTypeList(mAllObjects[i]);
+}
+
+
+void GridDatabase::onObjectDeleted(DatabaseObject *object)
+{
+   TNLAssert(object->mDatabase == this, "Object is in another database!");
+   removeFromTypeList(object);
+}
+
+
+// Append objects of the given type to fillVector
+void GridDatabase::appendObjectsOfType(U8 typeNumber, Vector<DatabaseObject *> &fillVector) const
+{
+   const Vector<DatabaseObject *> &objects = mObjectsByType[typeNumber];
+
+   for(S32 i = 0; i < objects.size(); i++)
+      fillVector.push_back(objects[i]);
+}
+
+
+// Hash for our cell table -- large primes spread neighboring cells across the table
+static inline U32 hashCell(S32 x, S32 y)
+{
+   return (U32(x) * 73856093U) ^ (U32(y) * 19349663U);
+}
+
+
+static inline bool cellInBins(const IntRect &bins, S32 x, S32 y)
+{
+   return x >= bins.minx && x <= bins.maxx && y >= bins.miny && y <= bins.maxy;
+}
+
+
+// Number of cells covered by bins; computed in 64 bits because bins can be huge
+static inline S64 getBinCount(const IntRect &bins)
+{
+   return S64(bins.maxx - bins.minx + 1) * S64(bins.maxy - bins.miny + 1);
+}
+
+
+// Returns index of cell (x,y) in mCells, or -1 if that cell has never been used
+S32 GridDatabase::findCellIndex(S32 x, S32 y) const
+{
+   if(mCellHash.size() == 0)
+      return -1;
+
+   U32 mask = mCellHash.size() - 1;
+
+   // Table is never more than half full, so we'll always hit an empty slot eventually
+   for(U32 slot = hashCell(x, y) & mask; ; slot = (slot + 1) & mask)
+   {
+      S32 index = mCellHash[slot];
+
+      if(index == -1)
+         return -1;
+
+      if(mCells[index].x == x && mCells[index].y == y)
+         return index;
+   }
+}
+
+
+const DatabaseCell *GridDatabase::getCell(S32 x, S32 y) const
+{
+   S32 index = findCellIndex(x, y);
+   return index == -1 ? NULL : &mCells[index];
+}
+
+
+DatabaseCell *GridDatabase::findOrCreateCell(S32 x, S32 y)
+{
+   S32 index = findCellIndex(x, y);
+   if(index != -1)
+      return &mCells[index];
+
+   // Keep the load factor at or below 50%
+   if((mCells.size() + 1) * 2 > mCellHash.size())
+      growCellHash((mCells.size() + 1) * 2);
+
+   index = mCells.size();
+   mCells.resize(index + 1);
+   mCells[index].x = x;
+   mCells[index].y = y;
+
+   U32 mask = mCellHash.size() - 1;
+   U32 slot = hashCell(x, y) & mask;
+   while(mCellHash[slot] != -1)
+      slot = (slot + 1) & mask;
+
+   mCellHash[slot] = index;
+
+   mOccupiedCells.minx = min(mOccupiedCells.minx, x);
+   mOccupiedCells.miny = min(mOccupiedCells.miny, y);
+   mOccupiedCells.maxx = max(mOccupiedCells.maxx, x);
+   mOccupiedCells.maxy = max(mOccupiedCells.maxy, y);
+
+   return &mCells[index];
+}
+
+
+// Resize our hash table to hold at least minSize slots, and reinsert all existing cells
+void GridDatabase::growCellHash(S32 minSize)
+{
+   S32 size = 256;
+   while(size < minSize)
+      size *= 2;
+
+   if(size <= mCellHash.size())
+      return;
+
+   mCellHash.resize(size);
+   for(S32 i = 0; i < size; i++)
+      mCellHash[i] = -1;
+
+   U32 mask = size - 1;
+   for(S32 i = 0; i < mCells.size(); i++)
+   {
+      U32 slot = hashCell(mCells[i].x, mCells[i].y) & mask;
+      while(mCellHash[slot] != -1)
+         slot = (slot + 1) & mask;
+
+      mCellHash[slot] = i;
+   }
+}
+
+
+// Find the range of mStaticObjects listed in static cell (x,y)
+bool GridDatabase::getStaticCell(S32 x, S32 y, S32 &first, S32 &last) const
+{
+   if(!cellInBins(mStaticCells, x, y))
+      return false;
+
+   S32 index = (y - mStaticCells.miny) * (mStaticCells.maxx - mStaticCells.minx + 1) + (x - mStaticCells.minx);
+
+   first = mStaticCellStarts[index];
+   last  = mStaticCellStarts[index + 1];
+
+   return true;
+}
+
+
+void GridDatabase::addToCells(DatabaseObject *object, const IntRect &bins)
+{
+   object->mCellRange = bins;
+   object->mInStaticIndex = false;
+
+   if(getBinCount(bins) > MaxCellsPerObject)
+   {
+      object->mInLargeObjectList = true;
+      mLargeObjects.push_back(object);
+      return;
+   }
+
+   object->mInLargeObjectList = false;
+
+   for(S32 x = bins.minx; x <= bins.maxx; x++)
+      for(S32 y = bins.miny; y <= bins.maxy; y++)
+         findOrCreateCell(x, y)->objects.push_back(object);
+}
+
+
+void GridDatabase::removeFromCells(DatabaseObject *object)
+{
+   if(object->mInStaticIndex)
+   {
+      removeFromStaticIndex(object);
+      return;
+   }
+
+   if(object->mInLargeObjectList)
+   {
+      eraseObject_fast(&mLargeObjects, object);
+      return;
+   }
+
+   const IntRect &bins = object->mCellRange;
+
+   for(S32 x = bins.minx; x <= bins.maxx; x++)
+      for(S32 y = bins.miny; y <= bins.maxy; y++)
+      {
+         S32 index = findCellIndex(x, y);
+         TNLAssert(index != -1, "Object is missing from a cell it should be in!");
+         if(index != -1)
+            eraseObject_fast(&mCells[index].objects, object);
+      }
+}
+
+
+// Called when an object in the database is about to get new extents; only touches the cells that actually change
+void GridDatabase::updateCells(DatabaseObject *object, const Rect &newExtent)
+{
+   // Grow first, so an object pushing an edge outward doesn't make us think that edge has been vacated
+   growExtents(newExtent);
+   shrinkExtents(object->mExtent);
+
+   IntRect bins;
+   fillBins(newExtent, bins);
+
+   const IntRect &old = object->mCellRange;
+
+   // Don't do anything if the cells haven't changed...
+   if(!((old.minx - bins.minx) | (old.miny - bins.miny) | (old.maxx - bins.maxx) | (old.maxy - bins.maxy)))
+      return;
+
+   // Large objects, or ones becoming large, are simply moved wholesale.  So are static objects that turn out to move after
+   // all; they'll be treated like any other mover from here on.
+   if(object->mInStaticIndex || object->mInLargeObjectList || getBinCount(bins) > MaxCellsPerObject)
+   {
+      removeFromCells(object);
+      addToCells(object, bins);
+      return;
+   }
+
+   // Remove from cells we're leaving...
+   for(S32 x = old.minx; x <= old.maxx; x++)
+      for(S32 y = old.miny; y <= old.maxy; y++)
+         if(!cellInBins(bins, x, y))
+         {
+            S32 index = findCellIndex(x, y);
+            TNLAssert(index != -1, "Object is missing from a cell it should be in!");
+            if(index != -1)
+               eraseObject_fast(&mCells[index].objects, object);
+         }
+
+   // ...and add to those we're entering
+   for(S32 x = bins.minx; x <= bins.maxx; x++)
+      for(S32 y = bins.miny; y <= bins.maxy; y++)
+         if(!cellInBins(old, x, y))
+            findOrCreateCell(x, y)->objects.push_back(object);
+
+   object->mCellRange = bins;
+}
+
+
+// Empty out our spatial index, leaving mAllObjects alone
+void GridDatabase::clearCells()
+{
+   mCells.clear();
+   mCellHash.clear();
+   mLargeObjects.clear();
+   mStaticCellStarts.clear();
+   mStaticObjects.clear();
+
+   // Can't use IntRect::set() here, it would helpfully swap min and max on us
+   mOccupiedCells.minx = S32_MAX;
+   mOccupiedCells.miny = S32_MAX;
+   mOccupiedCells.maxx = S32_MIN;
+   mOccupiedCells.maxy = S32_MIN;
+
+   mStaticCells = mOccupiedCells;
+}
+
+
+// Throw away our cells and re-index every object using the current mCellShift
+void GridDatabase::rebuildCells()
+{
+   clearCells();
+
+   Vector<DatabaseObject *> staticObjects;
+   IntRect bins;
+
+   for(S32 i = 0; i < mAllObjects.size(); i++)
+   {
+      DatabaseObject *object = mAllObjects[i];
+      fillBins(object->mExtent, bins);
+
+      if(mUseStaticIndex && isStaticType(object->getObjectTypeNumber()) && getBinCount(bins) <= MaxCellsPerObject)
+      {
+         object->mCellRange = bins;
+         object->mInLargeObjectList = false;
+         staticObjects.push_back(object);
+      }
+      else
+         addToCells(object, bins);
+   }
+
+   packStaticObjects(staticObjects);
+}
+
+
+// Lay out objects in our static grid; each object's mCellRange must already be set
+void GridDatabase::packStaticObjects(const Vector<DatabaseObject *> &objects)
+{
+   if(objects.size() == 0)
+      return;
+
+   IntRect cells = objects[0]->mCellRange;
+
+   for(S32 i = 1; i < objects.size(); i++)
+   {
+      const IntRect &bins = objects[i]->mCellRange;
+
+      cells.minx = min(cells.minx, bins.minx);
+      cells.miny = min(cells.miny, bins.miny);
+      cells.maxx = max(cells.maxx, bins.maxx);
+      cells.maxy = max(cells.maxy, bins.maxy);
+   }
+
+   // Our static grid is dense, so don't build one for a few objects that are light years apart
+   if(getBinCount(cells) > MaxStaticCells)
+   {
+      for(S32 i = 0; i < objects.size(); i++)
+         addToCells(objects[i], objects[i]->mCellRange);
+      return;
+   }
+
+   mStaticCells = cells;
+
+   const S32 cellsAcross = cells.maxx - cells.minx + 1;
+   const S32 cellCount = S32(getBinCount(cells));
+
+   // First count the objects in each cell, which tells us where each cell's list starts...
+   mStaticCellStarts.resize(cellCount + 1);
+   for(S32 i = 0; i < mStaticCellStarts.size(); i++)
+      mStaticCellStarts[i] = 0;
+
+   for(S32 i = 0; i < objects.size(); i++)
+   {
+      const IntRect &bins = objects[i]->mCellRange;
+
+      for(S32 y = bins.miny; y <= bins.maxy; y++)
+         for(S32 x = bins.minx; x <= bins.maxx; x++)
+            mStaticCellStarts[(y - cells.miny) * cellsAcross + (x - cells.minx) + 1]++;
+   }
+
+   for(S32 i = 1; i < mStaticCellStarts.size(); i++)
+      mStaticCellStarts[i] += mStaticCellStarts[i - 1];
+
+   // ...then drop each object into place
+   Vector<S32> nextSlot(cellCount);
+   for(S32 i = 0; i < cellCount; i++)
+      nextSlot.push_back(mStaticCellStarts[i]);
+
+   mStaticObjects.resize(mStaticCellStarts.last());
+
+   for(S32 i = 0; i < objects.size(); i++)
+   {
+      const IntRect &bins = objects[i]->mCellRange;
+
+      for(S32 y = bins.miny; y <= bins.maxy; y++)
+         for(S32 x = bins.minx; x <= bins.maxx; x++)
+            mStaticObjects[nextSlot[(y - cells.miny) * cellsAcross + (x - cells.minx)]++] = objects[i];
+
+      objects[i]->mInStaticIndex = true;
+   }
+
+   mOccupiedCells.minx = min(mOccupiedCells.minx, cells.minx);
+   mOccupiedCells.miny = min(mOccupiedCells.miny, cells.miny);
+   mOccupiedCells.maxx = max(mOccupiedCells.maxx, cells.maxx);
+   mOccupiedCells.maxy = max(mOccupiedCells.maxy, cells.maxy);
+}
+
+
+// Our static grid is never rearranged once built, so objects leaving it just leave holes behind.  This should be rare.
+void GridDatabase::removeFromStaticIndex(DatabaseObject *object)
+{
+   const IntRect &bins = object->mCellRange;
+   S32 first, last;
+
+   for(S32 x = bins.minx; x <= bins.maxx; x++)
+      for(S32 y = bins.miny; y <= bins.maxy; y++)
+         if(getStaticCell(x, y, first, last))
+            for(S32 i = first; i < last; i++)
+               if(mStaticObjects[i] == object)
+               {
+                  mStaticObjects[i] = NULL;
+                  break;
+               }
+
+   object->mInStaticIndex = false;
+}
+
+
+// Objects already in the database that isStaticType() says won't move are moved into our static grid; anything added
+// later goes into the regular cells, whatever its type.  Calling this again will rebuild the static grid from scratch.
+void GridDatabase::buildStaticIndex()
+{
+   mUseStaticIndex = true;
+   rebuildCells();
+}
+
+
+// Choose a cell size based on how densely the level is populated, then rebuild our index to use it.  Called once a level
+// has loaded; the index works with any cell size, so this is purely a performance matter.
+void GridDatabase::resizeGrid(const Rect &levelExtents)
+{
+   S32 shift = DefaultCellShift;
+
+   F32 area = levelExtents.getWidth() * levelExtents.getHeight();
+
+   if(mAllObjects.size() > 0 && area > 0)
+   {
+      F32 cellSize = sqrt(area * TargetObjectsPerCell / mAllObjects.size());
+      shift = CLAMP(S32(log(cellSize) / log(2.0f) + 0.5f), (S32)MinCellShift, (S32)MaxCellShift);
+   }
+
+   if(shift == mCellShift)
+      return;
+
+   mCellShift = shift;
+
+   // Size the hash so a level's worth of cells fits without growing
+   S64 cellsAcross = (S64(levelExtents.getWidth())  >> mCellShift) + 1;
+   S64 cellsDown   = (S64(levelExtents.getHeight()) >> mCellShift) + 1;
+   growCellHash(S32(min(cellsAcross * cellsDown * 2, S64(1 << 20))));
+
+   rebuildCells();
+}
+
+
+S32 GridDatabase::getCellSize() const
+{
+   return 1 << mCellShift;
+}
+
+
+// Number of cells that have been allocated in our spatial hash; doesn't include the static grid
+S32 GridDatabase::getCellCount() const
+{
+   return mCells.size();
+}
+
+
+// Listings in the cells of our spatial hash; an object is listed once for every cell it touches.  Moving an object means
+// finding it in the lists of the cells it leaves, so the fewer listings, the cheaper moving is.
+S32 GridDatabase::getCellListingCount() const
+{
+   S32 count = 0;
+
+   for(S32 i = 0; i < mCells.size(); i++)
+      count += mCells[i].objects.size();
+
+   return count;
+}
+
+
+// Number of objects currently held in our static grid
+S32 GridDatabase::getStaticObjectCount() const
+{
+   S32 count = 0;
+
+   for(S32 i = 0; i < mAllObjects.size(); i++)
+      if(mAllObjects[i]->mInStaticIndex)
+         count++;
+
+   return count;
+}
+
+
 void GridDatabase::removeFromDatabase(DatabaseObject *object, bool deleteObject)
 {
    TNLAssert(object->mDatabase == this || object->mDatabase == NULL, "Trying to remove Object from wrong database");
    if(object->mDatabase != this)
       return;
 
-   const Rect &extents = object->mExtent;
+   removeFromCells(object);
    object->mDatabase = NULL;
 
-   static IntRect bins;
-   fillBins(extents, bins);
-
-   while(object->mBucketList)
-   {
-      DatabaseBucketEntry *b = object->mBucketList;
-      TNLAssert(b->theObject == object, "Object mismatch");
-      TNLAssert(b->prevInBucket->nextInBucket == b, "Broken linked list");
-      if(b->nextInBucket)
-         b->nextInBucket->prevInBucket = b->prevInBucket;
-      b->prevInBucket->nextInBucket = b->nextInBucket;
-      object->mBucketList = b->nextInBucketForThisObject;
-      mChunker->free(b);
-   }
+   mFreeSlots.push_back(object->mDatabaseSlot);
+   object->mDatabaseSlot = -1;
 
    // Find and delete object from our non-spatial databases
    for(S32 i = 0; i < mAllObjects.size(); i++)
@@ -242,18 +802,39 @@ void GridDatabase::removeFromDatabase(DatabaseObject *object, bool deleteObject)
          break;
       }
 
+   removeFromTypeList(object);
+   shrinkExtents(object->mExtent);
+
+   if(deleteObject)
+      delete object;      
+}
+
+
+void GridDatabase::setMirroredCircle(const DatabaseObject *object, const Point &center, F32 radius)
+{
+   TNLAssert(object->mDatabase == this, "Object is in another database!");
+
+   const S32 slot = object->mDatabaseSlot;
+
+   mCircleX[slot] = center.x;
+   mCircleY[slot] = center.y;
+   mCircleRadius[slot] = radius;
+}
+
 
-   U8 type = object->getObjectTypeNumber();
+bool GridDatabase::getMirroredCircle(const DatabaseObject *object, Point &center, F32 &radius) const
+{
+   if(object->mDatabase != this)
+      return false;
 
-   if(type == GoalZoneTypeNumber)
-      eraseObject_fast(&mGoalZones, object);
-   else if(type == FlagTypeNumber)
-      eraseObject_fast(&mFlags, object);
-   else if(type == SpyBugTypeNumber)
-      eraseObject_fast(&mSpyBugs, object);
+   const S32 slot = object->mDatabaseSlot;
 
-   if(deleteObject)
-      delete object;      
+   if(mCircleRadius[slot] < 0)
+      return false;
+
+   center.set(mCircleX[slot], mCircleY[slot]);
+   radius = mCircleRadius[slot];
+   return true;
 }
 
 
@@ -273,163 +854,234 @@ const Vector<DatabaseObject *> *GridDatabase::findObjects_fast() const
 }
 
 
-// Faster than above, but results can't be modified, and only works with selected types at the moment
+// Faster than findObjects(), but results can't be modified.  Like findObjects(), this skips objects marked as deleted.
 const Vector<DatabaseObject *> *GridDatabase::findObjects_fast(U8 typeNumber) const
 {
-   if(typeNumber == GoalZoneTypeNumber)
-      return &mGoalZones;
+   return &mObjectsByType[typeNumber];
+}
 
-   if(typeNumber == FlagTypeNumber)
-      return &mFlags;
 
-   if(typeNumber == SpyBugTypeNumber)
-      return &mSpyBugs;
+// Describes which object types a query is looking for, so one search routine can serve every findObjects() flavor
+struct ObjectTypeFilter
+{
+   TestFunc testFunc;
+   const Vector<U8> *types;
+   U8 typeNumber;
 
-   TNLAssert(false, "This type not currently supported!  Sorry dude!");
-   return NULL;  // this line gets rid of compile warning "Not all control paths return a value"
-}
+   explicit ObjectTypeFilter(TestFunc func)           { testFunc = func; types = NULL;       typeNumber = UnknownTypeNumber; }
+   explicit ObjectTypeFilter(const Vector<U8> &list)  { testFunc = NULL; types = &list;      typeNumber = UnknownTypeNumber; }
+   explicit ObjectTypeFilter(U8 type)                 { testFunc = NULL; types = NULL;       typeNumber = type; }
 
+   inline bool matches(U8 objectType) const
+   {
+      if(testFunc)
+         return testFunc(objectType);
 
-void GridDatabase::findObjects(U8 typeNumber, Vector<DatabaseObject *> &fillVector, const Rect *extents, const IntRect *bins) const
-{
-   static Vector<U8> types;
-   types.resize(1);
+      if(types)
+      {
+         for(S32 i = 0; i < types->size(); i++)
+            if(types->get(i) == objectType)
+               return true;
 
-   types[0] = typeNumber;
+         return false;
+      }
 
-   findObjects(types, fillVector, extents, bins);
-}
+      return objectType == typeNumber;
+   }
+};
 
 
-void GridDatabase::findObjects(Vector<U8> typeNumbers, Vector<DatabaseObject *> &fillVector, const Rect *extents, const IntRect *bins) const
+// The one routine that actually searches our cells.  Reads but never writes to the database, so it's safe to run
+// concurrently as long as each thread brings its own query.
+void GridDatabase::findObjects(const ObjectTypeFilter &filter, DatabaseQuery &query, Vector<DatabaseObject *> &fillVector,
+                               const Rect &extents, bool sameQuery) const
 {
-   mQueryId++;    // Used to prevent the same item from being found in multiple buckets
+   query.beginQuery(this, sameQuery);    // query keeps the same item from being found in multiple cells
 
-   for(S32 x = bins->minx; bins->maxx - x >= 0; x++)
-      for(S32 y = bins->miny; bins->maxy - y >= 0; y++)
-         for(DatabaseBucketEntry *walk = mBuckets[x & BucketMask][y & BucketMask].nextInBucket; walk; walk = walk->nextInBucket)
+   IntRect bins;
+   fillBins(extents, bins);
+
+   if(clipToOccupiedCells(bins))
+      for(S32 x = bins.minx; x <= bins.maxx; x++)
+         for(S32 y = bins.miny; y <= bins.maxy; y++)
          {
-            DatabaseObject *theObject = walk->theObject;
+            query.mCellsVisited++;
+
+            const DatabaseCell *cell = getCell(x, y);
+
+            if(cell)
+            {
+               query.mObjectsChecked += cell->objects.size();
+
+               for(S32 i = 0; i < cell->objects.size(); i++)
+               {
+                  DatabaseObject *theObject = cell->objects[i];
+
+                  if(filter.matches(theObject->getObjectTypeNumber()) &&    // Object is of the right type; and
+                     theObject->mExtent.intersects(extents) &&              // overlaps our extents; and
+                     query.markVisited(theObject))                          // hasn't been found already
+                     fillVector.push_back(theObject);                       // So save it as a found item
+               }
+            }
 
-            if(theObject->mLastQueryId != mQueryId &&                         // Object hasn't been queried; and
-               testTypes(typeNumbers, theObject->getObjectTypeNumber()) &&    // is of the right type; and
-               (!extents || theObject->mExtent.intersects(*extents)) )        // overlaps our extents (if passed)
+            S32 first, last;
+            if(getStaticCell(x, y, first, last))
             {
-               walk->theObject->mLastQueryId = mQueryId;    // Flag the object so we know we've already visited it
-               fillVector.push_back(walk->theObject);       // And save it as a found item
+               query.mObjectsChecked += last - first;
+
+               for(S32 i = first; i < last; i++)
+               {
+                  DatabaseObject *theObject = mStaticObjects[i];
+
+                  if(theObject && filter.matches(theObject->getObjectTypeNumber()) &&
+                     theObject->mExtent.intersects(extents) &&
+                     query.markVisited(theObject))
+                     fillVector.push_back(theObject);
+               }
             }
          }
+
+   query.mObjectsChecked += mLargeObjects.size();
+
+   for(S32 i = 0; i < mLargeObjects.size(); i++)
+   {
+      DatabaseObject *theObject = mLargeObjects[i];
+
+      if(filter.matches(theObject->getObjectTypeNumber()) &&
+         theObject->mExtent.intersects(extents) &&
+         query.markVisited(theObject))
+         fillVector.push_back(theObject);
+   }
 }
 
 
 // Find all objects in database of type typeNumber
 void GridDatabase::findObjects(U8 typeNumber, Vector<DatabaseObject *> &fillVector) const
 {
-   // If the user is looking for a type we maintain a list for, it will be faster to use that list than to cycle through the general item list.
-   TNLAssert(typeNumber != GoalZoneTypeNumber && typeNumber != FlagTypeNumber && typeNumber != SpyBugTypeNumber, 
-             "Can use findObjects_fast()?  If not, uncomment the appropriate block below; it will perform better!");
-
-   //if(typeNumber == GoalZoneTypeNumber)
-   //{
-   //   for(S32 i = 0; i < mGoalZones.size(); i++)
-   //      fillVector.push_back(mGoalZones[i]);
-   //   return;
-   //}
-
-   //if(typeNumber == FlagTypeNumber)
-   //{
-   //   for(S32 i = 0; i < mFlags.size(); i++)
-   //      fillVector.push_back(mFlags[i]);
-   //   return;
-   //}
-
-   //if(typeNumber == SpyBugTypeNumber)
-   //{
-   //   for(S32 i = 0; i < mSpyBugs.size(); i++)
-   //      fillVector.push_back(mSpyBugs[i]);
-   //   return;
-   //}
+   S32 first = fillVector.size();
 
-   for(S32 i = 0; i < mAllObjects.size(); i++)
-      if(mAllObjects[i]->getObjectTypeNumber() == typeNumber)
-         fillVector.push_back(mAllObjects[i]);
+   appendObjectsOfType(typeNumber, fillVector);
+
+   if(mTypeListShuffled[typeNumber])
+      sortByListOrder(fillVector, first);
+}
+
+
+// Converts a coordinate to a cell coordinate.  Clamping keeps silly values (like F32_MAX) from overflowing.
+static inline S32 toBin(F32 coord, S32 shift)
+{
+   const F32 MaxCoord = 1.0e9f;
+   return S32(floor(CLAMP(coord, -MaxCoord, MaxCoord))) >> shift;
 }
 
 
 // Translates extents into bins to search
 void GridDatabase::fillBins(const Rect &extents, IntRect &bins) const
 {
-   bins.minx = S32(extents.min.x) >> BucketWidthBitShift;
-   bins.miny = S32(extents.min.y) >> BucketWidthBitShift;
-   bins.maxx = S32(extents.max.x) >> BucketWidthBitShift;
-   bins.maxy = S32(extents.max.y) >> BucketWidthBitShift;
+   bins.minx = toBin(extents.min.x, mCellShift);
+   bins.miny = toBin(extents.min.y, mCellShift);
+   bins.maxx = toBin(extents.max.x, mCellShift);
+   bins.maxy = toBin(extents.max.y, mCellShift);
+}
 
-   if(U32(bins.maxx - bins.minx) >= BucketRowCount)
-      bins.maxx = bins.minx + BucketRowCount - 1;
 
-   if(U32(bins.maxy - bins.miny) >= BucketRowCount)
-      bins.maxy = bins.miny + BucketRowCount - 1;
+// Restrict bins to the area where cells actually exist, so huge query rects don't probe millions of empty cells
+bool GridDatabase::clipToOccupiedCells(IntRect &bins) const
+{
+   bins.minx = max(bins.minx, mOccupiedCells.minx);
+   bins.miny = max(bins.miny, mOccupiedCells.miny);
+   bins.maxx = min(bins.maxx, mOccupiedCells.maxx);
+   bins.maxy = min(bins.maxy, mOccupiedCells.maxy);
+
+   return bins.minx <= bins.maxx && bins.miny <= bins.maxy;
 }
 
 
 // Find all objects in &extents that are of type typeNumber
 void GridDatabase::findObjects(U8 typeNumber, Vector<DatabaseObject *> &fillVector, const Rect &extents) const
 {
-   static IntRect bins;
-   fillBins(extents, bins);
+   findObjects(ObjectTypeFilter(typeNumber), mLegacyQuery, fillVector, extents, false);
+}
 
-   findObjects(typeNumber, fillVector, &extents, &bins);
+
+void GridDatabase::findObjects(DatabaseQuery &query, U8 typeNumber, const Rect &extents) const
+{
+   findObjects(ObjectTypeFilter(typeNumber), query, query.results, extents, false);
 }
 
 
-void GridDatabase::findObjects(TestFunc testFunc, Vector<DatabaseObject *> &fillVector, const Rect *extents, const IntRect *bins, bool sameQuery) const
+S32 QSORT_CALLBACK GridDatabase::listOrderSort(DatabaseObject **a, DatabaseObject **b)
 {
-   TNLAssert(this, "findObjects 'this' is NULL");
-   if(!sameQuery)
-      mQueryId++;    // Used to prevent the same item from being found in multiple buckets
+   return (*a)->mListOrder < (*b)->mListOrder ? -1 : 1;     // Orders are unique, so never equal
+}
 
-   for(S32 x = bins->minx; bins->maxx - x >= 0; x++)
-      for(S32 y = bins->miny; bins->maxy - y >= 0; y++)
-         for(DatabaseBucketEntry *walk = mBuckets[x & BucketMask][y & BucketMask].nextInBucket; walk; walk = walk->nextInBucket)
-         {
-            DatabaseObject *theObject = walk->theObject;
 
-            if(theObject->mLastQueryId != mQueryId &&                      // Object hasn't been queried; and
-               (testFunc(theObject->getObjectTypeNumber())) &&             // is of the right type; and
-               (!extents || theObject->mExtent.intersects(*extents)) )     // overlaps our extents (if passed)
-            {
-               walk->theObject->mLastQueryId = mQueryId;    // Flag the object so we know we've already visited it
-               fillVector.push_back(walk->theObject);       // And save it as a found item
-            }
-         }
+// Objects of several types come out of their type lists one type at a time; this puts the objects from first onward
+// back into mAllObjects order, which is the order these searches have always returned
+void GridDatabase::sortByListOrder(Vector<DatabaseObject *> &objects, S32 first) const
+{
+   if(objects.size() - first >= 2)
+      qsort(&objects[first], objects.size() - first, sizeof(DatabaseObject *), (qsort_compare_func) listOrderSort);
 }
 
 
-// Find all objects in database using derived type test function
+// Find all objects in database using derived type test function -- testFunc only needs to be run once per type
 void GridDatabase::findObjects(TestFunc testFunc, Vector<DatabaseObject *> &fillVector) const
 {
-   for(S32 i = 0; i < mAllObjects.size(); i++)
-      if(testFunc(mAllObjects[i]->getObjectTypeNumber()))
-         fillVector.push_back(mAllObjects[i]);
+   S32 first = fillVector.size();
+   S32 typesFound = 0;
+   bool shuffled = false;
+
+   for(S32 i = 0; i < U8_MAX + 1; i++)
+      if(mObjectsByType[i].size() > 0 && testFunc(U8(i)))
+      {
+         appendObjectsOfType(U8(i), fillVector);
+         typesFound++;
+         shuffled |= mTypeListShuffled[i];
+      }
+
+   if(typesFound > 1 || shuffled)
+      sortByListOrder(fillVector, first);
 }
 
 
 // Find all objects in database using derived type test function
 void GridDatabase::findObjects(const Vector<U8> &types, Vector<DatabaseObject *> &fillVector, const Rect &extents) const
 {
-   static IntRect bins;
-   fillBins(extents, bins);
+   findObjects(ObjectTypeFilter(types), mLegacyQuery, fillVector, extents, false);
+}
 
-   findObjects(types, fillVector, &extents, &bins);
+
+void GridDatabase::findObjects(DatabaseQuery &query, const Vector<U8> &types, const Rect &extents) const
+{
+   findObjects(ObjectTypeFilter(types), query, query.results, extents, false);
 }
 
 
-// Find all objects in database using derived type test function
+// Find all objects in database of any of the listed types
 void GridDatabase::findObjects(const Vector<U8> &types, Vector<DatabaseObject *> &fillVector) const
 {
-   for(S32 i = 0; i < mAllObjects.size(); i++)
-      if(testTypes(types, mAllObjects[i]->getObjectTypeNumber()))
-         fillVector.push_back(mAllObjects[i]);
+   S32 first = fillVector.size();
+   S32 typesFound = 0;
+   bool shuffled = false;
+
+   for(S32 i = 0; i < types.size(); i++)
+   {
+      bool alreadyFound = false;    // In case someone asks for the same type twice
+
+      for(S32 j = 0; j < i && !alreadyFound; j++)
+         alreadyFound = (types[j] == types[i]);
+
+      if(!alreadyFound && mObjectsByType[types[i]].size() > 0)
+      {
+         appendObjectsOfType(types[i], fillVector);
+         typesFound++;
+         shuffled |= mTypeListShuffled[types[i]];
+      }
+   }
+
+   if(typesFound > 1 || shuffled)
+      sortByListOrder(fillVector, first);
 }
 
 
@@ -446,69 +1098,125 @@ bool GridDatabase::testTypes(const Vector<U8> &types, U8 objectType) const
 // Find all objects in &extents derived type test function
 void GridDatabase::findObjects(TestFunc testFunc, Vector<DatabaseObject *> &fillVector, const Rect &extents, bool sameQuery) const
 {
-   static IntRect bins;
-   fillBins(extents, bins);
+   findObjects(ObjectTypeFilter(testFunc), mLegacyQuery, fillVector, extents, sameQuery);
+}
+
 
-   findObjects(testFunc, fillVector, &extents, &bins, sameQuery);
+// Find all objects in &extents derived type test function; pass sameQuery to skip objects found by the previous search
+// made with this query
+void GridDatabase::findObjects(DatabaseQuery &query, TestFunc testFunc, const Rect &extents, bool sameQuery) const
+{
+   findObjects(ObjectTypeFilter(testFunc), query, query.results, extents, sameQuery);
 }
 
 
 void GridDatabase::dumpObjects()
 {
-   for(S32 x = 0; x < BucketRowCount; x++)
-      for(S32 y = 0; y < BucketRowCount; y++)
-         for(DatabaseBucketEntry *walk = mBuckets[x & BucketMask][y & BucketMask].nextInBucket; walk; walk = walk->nextInBucket)
-         {
-            DatabaseObject *theObject = walk->theObject;
-            logprintf("Found object in (%d,%d) with extents %s", x, y, theObject->getExtent().toString().c_str());
-            logprintf("Obj coords: %s", static_cast<BfObject *>(theObject)->getPos().toString().c_str());
-         }
+   for(S32 i = 0; i < mCells.size(); i++)
+      for(S32 j = 0; j < mCells[i].objects.size(); j++)
+      {
+         DatabaseObject *theObject = mCells[i].objects[j];
+         logprintf("Found object in (%d,%d) with extents %s", mCells[i].x, mCells[i].y, theObject->getExtent().toString().c_str());
+         logprintf("Obj coords: %s", static_cast<BfObject *>(theObject)->getPos().toString().c_str());
+      }
+
+   for(S32 i = 0; i < mStaticObjects.size(); i++)
+      if(mStaticObjects[i])
+         logprintf("Found static object with extents %s", mStaticObjects[i]->getExtent().toString().c_str());
+
+   for(S32 i = 0; i < mLargeObjects.size(); i++)
+   {
+      logprintf("Found large object with extents %s", mLargeObjects[i]->getExtent().toString().c_str());
+      logprintf("Obj coords: %s", static_cast<BfObject *>(mLargeObjects[i])->getPos().toString().c_str());
+   }
 }
 
 
-// Get the extents of every object in the database
-Rect GridDatabase::getExtents()
+// Helper for growExtents(); beyond is true if coord lies outside of edge
+static inline void growEdge(F32 coord, F32 &edge, S32 &count, bool beyond)
 {
-   if(mAllObjects.size() == 0)     // No objects ==> no extents!
-      return Rect();
+   if(beyond)
+   {
+      edge = coord;
+      count = 1;
+   }
+   else if(coord == edge)
+      count++;
+}
 
-   Rect rect;
 
-   // Think we can delete from HERE...   inserted this comment 27-Jan-2012  #########################################
+void GridDatabase::growExtents(const Rect &extent)
+{
+   if(mExtentsDirty)    // Will all be worked out when someone asks for our extents
+      return;
 
-   // All this rigamarole is to make world extent correct for levels that do not overlap (0,0)
-   // The problem is that the GameType is treated as an object, and has the extent (0,0), and
-   // a mask of UnknownType.  Fortunately, the GameType tends to be first, so what we do is skip
-   // all objects until we find an UnknownType object, then start creating our extent from there.
-   // We have to assign theRect to an extent object initially to avoid getting the default coords
-   // of (0,0) that are assigned by the constructor.
+   if(mAllObjects.size() == 1)   // Our first object
+   {
+      mExtents = extent;
+      for(S32 i = 0; i < 4; i++)
+         mExtentEdgeCounts[i] = 1;
+      return;
+   }
 
+   growEdge(extent.min.x, mExtents.min.x, mExtentEdgeCounts[0], extent.min.x < mExtents.min.x);
+   growEdge(extent.min.y, mExtents.min.y, mExtentEdgeCounts[1], extent.min.y < mExtents.min.y);
+   growEdge(extent.max.x, mExtents.max.x, mExtentEdgeCounts[2], extent.max.x > mExtents.max.x);
+   growEdge(extent.max.y, mExtents.max.y, mExtentEdgeCounts[3], extent.max.y > mExtents.max.y);
+}
 
-   S32 first = -1;
 
-   // Look for first non-UnknownType object
-   for(S32 i = 0; i < mAllObjects.size() && first == -1; i++)
-      if(mAllObjects[i]->getObjectTypeNumber() != UnknownTypeNumber)
-      {
-         rect = mAllObjects[i]->getExtent();
-         first = i;
-      }
+void GridDatabase::shrinkExtents(const Rect &extent)
+{
+   if(mExtentsDirty)
+      return;
+
+   const F32 coords[4] = { extent.min.x, extent.min.y, extent.max.x, extent.max.y };
+   const F32 edges[4]  = { mExtents.min.x, mExtents.min.y, mExtents.max.x, mExtents.max.y };
+
+   for(S32 i = 0; i < 4; i++)
+      if(coords[i] == edges[i] && --mExtentEdgeCounts[i] == 0)
+         mExtentsDirty = true;      // Nobody left on this edge; we'll have to look at everyone to find the new one
+}
+
+
+void GridDatabase::recomputeExtents()
+{
+   mExtentsDirty = false;
+
+   if(mAllObjects.size() == 0)
+   {
+      mExtents = Rect();
+      return;
+   }
+
+   mExtents = mAllObjects[0]->mExtent;
 
-   TNLAssert(first == 0, "I think this should never happen -- how would an object with UnknownTypeNumber get in the database?? \
-                          if it does, please document it and remove this assert, along withthe rect = line below -Wat");
+   for(S32 i = 1; i < mAllObjects.size(); i++)
+      mExtents.unionRect(mAllObjects[i]->mExtent);
 
-   if(first == -1)      // No suitable objects found, return empty extents
-      return Rect();
+   for(S32 i = 0; i < 4; i++)
+      mExtentEdgeCounts[i] = 0;
 
-   // ...to HERE
+   for(S32 i = 0; i < mAllObjects.size(); i++)
+   {
+      const Rect &extent = mAllObjects[i]->mExtent;
+
+      if(extent.min.x == mExtents.min.x)  mExtentEdgeCounts[0]++;
+      if(extent.min.y == mExtents.min.y)  mExtentEdgeCounts[1]++;
+      if(extent.max.x == mExtents.max.x)  mExtentEdgeCounts[2]++;
+      if(extent.max.y == mExtents.max.y)  mExtentEdgeCounts[3]++;
+   }
+}
 
-   rect = mAllObjects[0]->getExtent();
 
-   // Now start unioning the extents of remaining objects.  Should be all of them.
-   for(S32 i = /*first + */1; i < mAllObjects.size(); i++)
-      rect.unionRect(mAllObjects[i]->getExtent());
+// Get the combined extents of every object in the database.  Usually just returns our running total; cheap enough to
+// call every tick.
+Rect GridDatabase::getExtents()
+{
+   if(mExtentsDirty)
+      recomputeExtents();
 
-   return rect;
+   return mExtents;
 }
 
 
@@ -549,11 +1257,16 @@ DatabaseObject::~DatabaseObject()
 // Code that needs to run for both constructor and copy constructor
 void DatabaseObject::initialize() 
 {
-   mLastQueryId = 0; 
    mExtent = Rect(); 
    mExtentSet = false;
    mDatabase = NULL;
-   mBucketList = NULL;
+   mDatabaseSlot = -1;
+   mCellRange = IntRect();
+   mInLargeObjectList = false;
+   mInStaticIndex = false;
+   mIndexedTypeNumber = UnknownTypeNumber;
+   mTypeListIndex = -1;
+   mListOrder = 0;
 }
 
 
@@ -573,124 +1286,208 @@ DatabaseObject *GridDatabase::findObjectLOS(U8 typeNumber, U32 stateIndex, bool
                                             const Point &rayStart, const Point &rayEnd,
                                             float &collisionTime, Point &surfaceNormal) const
 {
-   Rect queryRect(rayStart, rayEnd);
+   // Use our own query here, most callers expect our global fillVector to be left unchanged
+   return findObjectLOS(ObjectTypeFilter(typeNumber), mLegacyLOSQuery, stateIndex, format, rayStart, rayEnd, collisionTime, surfaceNormal);
+}
 
-   static Vector<DatabaseObject *> fillVector;  // Use local here, Most of code expects a global FillVector left unchanged
-   fillVector.clear();
 
-   findObjects(typeNumber, fillVector, queryRect);
+DatabaseObject *GridDatabase::findObjectLOS(TestFunc testFunc, U32 stateIndex, bool format,
+                                            const Point &rayStart, const Point &rayEnd, 
+                                            float &collisionTime, Point &surfaceNormal) const
+{
+   return findObjectLOS(ObjectTypeFilter(testFunc), mLegacyLOSQuery, stateIndex, format, rayStart, rayEnd, collisionTime, surfaceNormal);
+}
 
-   Point collisionPoint;
 
-   collisionTime = 1;
-   DatabaseObject *retObject = NULL;
+DatabaseObject *GridDatabase::findObjectLOS(TestFunc testFunc, U32 stateIndex,
+                                            const Point &rayStart, const Point &rayEnd,
+                                            float &collisionTime, Point &surfaceNormal) const
+{
+   return findObjectLOS(testFunc, stateIndex, true, rayStart, rayEnd, collisionTime, surfaceNormal);
+}
 
-   Point center;
-   Rect rect;
 
-   for(S32 i = 0; i < fillVector.size(); i++)
+DatabaseObject *GridDatabase::findObjectLOS(DatabaseQuery &query, U8 typeNumber, U32 stateIndex, bool format,
+                                            const Point &rayStart, const Point &rayEnd,
+                                            float &collisionTime, Point &surfaceNormal) const
+{
+   return findObjectLOS(ObjectTypeFilter(typeNumber), query, stateIndex, format, rayStart, rayEnd, collisionTime, surfaceNormal);
+}
+
+
+DatabaseObject *GridDatabase::findObjectLOS(DatabaseQuery &query, TestFunc testFunc, U32 stateIndex, bool format,
+                                            const Point &rayStart, const Point &rayEnd,
+                                            float &collisionTime, Point &surfaceNormal) const
+{
+   return findObjectLOS(ObjectTypeFilter(testFunc), query, stateIndex, format, rayStart, rayEnd, collisionTime, surfaceNormal);
+}
+
+
+// Batched version of findObjectLOS() -- resolves every ray in rays, filling in the results of each
+void GridDatabase::findObjectsLOS(DatabaseQuery &query, TestFunc testFunc, U32 stateIndex, bool format, Vector<LOSRay> &rays) const
+{
+   ObjectTypeFilter filter(testFunc);
+
+   for(S32 i = 0; i < rays.size(); i++)
    {
-      if(!fillVector[i]->isCollisionEnabled())     // Skip collision-disabled objects
-         continue;
+      LOSRay &ray = rays[i];
+      ray.hitObject = findObjectLOS(filter, query, stateIndex, format, ray.start, ray.end, ray.collisionTime, ray.surfaceNormal);
+   }
+}
 
-      const Vector<Point> *poly = fillVector[i]->getCollisionPoly();
 
-      F32 radius, ct;
+// Check a single object against a ray; returns true, and updates collisionTime and surfaceNormal, if the object is hit
+// before collisionTime.  Circle normals are not normalized.
+static bool testObjectLOS(const DatabaseObject *object, U32 stateIndex, bool format, const Point &rayStart, const Point &rayEnd,
+                          F32 &collisionTime, Point &surfaceNormal)
+{
+   if(!object->isCollisionEnabled())     // Skip collision-disabled objects
+      return false;
 
-      if(poly)
-      {
-         if(poly->size() == 0)    // This can happen in the editor when a wall segment is completely hidden by another
-            continue;
+   const Vector<Point> *poly = object->getCollisionPoly();
 
-         Point normal;
-         if(polygonIntersectsSegmentDetailed(&poly->first(), poly->size(), format, rayStart, rayEnd, ct, normal))
-         {
-            if(ct < collisionTime)
-            {
-               collisionTime = ct;
-               retObject = fillVector[i];
-               surfaceNormal = normal;
-            }
-         }
-      }
-      else if(fillVector[i]->getCollisionCircle(stateIndex, center, radius))
+   F32 ct;
+
+   if(poly)
+   {
+      if(poly->size() == 0)    // This can happen in the editor when a wall segment is completely hidden by another
+         return false;
+
+      Point normal;
+      if(polygonIntersectsSegmentDetailed(&poly->first(), poly->size(), format, rayStart, rayEnd, ct, normal) && ct < collisionTime)
       {
-         if(circleIntersectsSegment(center, radius, rayStart, rayEnd, ct) && ct < collisionTime)
-         {
-            collisionTime = ct;
-            surfaceNormal = (rayStart + (rayEnd - rayStart) * ct) - center;
-            retObject = fillVector[i];
-         }
+         collisionTime = ct;
+         surfaceNormal = normal;
+         return true;
       }
+
+      return false;
    }
 
-   if(retObject)
-      surfaceNormal.normalize();
+   Point center;
+   F32 radius;
 
-   return retObject;
+   if(object->getCollisionCircle(stateIndex, center, radius))
+   {
+      if(circleIntersectsSegment(center, radius, rayStart, rayEnd, ct) && ct < collisionTime)
+      {
+         collisionTime = ct;
+         surfaceNormal = (rayStart + (rayEnd - rayStart) * ct) - center;
+         return true;
+      }
+   }
+
+   return false;
 }
 
 
-DatabaseObject *GridDatabase::findObjectLOS(TestFunc testFunc, U32 stateIndex, bool format,
-                                            const Point &rayStart, const Point &rayEnd, 
+// Does the real work for all the findObjectLOS() variants.  Rather than gathering everything in the ray's bounding box,
+// we walk the cells the ray passes through in order (a DDA walk), and stop as soon as we have a hit that lies within the
+// cell we're in, since nothing in a later cell can be hit any sooner.
+DatabaseObject *GridDatabase::findObjectLOS(const ObjectTypeFilter &filter, DatabaseQuery &query, U32 stateIndex, bool format,
+                                            const Point &rayStart, const Point &rayEnd,
                                             float &collisionTime, Point &surfaceNormal) const
 {
-   Rect queryRect(rayStart, rayEnd);
-
-   static Vector<DatabaseObject *> fillVector;  // Use local here, most callers expect our global fillVector to be left unchanged
-   fillVector.clear();
-
-   findObjects(testFunc, fillVector, queryRect);
-
-   Point collisionPoint;
+   query.beginQuery(this, false);
 
    collisionTime = 1;
    DatabaseObject *retObject = NULL;
 
-   Point center;
-   Rect rect;
+   // Large objects aren't in any cell, so check them up front
+   query.mObjectsChecked += mLargeObjects.size();
+
+   for(S32 i = 0; i < mLargeObjects.size(); i++)
+      if(filter.matches(mLargeObjects[i]->getObjectTypeNumber()) &&
+         testObjectLOS(mLargeObjects[i], stateIndex, format, rayStart, rayEnd, collisionTime, surfaceNormal))
+         retObject = mLargeObjects[i];
 
-   for(S32 i = 0; i < fillVector.size(); i++)
+   // Clip the ray to the area covered by our cells, so we don't walk through miles of nothing
+   F32 tEnter, tExit;
+   if(clipRayToOccupiedCells(rayStart, rayEnd, tEnter, tExit))
    {
-      if(!fillVector[i]->isCollisionEnabled())     // Skip collision-disabled objects
-         continue;
+      const F32 cellSize = F32(1 << mCellShift);
+      const Point dir = rayEnd - rayStart;
+      const Point entry = rayStart + dir * tEnter;
+
+      S32 x = toBin(entry.x, mCellShift);
+      S32 y = toBin(entry.y, mCellShift);
+
+      const S32 stepX = dir.x > 0 ? 1 : (dir.x < 0 ? -1 : 0);
+      const S32 stepY = dir.y > 0 ? 1 : (dir.y < 0 ? -1 : 0);
+
+      // Ray parameter at which we cross the next vertical/horizontal cell boundary, and how far apart those crossings are
+      F32 tMaxX = F32_MAX, tDeltaX = F32_MAX;
+      F32 tMaxY = F32_MAX, tDeltaY = F32_MAX;
 
-      const Vector<Point> *poly = fillVector[i]->getCollisionPoly();
+      if(stepX != 0)
+      {
+         tMaxX   = ((stepX > 0 ? x + 1 : x) * cellSize - rayStart.x) / dir.x;
+         tDeltaX = cellSize / fabs(dir.x);
+      }
+
+      if(stepY != 0)
+      {
+         tMaxY   = ((stepY > 0 ? y + 1 : y) * cellSize - rayStart.y) / dir.y;
+         tDeltaY = cellSize / fabs(dir.y);
+      }
 
-      F32 radius;
-      float ct;
+      // Safety net against floating point mischief: we can never need more steps than this
+      const Point exit = rayStart + dir * tExit;
+      S32 stepsLeft = abs(toBin(exit.x, mCellShift) - x) + abs(toBin(exit.y, mCellShift) - y) + 2;
 
-      if(poly)
+      while(stepsLeft-- > 0)
       {
-         if(poly->size() == 0)    // This can happen in the editor when a wall segment is completely hidden by another
-            continue;
+         query.mCellsVisited++;
+
+         const DatabaseCell *cell = getCell(x, y);
 
-         Point normal;
-         if(polygonIntersectsSegmentDetailed(&poly->get(0), poly->size(), format, rayStart, rayEnd, ct, normal))
+         if(cell)
          {
-            if(ct < collisionTime)
+            query.mObjectsChecked += cell->objects.size();
+
+            for(S32 i = 0; i < cell->objects.size(); i++)
             {
-               collisionTime = ct;
-               retObject = fillVector[i];
-               surfaceNormal = normal;
+               DatabaseObject *theObject = cell->objects[i];
+
+               if(filter.matches(theObject->getObjectTypeNumber()) && query.markVisited(theObject) &&
+                  testObjectLOS(theObject, stateIndex, format, rayStart, rayEnd, collisionTime, surfaceNormal))
+                  retObject = theObject;
             }
          }
-      }
-      else if(fillVector[i]->getCollisionCircle(stateIndex, center, radius))
-      {
-         if(circleIntersectsSegment(center, radius, rayStart, rayEnd, ct))
+
+         S32 first, last;
+         if(getStaticCell(x, y, first, last))
          {
-            if(ct < collisionTime)
+            query.mObjectsChecked += last - first;
+
+            for(S32 i = first; i < last; i++)
             {
-               collisionTime = ct;
-               surfaceNormal = (rayStart + (rayEnd - rayStart) * ct) - center;
-               retObject = fillVector[i];
+               DatabaseObject *theObject = mStaticObjects[i];
+
+               if(theObject && filter.matches(theObject->getObjectTypeNumber()) && query.markVisited(theObject) &&
+                  testObjectLOS(theObject, stateIndex, format, rayStart, rayEnd, collisionTime, surfaceNormal))
+                  retObject = theObject;
             }
          }
+
+         F32 tNext = min(tMaxX, tMaxY);
+
+         if(tNext > tExit || collisionTime <= tNext)     // Ray ends in this cell, or we hit something before leaving it
+            break;
+
+         if(tMaxX < tMaxY)
+         {
+            x += stepX;
+            tMaxX += tDeltaX;
+         }
+         else
+         {
+            y += stepY;
+            tMaxY += tDeltaY;
+         }
       }
    }
 
-
    if(retObject)
       surfaceNormal.normalize();
 
@@ -698,11 +1495,42 @@ DatabaseObject *GridDatabase::findObjectLOS(TestFunc testFunc, U32 stateIndex, b
 }
 
 
-DatabaseObject *GridDatabase::findObjectLOS(TestFunc testFunc, U32 stateIndex,
-                                            const Point &rayStart, const Point &rayEnd,
-                                            float &collisionTime, Point &surfaceNormal) const
+// Find the portion of the segment from rayStart to rayEnd (as ray parameters from 0 to 1) that passes through our cells
+bool GridDatabase::clipRayToOccupiedCells(const Point &rayStart, const Point &rayEnd, F32 &tEnter, F32 &tExit) const
 {
-   return findObjectLOS(testFunc, stateIndex, true, rayStart, rayEnd, collisionTime, surfaceNormal);
+   if(mOccupiedCells.minx > mOccupiedCells.maxx)    // No cells at all
+      return false;
+
+   const F32 cellSize = F32(1 << mCellShift);
+
+   const F32 lo[2]    = { mOccupiedCells.minx * cellSize, mOccupiedCells.miny * cellSize };
+   const F32 hi[2]    = { (mOccupiedCells.maxx + 1) * cellSize, (mOccupiedCells.maxy + 1) * cellSize };
+   const F32 start[2] = { rayStart.x, rayStart.y };
+   const F32 dir[2]   = { rayEnd.x - rayStart.x, rayEnd.y - rayStart.y };
+
+   tEnter = 0;
+   tExit = 1;
+
+   for(S32 i = 0; i < 2; i++)
+   {
+      if(dir[i] == 0)
+      {
+         if(start[i] < lo[i] || start[i] > hi[i])
+            return false;
+         continue;
+      }
+
+      F32 t1 = (lo[i] - start[i]) / dir[i];
+      F32 t2 = (hi[i] - start[i]) / dir[i];
+
+      if(t1 > t2)
+         swap(t1, t2);
+
+      tEnter = max(tEnter, t1);
+      tExit  = min(tExit, t2);
+   }
+
+   return tEnter <= tExit;
 }
 
 
@@ -715,6 +1543,15 @@ bool GridDatabase::pointCanSeePoint(const Point &point1, const Point &point2)
 }
 
 
+bool GridDatabase::pointCanSeePoint(DatabaseQuery &query, const Point &point1, const Point &point2) const
+{
+   F32 time;
+   Point coll;
+
+   return( findObjectLOS(query, (TestFunc)isWallType, ActualState, true, point1, point2, time, coll) == NULL );
+}
+
+
 void GridDatabase::computeSelectionMinMax(Point &min, Point &max)
 {
    min.set( F32_MAX,  F32_MAX);
@@ -746,39 +1583,32 @@ S32 GridDatabase::getObjectCount() const
 }
 
 
-// Return count of objects of specified type.  Only supports certain types at the moment.
+// Return count of objects of specified type, not counting any marked as deleted
 S32 GridDatabase::getObjectCount(U8 typeNumber) const
 {
-   if(typeNumber == GoalZoneTypeNumber)
-      return mGoalZones.size();
-
-   if(typeNumber == FlagTypeNumber)
-      return mFlags.size();
-
-   if(typeNumber == SpyBugTypeNumber)
-      return mSpyBugs.size();
-
-   TNLAssert(false, "Unsupported type!");
-   return 0;
+   return mObjectsByType[typeNumber].size();
 }
 
 
 bool GridDatabase::hasObjectOfType(U8 typeNumber) const
 {
-   if(typeNumber == GoalZoneTypeNumber)
-      return mGoalZones.size() > 0;
+   return mObjectsByType[typeNumber].size() > 0;
+}
 
-   if(typeNumber == FlagTypeNumber)
-      return mFlags.size() > 0;
 
-   if(typeNumber == SpyBugTypeNumber)
-      return mSpyBugs.size() > 0;
+// Goes up every time an object of the given type is added or removed, or reshaped by onTypeGeomChanged(), so anyone
+// keeping their own index of some type of object can tell when it needs rebuilding.  Plain extent updates don't count;
+// objects that move every tick would otherwise force a rebuild every tick.
+U32 GridDatabase::getTypeChangeCount(U8 typeNumber) const
+{
+   return mTypeChangeCounts[typeNumber];
+}
 
-   for(S32 i = 0; i < mAllObjects.size(); i++)
-      if(mAllObjects[i]->getObjectTypeNumber() == typeNumber)
-         return true;
 
-   return false;
+// Called by objects whose geometry others keep an index of, when that geometry really changes
+void GridDatabase::onTypeGeomChanged(U8 typeNumber)
+{
+   mTypeChangeCounts[typeNumber]++;
 }
 
 
@@ -885,70 +1715,9 @@ void DatabaseObject::setExtent(const Rect &extents)
 
    GridDatabase *gridDB = getDatabase();
 
+   // Move to the right cells, but don't touch gridDB->mAllObjects
    if(gridDB)
-   {
-      // Remove from the extents database for current extents...
-      //gridDB->removeFromDatabase(this, mExtent);    // old extent
-      // ...and re-add for the new extent
-      //gridDB->addToDatabase(this, extents);
-
-
-      S32 minxold, minyold, maxxold, maxyold;
-      S32 minx, miny, maxx, maxy;
-
-      minxold = S32(mExtent.min.x) >> GridDatabase::BucketWidthBitShift;
-      minyold = S32(mExtent.min.y) >> GridDatabase::BucketWidthBitShift;
-      maxxold = S32(mExtent.max.x) >> GridDatabase::BucketWidthBitShift;
-      maxyold = S32(mExtent.max.y) >> GridDatabase::BucketWidthBitShift;
-
-      minx    = S32(extents.min.x) >> GridDatabase::BucketWidthBitShift;
-      miny    = S32(extents.min.y) >> GridDatabase::BucketWidthBitShift;
-      maxx    = S32(extents.max.x) >> GridDatabase::BucketWidthBitShift;
-      maxy    = S32(extents.max.y) >> GridDatabase::BucketWidthBitShift;
-
-      // Don't do anything if the buckets haven't changed...
-      if((minxold - minx) | (minyold - miny) | (maxxold - maxx) | (maxyold - maxy))
-      {
-         // They are different... remove and readd to database, but don't touch gridDB->mAllObjects
-         if(U32(maxx - minx) >= gridDB->BucketRowCount)        maxx    = minx    + gridDB->BucketRowCount - 1;
-         if(U32(maxy - miny) >= gridDB->BucketRowCount)        maxy    = miny    + gridDB->BucketRowCount - 1;
-         if(U32(maxxold >= minxold) + gridDB->BucketRowCount)  maxxold = minxold + gridDB->BucketRowCount - 1;
-         if(U32(maxyold >= minyold) + gridDB->BucketRowCount)  maxyold = minyold + gridDB->BucketRowCount - 1;
-
-
-         // Don't use x <= maxx, it will endless loop if maxx = S32_MAX and x overflows
-         // Instead, use maxx - x >= 0, it will better handle overflows and avoid endless loop (MIN_S32 - MAX_S32 = +1)
-
-         // Remove from the extents database for current extents...
-         while(mBucketList)
-         {
-            DatabaseBucketEntry *b = mBucketList;
-            TNLAssert(b->theObject == this, "Object mismatch");
-            TNLAssert(b->prevInBucket->nextInBucket == b, "Broken linked list");
-            if(b->nextInBucket)
-               b->nextInBucket->prevInBucket = b->prevInBucket;
-            b->prevInBucket->nextInBucket = b->nextInBucket;
-            mBucketList = b->nextInBucketForThisObject;
-            gridDB->mChunker->free(b);
-         }
-
-         // ...and re-add for the new extent
-         for(S32 x = minx; maxx - x >= 0; x++)
-            for(S32 y = miny; maxy - y >= 0; y++)
-            {
-               DatabaseBucketEntry *be = gridDB->mChunker->alloc();
-               DatabaseBucketEntryBase *base = &gridDB->mBuckets[x & gridDB->BucketMask][y & gridDB->BucketMask];
-               be->theObject = this;
-               if(base->nextInBucket)
-                  base->nextInBucket->prevInBucket = be;
-               be->nextInBucket = base->nextInBucket;
-               be->prevInBucket = base;
-               base->nextInBucket = be;
-               be->nextInBucketForThisObject = mBucketList;
-               mBucketList = be;
-            }
-      }
-   }
+      gridDB->updateCells(this, extents);
 
    mExtent.set(extents);
    mExtentSet = true;
@@ -9,7 +9,6 @@
 #include "GeomObject.h"    // Base class
 
 #include "tnlTypes.h"
-#include "tnlDataChunker.h"
 #include "tnlVector.h"
 
 #include "Rect.h"
@@ -25,18 +24,14 @@ typedef bool (*TestFunc)(U8);
 // Interface for dealing with objects that can be in our spatial database.
 class GridDatabase;
 class EditorObjectDatabase;
-struct DatabaseBucketEntry;
 class DatabaseObject;
+struct ObjectTypeFilter;
 
-struct DatabaseBucketEntryBase
+// One cell of a GridDatabase's spatial hash
+struct DatabaseCell
 {
-   DatabaseBucketEntry *nextInBucket;
-};
-struct DatabaseBucketEntry : public DatabaseBucketEntryBase
-{
-   DatabaseObject *theObject;
-   DatabaseBucketEntryBase *prevInBucket;
-   DatabaseBucketEntry *nextInBucketForThisObject;
+   S32 x, y;                           // Grid coordinates of this cell
+   Vector<DatabaseObject *> objects;   // Every object whose extent overlaps this cell
 };
 
 
@@ -47,14 +42,20 @@ class DatabaseObject : public GeomObject
 
    friend class GridDatabase;
    friend class EditorObjectDatabase;
+   friend class DatabaseQuery;
 
 
 private:
-   U32 mLastQueryId;
    Rect mExtent;
    bool mExtentSet;     // A flag to mark whether extent has been set on this object
    GridDatabase *mDatabase;
-   DatabaseBucketEntry *mBucketList;
+   S32 mDatabaseSlot;            // Index identifying this object within mDatabase, used by DatabaseQuery to track visits
+   IntRect mCellRange;           // Cells of mDatabase this object is listed in
+   bool mInLargeObjectList;      // True if object is too big to list cell-by-cell, see GridDatabase::mLargeObjects
+   bool mInStaticIndex;          // True if object is listed in mDatabase's static grid rather than its regular cells
+   U8 mIndexedTypeNumber;        // Type the object was filed under in mDatabase, which can differ from its current type
+   S32 mTypeListIndex;           // Position in mDatabase's list of objects of type mIndexedTypeNumber, -1 once marked as deleted
+   U32 mListOrder;               // Sorts objects of different types the way mDatabase->mAllObjects has them
 
 protected:
    U8 mObjectTypeNumber;
@@ -97,45 +98,162 @@ public:
 ////////////////////////////////////////
 ////////////////////////////////////////
 
+// Holds everything a spatial query needs to keep track of: the objects found and which objects have already been
+// visited.  Queries made with a DatabaseQuery do not modify the database, so any number of threads can search the
+// same database at once, each with its own DatabaseQuery, as long as nobody is adding, removing or moving objects.
+// Reuse these where possible; they hang on to their memory between queries.
+class DatabaseQuery
+{
+   friend class GridDatabase;
+
+private:
+   Vector<U32> mVisitStamps;     // Indexed by database slot; object was already found this query if stamp == mQueryId
+   U32 mQueryId;
+   const GridDatabase *mDatabase;
+
+   // How much searching has been done with this query since resetCounts(), so tests can check how well the index works
+   U32 mCellsVisited;
+   U32 mObjectsChecked;          // Listings looked at in the cells visited, plus any large objects
+
+   void beginQuery(const GridDatabase *database, bool sameQuery);
+   bool markVisited(const DatabaseObject *object);     // Returns false if object was already found this query
+
+public:
+   DatabaseQuery();     // Constructor
+
+   Vector<DatabaseObject *> results;      // Found objects get appended here; clear it between queries as needed
+
+   void resetCounts();
+   U32 getCellsVisited() const;
+   U32 getObjectsChecked() const;
+};
+
+
+////////////////////////////////////////
+////////////////////////////////////////
+
+// One ray for GridDatabase::findObjectsLOS(); start and end are inputs, the rest are filled in with the results
+struct LOSRay
+{
+   Point start;
+   Point end;
+
+   DatabaseObject *hitObject;    // NULL if nothing was hit
+   F32 collisionTime;            // Fraction of the way from start to end where the hit happened
+   Point surfaceNormal;
+};
+
+
 class WallSegmentManager;
 class GoalZone;
 
 class GridDatabase
 {
+   friend class DatabaseObject;
+   friend class DatabaseQuery;
+
 private:
    U32 mDatabaseId;
-   static U32 mQueryId;
-   static U32 mCountGridDatabase;      // Reference counter for destruction of mChunker
+
+   // Objects get a slot when they are added, which DatabaseQuery uses to mark them as visited
+   S32 mSlotCount;
+   Vector<S32> mFreeSlots;
+
+   // Legacy query methods that don't take a DatabaseQuery share these, and are therefore not thread-safe
+   mutable DatabaseQuery mLegacyQuery;
+   mutable DatabaseQuery mLegacyLOSQuery;
 
    WallSegmentManager *mWallSegmentManager;
 
-   Vector<DatabaseObject *> mAllObjects;
-   Vector<DatabaseObject *> mGoalZones;
-   Vector<DatabaseObject *> mFlags;
-   Vector<DatabaseObject *> mSpyBugs;
+   // Our spatial index is a sparse hash of square cells.  Only cells that have held something are stored, so
+   // levels of any size can be indexed without two distant cells sharing a list.
+   S32 mCellShift;                           // Width/height of each cell in pixels, in a form of 2 ^ n
+   Vector<DatabaseCell> mCells;
+   Vector<S32> mCellHash;                    // Open addressed table of indices into mCells; size is a power of 2, -1 is empty
+   IntRect mOccupiedCells;                   // Bounds of all cells in mCells, used to clip queries with outlandish extents
+   Vector<DatabaseObject *> mLargeObjects;   // Objects that span too many cells to be worth listing in each one
+
+   // Objects that don't move once a level is loaded (walls, zones, turrets, etc.) can be packed into a separate, read-only
+   // grid by buildStaticIndex().  The objects of static cell i are mStaticObjects[mStaticCellStarts[i]] up to
+   // mStaticCellStarts[i + 1], so the cells above only hold movers, and shuffling those around never involves the walls.
+   bool mUseStaticIndex;
+   IntRect mStaticCells;                     // Cells covered by the static grid
+   Vector<S32> mStaticCellStarts;
+   Vector<DatabaseObject *> mStaticObjects;  // Objects that leave the static index are replaced by NULLs
 
-   void findObjects(U8 typeNumber, Vector<DatabaseObject *> &fillVector, const Rect *extents, const IntRect *bins) const;
-   void findObjects(Vector<U8> typeNumbers, Vector<DatabaseObject *> &fillVector, const Rect *extents, const IntRect *bins) const;
-   void findObjects(TestFunc testFunc, Vector<DatabaseObject *> &fillVector, const Rect *extents, const IntRect *bins, bool sameQuery = false) const;
+   Vector<DatabaseObject *> mAllObjects;
+   Vector<DatabaseObject *> mObjectsByType[U8_MAX + 1];   // Every object not marked as deleted, filed by type number
+   bool mTypeListShuffled[U8_MAX + 1];                    // Removals have left the list out of mAllObjects order
+   U32 mNextListOrder;                                    // See DatabaseObject::mListOrder
+   U32 mTypeChangeCounts[U8_MAX + 1];                     // See getTypeChangeCount()
+
+   // Collision circles of objects that move, indexed by database slot, so collision checks can run through lots of them
+   // without a virtual call apiece.  Only objects that opt in are mirrored here; see setMirroredCircle().  A negative
+   // radius means we don't have a copy of that slot's circle.
+   Vector<F32> mCircleX;
+   Vector<F32> mCircleY;
+   Vector<F32> mCircleRadius;
+
+   // Combined extents of all our objects, kept current as objects are added, moved and removed.  We count how many objects
+   // touch each edge (min x, min y, max x, max y), and only have to recompute when the last one moves inward or goes away.
+   Rect mExtents;
+   S32 mExtentEdgeCounts[4];
+   bool mExtentsDirty;
+
+   void growExtents(const Rect &extent);      // Account for an object arriving at extent
+   void shrinkExtents(const Rect &extent);    // Account for an object leaving extent
+   void recomputeExtents();
+
+   void addToTypeList(DatabaseObject *object);
+   void removeFromTypeList(DatabaseObject *object);
+   void rebuildTypeLists();
+   void appendObjectsOfType(U8 typeNumber, Vector<DatabaseObject *> &fillVector) const;
+   void sortByListOrder(Vector<DatabaseObject *> &objects, S32 first) const;
+   static S32 QSORT_CALLBACK listOrderSort(DatabaseObject **a, DatabaseObject **b);
+
+   void findObjects(const ObjectTypeFilter &filter, DatabaseQuery &query, Vector<DatabaseObject *> &fillVector,
+                    const Rect &extents, bool sameQuery) const;
+   DatabaseObject *findObjectLOS(const ObjectTypeFilter &filter, DatabaseQuery &query, U32 stateIndex, bool format,
+                                 const Point &rayStart, const Point &rayEnd, float &collisionTime, Point &surfaceNormal) const;
 
    void fillBins(const Rect &extents, IntRect &bins) const;    // Helper function -- translates extents into bins to search
+   bool clipToOccupiedCells(IntRect &bins) const;              // Returns false if nothing is left to search
+   bool clipRayToOccupiedCells(const Point &rayStart, const Point &rayEnd, F32 &tEnter, F32 &tExit) const;
+
+   const DatabaseCell *getCell(S32 x, S32 y) const;            // Returns NULL if cell has never been used
+   DatabaseCell *findOrCreateCell(S32 x, S32 y);
+   S32 findCellIndex(S32 x, S32 y) const;
+   void growCellHash(S32 minSize);
+   bool getStaticCell(S32 x, S32 y, S32 &first, S32 &last) const;   // Returns false if static grid doesn't cover (x,y)
+
+   void addToCells(DatabaseObject *object, const IntRect &bins);
+   void removeFromCells(DatabaseObject *object);
+   void updateCells(DatabaseObject *object, const Rect &newExtent);
+   void clearCells();
+   void rebuildCells();
+   void packStaticObjects(const Vector<DatabaseObject *> &objects);
+   void removeFromStaticIndex(DatabaseObject *object);
 
 public:
    enum {
-      BucketRowCount = 16,    // Number of buckets per grid row, and number of rows; should be power of 2
-      BucketMask = BucketRowCount - 1,
+      DefaultCellShift = 8,         // 256 pixel cells until resizeGrid() tells us more about the level
+      MinCellShift = 7,
+      MaxCellShift = 11,
+      TargetObjectsPerCell = 4,     // Used by resizeGrid() to pick a cell size from object density
+      MaxCellsPerObject = 64,       // Objects covering more cells than this go into mLargeObjects
+      MaxStaticCells = 1 << 20,     // Static objects scattered over more cells than this are indexed like everything else
    };
 
-   static ClassChunker<DatabaseBucketEntry> *mChunker;
-
-   DatabaseBucketEntryBase mBuckets[BucketRowCount][BucketRowCount];
-
    explicit GridDatabase(bool createWallSegmentManager = true);   // Constructor
    // GridDatabase::GridDatabase(const GridDatabase &source);
    virtual ~GridDatabase();                                       // Destructor
 
-
-   static const S32 BucketWidthBitShift = 8;    // Width/height of each bucket in pixels, in a form of 2 ^ n, 8 is 256 pixels
+   void resizeGrid(const Rect &levelExtents);    // Pick a cell size suited to the level and rebuild the index with it
+   void buildStaticIndex();                      // Move objects that won't be moving into our static grid; call once a level has loaded
+   S32 getCellSize() const;
+   S32 getCellCount() const;
+   S32 getCellListingCount() const;
+   S32 getStaticObjectCount() const;
 
    DatabaseObject *findObjectLOS(U8 typeNumber, U32 stateIndex, bool format, const Point &rayStart, const Point &rayEnd,
                                  float &collisionTime, Point &surfaceNormal) const;
@@ -146,12 +264,22 @@ public:
    DatabaseObject *findObjectLOS(TestFunc testFunc, U32 stateIndex, const Point &rayStart, const Point &rayEnd,
                                  float &collisionTime, Point &surfaceNormal) const;
 
+   // Reentrant versions of the above; safe to call from several threads at once with a DatabaseQuery each
+   DatabaseObject *findObjectLOS(DatabaseQuery &query, U8 typeNumber, U32 stateIndex, bool format, const Point &rayStart,
+                                 const Point &rayEnd, float &collisionTime, Point &surfaceNormal) const;
+   DatabaseObject *findObjectLOS(DatabaseQuery &query, TestFunc testFunc, U32 stateIndex, bool format, const Point &rayStart,
+                                 const Point &rayEnd, float &collisionTime, Point &surfaceNormal) const;
+
+   // Resolve many rays in one call; handy for things like checking a turret's line of sight to every potential target
+   void findObjectsLOS(DatabaseQuery &query, TestFunc testFunc, U32 stateIndex, bool format, Vector<LOSRay> &rays) const;
+
    bool pointCanSeePoint(const Point &point1, const Point &point2);
+   bool pointCanSeePoint(DatabaseQuery &query, const Point &point1, const Point &point2) const;
    void computeSelectionMinMax(Point &min, Point &max);
 
    void findObjects(Vector<DatabaseObject *> &fillVector) const;     // Returns all objects in the database
    const Vector<DatabaseObject *> *findObjects_fast() const;         // Faster than above, but results can't be modified
-   const Vector<DatabaseObject *> *findObjects_fast(U8 typeNumber) const;   // Currently only works with goalZones, may be expanded in the future
+   const Vector<DatabaseObject *> *findObjects_fast(U8 typeNumber) const;   // Objects of a type not marked as deleted, in no particular order
 
    void findObjects(U8 typeNumber, Vector<DatabaseObject *> &fillVector) const;
    void findObjects(U8 typeNumber, Vector<DatabaseObject *> &fillVector, const Rect &extents) const;
@@ -162,6 +290,11 @@ public:
    void findObjects(const Vector<U8> &types, Vector<DatabaseObject *> &fillVector) const;
    void findObjects(const Vector<U8> &types, Vector<DatabaseObject *> &fillVector, const Rect &extents) const;
 
+   // Reentrant spatial queries -- results are appended to query.results
+   void findObjects(DatabaseQuery &query, U8 typeNumber, const Rect &extents) const;
+   void findObjects(DatabaseQuery &query, TestFunc testFunc, const Rect &extents, bool sameQuery = false) const;
+   void findObjects(DatabaseQuery &query, const Vector<U8> &types, const Rect &extents) const;
+
    void copyObjects(const GridDatabase *source);
 
 
@@ -181,10 +314,17 @@ public:
 
    virtual void removeFromDatabase(DatabaseObject *theObject, bool deleteObject);
    virtual void removeEverythingFromDatabase();
+   void onObjectDeleted(DatabaseObject *object);        // Object has been marked as deleted, so type searches should stop finding it
+
+   // Objects that keep a copy of their ActualState collision circle here must update it every time the circle changes
+   void setMirroredCircle(const DatabaseObject *object, const Point &center, F32 radius);
+   bool getMirroredCircle(const DatabaseObject *object, Point &center, F32 &radius) const;   // False if there's no copy
 
    S32 getObjectCount() const;                          // Return the number of objects currently in the database
    S32 getObjectCount(U8 typeNumber) const;             // Return the number of objects currently in the database of specified type
    bool hasObjectOfType(U8 typeNumber) const;
+   U32 getTypeChangeCount(U8 typeNumber) const;
+   void onTypeGeomChanged(U8 typeNumber);
    DatabaseObject *getObjectByIndex(S32 index) const;   // Kind of hacky, kind of useful
 };
 
@@ -192,7 +332,7 @@ public:
 };
 
 
-// Reusable container for searching gridDatabases
+// Reusable container for searching gridDatabases -- shared by everyone, so only use it from the main thread; see DatabaseQuery
 // putting it outside of Zap namespace seems to help with visual C++ debugging showing whats inside fillVector  (debugger forgets to add Zap::)
 extern Vector<Zap::DatabaseObject *> fillVector;
 extern Vector<Zap::DatabaseObject *> fillVector2;
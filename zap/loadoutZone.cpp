@@ -26,7 +26,7 @@ TNL_IMPLEMENT_NETOBJECT(LoadoutZone);
 // Combined Lua / C++ constructor
 LoadoutZone::LoadoutZone(lua_State *L)    
 {
-   mNetFlags.set(Ghostable);
+   mNetFlags.set(Ghostable | SharedUpdates);
    mObjectTypeNumber = LoadoutZoneTypeNumber;
    setTeam(TEAM_NEUTRAL); 
 
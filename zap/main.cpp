@@ -124,6 +124,8 @@ using namespace TNL;
 #include "BotNavMeshZone.h"
 #include "ship.h"
 #include "LevelSource.h"
+#include "TickScheduler.h"
+#include "gameNetInterface.h"
 
 #include <math.h>
 #include <stdarg.h>
@@ -321,6 +323,60 @@ void loadAnotherLevelOrStartHosting()
 }
 
 
+// Fixed-rate replacement for the dedicated server's polling loop, used when FixedTickRate is set.
+// Runs whatever ticks are due, then sleeps until the next deadline or until a packet arrives.
+static void runScheduledTicks(U32 tickRate)
+{
+   static TickScheduler scheduler;
+   static U32 currentTickRate = 0;
+   static S64 startTime = Platform::getHighPrecisionTimerValue();
+
+   if(tickRate != currentTickRate)
+   {
+      scheduler.setTickRate(tickRate);
+      currentTickRate = tickRate;
+      logprintf(LogConsumer::ServerFilter, "Running fixed tick rate of %d ticks/sec", tickRate);
+   }
+
+   F64 now = Platform::getHighPrecisionMilliseconds(Platform::getHighPrecisionTimerValue() - startTime);
+
+   S32 ticks = scheduler.getTicksDue(now);
+   for(S32 i = 0; i < ticks; i++)
+   {
+      U32 tickLength = scheduler.getTickLength();
+
+      checkIfServerGameIsShuttingDown(tickLength);
+      GameManager::idle(tickLength);
+   }
+
+   now = Platform::getHighPrecisionMilliseconds(Platform::getHighPrecisionTimerValue() - startTime);
+
+   if(scheduler.isReportDue(now))
+      logprintf(LogConsumer::ServerFilter, "%s", scheduler.getJitterReport(now).c_str());
+
+   // Nothing to do until the next tick unless someone sends us something; empty servers can afford to be lazier.
+   // Refetch the ServerGame, as it may have been shut down by the ticks we just ran.
+   ServerGame *serverGame = GameManager::getServerGame();
+   F64 waitTime = scheduler.getTimeUntilNextTick(now);
+
+   if(serverGame && serverGame->isSuspended() && waitTime < 40)
+      waitTime = 40;
+
+   if(waitTime <= 0)
+      return;
+
+   // select() will keep telling us the socket is readable until we actually read from it, so whatever wakes us gets
+   // read now rather than on the next tick, or we'd spin here until the deadline.
+   if(serverGame && serverGame->getNetInterface()->getSocket().isValid())
+   {
+      if(serverGame->getNetInterface()->getSocket().waitForData(U32(waitTime * 1000)))
+         GameManager::checkIncomingPackets();
+   }
+   else
+      Platform::sleep(U32(ceil(waitTime)));
+}
+
+
 // This is the master idle loop that is called on every game tick.
 // This in turn calls the idle functions for all other objects in the game.
 void idle()
@@ -352,6 +408,12 @@ void idle()
 
    bool dedicated = GameManager::getServerGame() && GameManager::getServerGame()->isDedicated();
 
+   if(dedicated && settings->getIniSettings()->fixedTickRate > 0)
+   {
+      runScheduledTicks(settings->getIniSettings()->fixedTickRate);
+      return;
+   }
+
    U32 maxFPS = dedicated ? settings->getIniSettings()->maxDedicatedFPS : settings->getIniSettings()->maxFPS;
 
    if(deltaT >= S32(1000 / maxFPS))
@@ -12,6 +12,8 @@
 #include "gameConnection.h"
 #include "ship.h"
 #include "Zone.h"
+#include "ServerGame.h"
+#include "TickProfiler.h"
 
 #include "Colors.h"
 #include "GeomUtils.h"
@@ -70,6 +72,11 @@ MoveObject::MoveObject(const Point &pos, F32 radius, F32 mass) : Parent(radius)
    mInterpolating = false;
    mHitLimit = 16;
    mZones1IsCurrent = true;
+   mZoneIndexGeneration = 0;
+
+   for(S32 i = 0; i < GhostConnection::BaselineSlotCount; i++)
+      for(S32 j = 0; j < GhostConnection::MaxBaselineValues; j++)
+         mReceivedPosVel[i][j] = 0;
 
    LUAW_CONSTRUCTOR_INITIALIZATIONS;
 }
@@ -115,6 +122,8 @@ void MoveObject::idle(BfObject::IdleCallPath path)
 void MoveObject::onAddedToGame(Game *game)
 {
    Parent::onAddedToGame(game);
+
+   updateMirroredCircle();
     
 #ifndef ZAP_DEDICATED
    if(isGhost())     // Client only
@@ -183,7 +192,10 @@ Point MoveObject::getPos(S32 stateIndex) const
 void MoveObject::setPos(S32 stateIndex, const Point &pos)
 {
    if(stateIndex == ActualState)
+   {
       Parent::setPos(pos);
+      updateMirroredCircle();
+   }
    else
       mMoveStates.setPos(stateIndex, pos);
 
@@ -234,6 +246,24 @@ void MoveObject::setPosVelAng(const Point &pos, const Point &vel, F32 ang)
 }
 
 
+void MoveObject::setRadius(F32 radius)
+{
+   Parent::setRadius(radius);
+   updateMirroredCircle();
+}
+
+
+// Our database keeps a copy of our collision circle so findFirstCollision() can check lots of us at once without asking
+// each one; the copy has to change whenever our ActualState position or our radius does
+void MoveObject::updateMirroredCircle()
+{
+   GridDatabase *database = getDatabase();
+
+   if(database)
+      database->setMirroredCircle(this, Parent::getPos(), mRadius);
+}
+
+
 F32 MoveObject::getMass()
 {
    return mMass;
@@ -326,34 +356,111 @@ F32 MoveObject::computeMinSeperationTime(U32 stateIndex, MoveObject *contactShip
 const F32 moveTimeEpsilon = 0.000001f;
 const F32 velocityEpsilon = 0.00001f;
 
+// One object's progress through its move.  When it needs to shove another object out of the way, a frame for that
+// object goes on top of it, and it carries on where it left off once the other object is done.
+struct MoveFrame
+{
+   MoveObject *object;
+   F32 moveTime;              // Time left to move
+   F32 moveTimeStart;
+   U32 tryCount;
+   bool isBeingDisplaced;
+   S32 disabledStart;         // Where this frame's entries in disabledObjects begin
+};
+
+// Objects being moved, innermost displacement last.  The frames from where a move() call started up to the top form
+// the group of touching objects it is pushing around.  Shared by all moves, so we don't allocate for each one.
+static Vector<MoveFrame> moveFrames;
+static Vector<SafePtr<BfObject> > disabledObjects;    // Objects whose collisions have been switched off during a move
+
+static const U32 TRY_COUNT_MAX = 8;
+static const S32 MaxDisplacementsPerMove = 32;        // Cap on total pushing done by a single move(), however big the pile
+
+
 // Apply mMoveState info to an object to compute it's new position.  Used for ships et. al.
 // isBeingDisplaced is true when the object is being pushed by something else, which will only happen in a collision
 // Remember: stateIndex will be one of 0-ActualState, 1-RenderState, or 2-LastProcessState
-F32 MoveObject::move(F32 moveTime, U32 stateIndex, bool isBeingDisplaced, Vector<SafePtr<MoveObject> > displacerList)
+//
+// Objects we push get moved before we continue, and they may push others in turn.  Rather than recursing, we keep a
+// stack of frames, and cap the total pushing, so the work stays bounded however many objects are piled up.
+F32 MoveObject::move(F32 moveTime, U32 stateIndex, bool isBeingDisplaced)
 {
-   U32 tryCount = 0;
-   const U32 TRY_COUNT_MAX = 8;
-   Vector<SafePtr<BfObject> > disabledList;
-   F32 moveTimeStart = moveTime;
+   ProfileScope profileScope(TickProfiler::PhaseCollisions);
+
+   Point origPos = getPos(stateIndex);
+
+   S32 islandStart = moveFrames.size();      // Not always 0 -- collision callbacks may move things from within a move
+   S32 displacements = 0;
+
+   MoveFrame rootFrame;
+   rootFrame.object = this;
+   rootFrame.moveTime = moveTime;
+   rootFrame.moveTimeStart = moveTime;
+   rootFrame.tryCount = 0;
+   rootFrame.isBeingDisplaced = isBeingDisplaced;
+   rootFrame.disabledStart = disabledObjects.size();
+
+   moveFrames.push_back(rootFrame);
+
+   while(moveFrames.size() > islandStart)
+   {
+      // Work on a copy; advanceMove() can trigger moves of its own, which could reallocate moveFrames
+      S32 top = moveFrames.size() - 1;
+      MoveFrame frame = moveFrames[top];
+
+      F32 displaceTime;
+      MoveObject *displaced = frame.object->advanceMove(frame, stateIndex, islandStart, displaceTime);
+
+      moveFrames[top] = frame;
+
+      if(!displaced)
+      {
+         frame.object->finishMove(frame, stateIndex);
+         moveFrames.resize(top);
+         continue;
+      }
+
+      // Only try a limited number of times to avoid dragging the game under the dark waves of infinity
+      if(frame.object->mHitLimit <= 0 || displacements >= MaxDisplacementsPerMove)
+         continue;
+
+      frame.object->mHitLimit--;
+      displacements++;
+
+      MoveFrame displacedFrame;
+      displacedFrame.object = displaced;
+      displacedFrame.moveTime = displaceTime;
+      displacedFrame.moveTimeStart = displaceTime;
+      displacedFrame.tryCount = 0;
+      displacedFrame.isBeingDisplaced = true;
+      displacedFrame.disabledStart = disabledObjects.size();
+
+      moveFrames.push_back(displacedFrame);
+   }
+
+   return (getPos(stateIndex) - origPos).len();    // Return distance traveled during this move
+}
 
-   static Point origPos;   // Reusable container
-   origPos = getPos(stateIndex);
 
-   while(moveTime > moveTimeEpsilon && tryCount < TRY_COUNT_MAX)     // moveTimeEpsilon is a very short, but non-zero, bit of time
+// Move until we're done, in which case we return NULL, or until we run into something that we need to push out of the
+// way first, in which case we return that object, and how long it should move for in displaceTime
+MoveObject *MoveObject::advanceMove(MoveFrame &frame, U32 stateIndex, S32 islandStart, F32 &displaceTime)
+{
+   while(frame.moveTime > moveTimeEpsilon && frame.tryCount < TRY_COUNT_MAX)     // moveTimeEpsilon is a very short, but non-zero, bit of time
    {
-      tryCount++;
+      frame.tryCount++;
 
       // Ignore tiny movements unless we're processing a collision
-      if(!isBeingDisplaced && getVel(stateIndex).len() < velocityEpsilon)
+      if(!frame.isBeingDisplaced && getVel(stateIndex).len() < velocityEpsilon)
          break;
 
-      F32 collisionTime = moveTime;
-      static Point collisionPoint, newPos;     // Reusable containers
+      F32 collisionTime = frame.moveTime;
+      Point collisionPoint, newPos;
 
       BfObject *objectHit = findFirstCollision(stateIndex, collisionTime, collisionPoint);
       if(!objectHit)    // No collision (or if isBeingDisplaced is true, we haven't been pushed into another object)
       {
-         newPos = getPos(stateIndex) + getVel(stateIndex) * moveTime;   // Move to desired destination
+         newPos = getPos(stateIndex) + getVel(stateIndex) * frame.moveTime;   // Move to desired destination
          setPos(stateIndex, newPos);
          break;
       }
@@ -365,25 +472,25 @@ F32 MoveObject::move(F32 moveTime, U32 stateIndex, bool isBeingDisplaced, Vector
       // Collided is a sort of collision pre-handler; it will return true if the collision was dealt with, false if not
       if(collided(objectHit, stateIndex) || objectHit->collided(this, stateIndex))
       {
-         disabledList.push_back(objectHit);
+         disabledObjects.push_back(objectHit);
          objectHit->disableCollision();
-         tryCount--;   // Don't count as tryCount
+         frame.tryCount--;   // Don't count as tryCount
       }
       else if(objectHit->isMoveObject())     // Collided with a MoveObject (including a ship)
       {
          TNLAssert(dynamic_cast<MoveObject *>(objectHit), "Not a MoveObject");
          MoveObject *moveObjectThatWasHit = static_cast<MoveObject *>(objectHit);
 
-         static Point velDelta, posDelta;    // Reusable containers
-         velDelta = moveObjectThatWasHit->getVel(stateIndex) - getVel(stateIndex);
-         posDelta = moveObjectThatWasHit->getPos(stateIndex) - getPos(stateIndex);
+         Point velDelta = moveObjectThatWasHit->getVel(stateIndex) - getVel(stateIndex);
+         Point posDelta = moveObjectThatWasHit->getPos(stateIndex) - getPos(stateIndex);
 
-         // Prevent infinite loops with a series of objects trying to displace each other forever
-         if(isBeingDisplaced)
+         // Prevent infinite loops with a series of objects trying to displace each other forever -- don't push back
+         // on anything that is already pushing us (i.e. the frames below ours)
+         if(frame.isBeingDisplaced)
          {
             bool hit = false;
-            for(S32 i = 0; i < displacerList.size(); i++)
-               if(moveObjectThatWasHit == displacerList[i])
+            for(S32 i = islandStart; i < moveFrames.size() - 1; i++)
+               if(moveFrames[i].object == moveObjectThatWasHit)
                  hit = true;
             if(hit) break;
          }
@@ -391,46 +498,44 @@ F32 MoveObject::move(F32 moveTime, U32 stateIndex, bool isBeingDisplaced, Vector
          if(posDelta.dot(velDelta) < 0)   // moveObjectThatWasHit is closing faster than we are ???
          {
             computeCollisionResponseMoveObject(stateIndex, moveObjectThatWasHit);
-            if(isBeingDisplaced)
+            if(frame.isBeingDisplaced)
                break;
          }
          else                            // We're moving faster than the object we hit (I think)
          {
-            Point intendedPos = getPos(stateIndex) + getVel(stateIndex) * moveTime;    // x = x + vt
+            Point intendedPos = getPos(stateIndex) + getVel(stateIndex) * frame.moveTime;    // x = x + vt
 
             F32 displaceEpsilon = 0.002f;
             F32 t = computeMinSeperationTime(stateIndex, moveObjectThatWasHit, intendedPos);
             if(t <= 0)
                break;   // Some kind of math error, couldn't find result: stop simulating this ship
 
-            // Note that we could end up with an infinite feedback loop here, if, for some reason, two objects keep trying to displace
-            // one another, as this will just recurse deeper and deeper.
-
-            displacerList.push_back(this);
-
-            // Only try a limited number of times to avoid dragging the game under the dark waves of infinity
-            if(mHitLimit > 0) 
-            {
-               // Move the displaced object a tiny bit, true -> isBeingDisplaced
-               moveObjectThatWasHit->move(t + displaceEpsilon, stateIndex, true, displacerList); 
-               mHitLimit--;
-            }
+            // Move the displaced object a tiny bit before we carry on
+            frame.moveTime -= collisionTime;
+            displaceTime = t + displaceEpsilon;
+            return moveObjectThatWasHit;
          }
       }
       else if(isCollideableType(objectHit->getObjectTypeNumber()))
          computeCollisionResponseBarrier(stateIndex, collisionPoint);
 
-      moveTime -= collisionTime;
+      frame.moveTime -= collisionTime;
    }
 
-   for(S32 i = 0; i < disabledList.size(); i++)   // enable any disabled collision
-      if(disabledList[i].isValid())
-         disabledList[i]->enableCollision();
+   return NULL;
+}
+
 
-   if(tryCount == TRY_COUNT_MAX && moveTime > moveTimeStart * 0.98f)
-      setVel(stateIndex, Point(0,0));  // prevents some overload by not trying to move anymore
+void MoveObject::finishMove(MoveFrame &frame, U32 stateIndex)
+{
+   for(S32 i = frame.disabledStart; i < disabledObjects.size(); i++)   // enable any disabled collision
+      if(disabledObjects[i].isValid())
+         disabledObjects[i]->enableCollision();
 
-   return (getPos(stateIndex) - origPos).len();    // Return distance traveled during this move
+   disabledObjects.resize(frame.disabledStart);
+
+   if(frame.tryCount == TRY_COUNT_MAX && frame.moveTime > frame.moveTimeStart * 0.98f)
+      setVel(stateIndex, Point(0,0));  // prevents some overload by not trying to move anymore
 }
 
 
@@ -460,107 +565,183 @@ BfObject *MoveObject::findFirstCollision(U32 stateIndex, F32 &collisionTime, Poi
    Rect queryRect(getPos(stateIndex), getPos(stateIndex) + delta);
    queryRect.expand(Point(mRadius, mRadius));
 
-   fillVector.clear();
+   // Not fillVector: collide() callbacks can end up back in here (see SpeedZone), and would clobber it
+   Vector<DatabaseObject *> candidates;
 
-   findObjects(collideTypes(), fillVector, queryRect);   // Free CPU for finding only the ones we care about
+   findObjects(collideTypes(), candidates, queryRect);   // Free CPU for finding only the ones we care about
 
-   fillVector.sort(sortBarriersFirst);  // Sort to do Barriers::Collide first, to prevent picking up flag (FlagItem::Collide) through Barriers, especially when client does /maxfps 10
+   GridDatabase *database = getDatabase();
+
+   candidates.sort(sortBarriersFirst);  // Sort to do Barriers::Collide first, to prevent picking up flag (FlagItem::Collide) through Barriers, especially when client does /maxfps 10
 
    F32 collisionFraction;
 
    BfObject *collisionObject = NULL;
 
-   for(S32 i = 0; i < fillVector.size(); i++)
+   F32   myRadius;
+   Point myPos, vel;
+   const F32 maxTime = collisionTime;
+
+   // Candidates are handled in batches.  For each batch, we first copy the circle-shaped candidates (ships, asteroids, items,
+   // etc.) into flat arrays and work out when we'd hit each of them all in one go; whether a hit counts still depends on
+   // what we've hit already, so that part is done in order below, just as before.  Other MoveObjects are by far the most
+   // common circles, and our database keeps copies of their circles, so we only have to ask the rest for their shapes.
+   //
+   // A callback can move or delete things (ourselves included), which would leave the rest of the batch working from
+   // old positions.  So once any callback has run, we start a fresh batch with the next candidate.
+   const S32 BatchSize = 64;
+
+   const Vector<Point> *polys[BatchSize];
+   F32 circleX[BatchSize], circleY[BatchSize], circleRadius[BatchSize], hitTimes[BatchSize];
+   S32 circleIndex[BatchSize];      // Index into circle arrays for each candidate in batch, or -1 if it's not a circle
+
+   bool done = false;
+   S32 nextBatch = 0;
+
+   while(nextBatch < candidates.size() && !done)
    {
-      BfObject *foundObject = static_cast<BfObject *>(fillVector[i]);
+      const S32 batchStart = nextBatch;
+      const S32 batchEnd = min(candidates.size(), batchStart + BatchSize);
+      S32 circleCount = 0;
 
-      if(!foundObject->isCollisionEnabled())
-         continue;
+      nextBatch = batchEnd;
 
-      const Vector<Point> *poly = foundObject->getCollisionPoly();
+      getCollisionCircle(stateIndex, myPos, myRadius);
+      vel = getVel(stateIndex);
 
-      if(poly)
+      for(S32 i = batchStart; i < batchEnd; i++)
       {
-         Point cp;
+         BfObject *foundObject = static_cast<BfObject *>(candidates[i]);
+         Point center;
 
-         if(PolygonSweptCircleIntersect(&poly->first(), poly->size(), getPos(stateIndex),
-                                        delta, mRadius, cp, collisionFraction))
-         {
-            if(cp != getPos(stateIndex) || !isCollideableType(foundObject->getObjectTypeNumber()))   // Avoid getting stuck inside polygon wall
-            {
-               bool collide1 = collide(foundObject);
-               bool collide2 = foundObject->collide(this);
+         polys[i - batchStart] = NULL;
+         circleIndex[i - batchStart] = -1;
 
-               if(!(collide1 && collide2))
-                  continue;
+         bool isCircle;
 
-               collisionPoint = cp;
-               delta *= collisionFraction;
-               collisionTime *= collisionFraction;
-               collisionObject = foundObject;
+         if(stateIndex == ActualState && database && database->getMirroredCircle(foundObject, center, circleRadius[circleCount]))
+         {
+#ifdef TNL_DEBUG
+            Point actualCenter;
+            F32 actualRadius;
+            TNLAssert(!foundObject->getCollisionPoly() &&
+                      foundObject->getCollisionCircle(stateIndex, actualCenter, actualRadius) &&
+                      actualCenter == center && actualRadius == circleRadius[circleCount], "Mirrored circle is out of date!");
+#endif
+            isCircle = true;
+         }
+         else
+         {
+            polys[i - batchStart] = foundObject->getCollisionPoly();
+            isCircle = !polys[i - batchStart] && foundObject->getCollisionCircle(stateIndex, center, circleRadius[circleCount]);
+         }
 
-               if(!collisionTime)
-                  break;
-            }
+         if(isCircle)
+         {
+            circleX[circleCount] = center.x;
+            circleY[circleCount] = center.y;
+            circleIndex[i - batchStart] = circleCount;
+            circleCount++;
          }
       }
-      else
-      {
-         F32   myRadius, otherRadius;
-         Point myPos,    shipPos;
 
-         getCollisionCircle(stateIndex, myPos, myRadius);
-         if(foundObject->getCollisionCircle(stateIndex, shipPos, otherRadius))
+      sweptCircleHitTimes(myPos, vel, myRadius, circleX, circleY, circleRadius, circleCount, maxTime, hitTimes);
+
+      bool calledBack = false;
+
+      for(S32 i = batchStart; i < batchEnd; i++)
+      {
+         if(calledBack)       // What we gathered may be out of date now
          {
+            nextBatch = i;
+            break;
+         }
 
-            Point v = getVel(stateIndex);
-            Point p = myPos - shipPos;
+         BfObject *foundObject = static_cast<BfObject *>(candidates[i]);
+
+         if(foundObject->isDeleted() || !foundObject->isCollisionEnabled())
+            continue;
+
+         const Vector<Point> *poly = polys[i - batchStart];
+
+         if(poly)
+         {
+            Point cp;
 
-            if(v.dot(p) < 0)
+            if(PolygonSweptCircleIntersect(&poly->first(), poly->size(), getPos(stateIndex),
+                                           delta, mRadius, cp, collisionFraction))
             {
-               F32 R = myRadius + otherRadius;
-               if(p.len() <= R)
+               if(cp != getPos(stateIndex) || !isCollideableType(foundObject->getObjectTypeNumber()))   // Avoid getting stuck inside polygon wall
                {
                   bool collide1 = collide(foundObject);
                   bool collide2 = foundObject->collide(this);
+                  calledBack = true;
 
                   if(!(collide1 && collide2))
                      continue;
 
-                  collisionTime = 0;
+                  collisionPoint = cp;
+                  delta *= collisionFraction;
+                  collisionTime *= collisionFraction;
                   collisionObject = foundObject;
-                  delta.set(0,0);
 
-                  p.normalize(myRadius);  // we need this calculation, just to properly show bounce sparks at right position
-                  collisionPoint = myPos - p;
-               }
-               else
-               {
-                  F32 a = v.dot(v);
-                  F32 b = 2 * p.dot(v);
-                  F32 c = p.dot(p) - R * R;
-                  F32 t;
-                  if(findLowestRootInInterval(a, b, c, collisionTime, t))
+                  if(!collisionTime)
                   {
-                     bool collide1 = collide(foundObject);
-                     bool collide2 = foundObject->collide(this);
+                     done = true;
+                     break;
+                  }
+               }
+            }
+         }
+         else if(circleIndex[i - batchStart] != -1)
+         {
+            const S32 index = circleIndex[i - batchStart];
+            const F32 t = hitTimes[index];
 
-                     // If A and B collide, both A and B's collide functions must return true to proceed
-                     if(!collide1 || !collide2)
-                        continue;
+            if(t < 0)      // Moving apart, or won't get there in time
+               continue;
 
-                     collisionTime = t;
-                     collisionObject = foundObject;
-                     delta = getVel(stateIndex) * collisionTime;
+            Point shipPos(circleX[index], circleY[index]);
+            Point p = myPos - shipPos;
+            F32 otherRadius = circleRadius[index];
 
-                     p.normalize(otherRadius);  // we need this calculation, just to properly show bounce sparks at right position
-                     collisionPoint = shipPos + p;
-                  }
-               }
+            if(p.len() <= myRadius + otherRadius)
+            {
+               bool collide1 = collide(foundObject);
+               bool collide2 = foundObject->collide(this);
+               calledBack = true;
+
+               if(!(collide1 && collide2))
+                  continue;
+
+               collisionTime = 0;
+               collisionObject = foundObject;
+               delta.set(0,0);
+
+               p.normalize(myRadius);  // we need this calculation, just to properly show bounce sparks at right position
+               collisionPoint = myPos - p;
+            }
+            else if(t <= collisionTime)      // Hit time doesn't depend on collisionTime, so we can just compare
+            {
+               bool collide1 = collide(foundObject);
+               bool collide2 = foundObject->collide(this);
+               calledBack = true;
+
+               // If A and B collide, both A and B's collide functions must return true to proceed
+               if(!collide1 || !collide2)
+                  continue;
+
+               collisionTime = t;
+               collisionObject = foundObject;
+               delta = vel * collisionTime;
+
+               p.normalize(otherRadius);  // we need this calculation, just to properly show bounce sparks at right position
+               collisionPoint = shipPos + p;
             }
          }
       }
    }
+
    return collisionObject;
 }
 
@@ -569,10 +750,31 @@ BfObject *MoveObject::findFirstCollision(U32 stateIndex, F32 &collisionTime, Poi
 // Server only
 void MoveObject::checkForZones()
 {
+   ZoneIndex *zoneIndex = static_cast<ServerGame *>(getGame())->getZoneIndex();
+   U32 generation = zoneIndex->refresh(getDatabase());
+   Point pos = getActualPos();
+
+   // Nothing has moved since last time, so we're still in the same zones
+   if(pos == mZoneCheckPos && generation == mZoneIndexGeneration)
+      return;
+
+   mZoneCheckPos = pos;
+   mZoneIndexGeneration = generation;
+
+   S32 cell = zoneIndex->getCell(pos);
+
+   // Not in any zones before, and there aren't any around here now
+   if(cell < 0 && getCurrZoneList().size() == 0)
+      return;
+
+   // Use this boolean as a cheap way of making the current zone list be the previous out without copying
+   mZones1IsCurrent = !mZones1IsCurrent;
+
    Vector<SafePtr<Zone> > &currZoneList = getCurrZoneList();
    Vector<SafePtr<Zone> > &prevZoneList = getPrevZoneList();
 
-   getZonesObjectIsIn(currZoneList);     // Fill currZoneList with a list of all zones ship is currently in
+   currZoneList.clear();
+   zoneIndex->findZones(cell, pos, currZoneList);
 
    // Now compare currZoneList with prevZoneList to figure out if ship entered or exited any zones
    for(S32 i = 0; i < currZoneList.size(); i++)
@@ -603,25 +805,11 @@ void MoveObject::onLeftZone(Zone *zone)
 // Server only
 void MoveObject::getZonesObjectIsIn(Vector<SafePtr<Zone> > &zoneList)
 {
-   // Use this boolean as a cheap way of making the current zone list be the previous out without copying
-   mZones1IsCurrent = !mZones1IsCurrent;
+   ZoneIndex *zoneIndex = static_cast<ServerGame *>(getGame())->getZoneIndex();
+   zoneIndex->refresh(getDatabase());
 
    zoneList.clear();
-
-   Rect rect(getActualPos(), getActualPos());            // Center of object
-
-   fillVector.clear();
-   findObjects((TestFunc)isZoneType, fillVector, rect);  // Find all zones the object might be in
-
-   // Extents overlap...  now check for actual overlap
-   for(S32 i = 0; i < fillVector.size(); i++)
-   {
-      // Get points that define the zone boundaries
-      const Vector<Point> *polyPoints = fillVector[i]->getCollisionPoly();
-
-      if(polygonContainsPoint(polyPoints->address(), polyPoints->size(), getActualPos()))
-         zoneList.push_back(SafePtr<Zone>(static_cast<Zone *>(fillVector[i])));
-   }
+   zoneIndex->findZones(zoneIndex->getCell(getActualPos()), getActualPos(), zoneList);
 }
 
 
@@ -873,6 +1061,131 @@ void MoveObject::computeImpulseDirection(DamageInfo *damageInfo)
 }
 
 
+// Positions go out to the nearest unit, and velocities to the nearest unit/sec.  Each value is sent as a 2-bit
+// size class followed by a signed int of that many bits, picked from one of these tables.
+static const U32 PosVelDeltaBits[] = { 0, 5, 9, 14 };     // Changes since a state the client already has
+static const U32 PosBits[]         = { 12, 16, 20, 28 };
+static const U32 VelBits[]         = { 0, 8, 12, 16 };
+
+static const S32 PosVelValueCount = 4;    // x, y, vel x, vel y
+
+
+static bool fitsInBits(S32 value, U32 bits)
+{
+   if(bits == 0)
+      return value == 0;
+
+   S32 limit = 1 << (bits - 1);
+   return value >= -limit && value < limit;
+}
+
+
+static void writeSizedInt(BitStream *stream, S32 value, const U32 *sizes)
+{
+   U32 sizeClass = 0;
+   while(!fitsInBits(value, sizes[sizeClass]))
+      sizeClass++;
+
+   TNLAssert(sizeClass < 4, "Value too big to send!");
+
+   stream->writeInt(sizeClass, 2);
+   if(sizes[sizeClass] > 0)
+      stream->writeSignedInt(value, sizes[sizeClass]);
+}
+
+
+static S32 readSizedInt(BitStream *stream, const U32 *sizes)
+{
+   U32 bits = sizes[stream->readInt(2)];
+   return bits > 0 ? stream->readSignedInt(bits) : 0;
+}
+
+
+// Rounds value, keeping it within what a signed int of the given size can hold
+static S32 quantize(F32 value, U32 bits)
+{
+   F32 limit = F32((1 << (bits - 1)) - 1);
+   F32 rounded = floor(value + 0.5f);
+
+   return S32(rounded > limit ? limit : (rounded < -limit ? -limit : rounded));
+}
+
+
+// Sends pos and vel as changes from the last state the client acked, if there is one and they haven't changed
+// too much, or as absolute values otherwise.  Either way, the client is told where to keep them so that later
+// updates can be encoded against them.
+// Any changes here need to be reflected in MoveObject::readPosVel
+void MoveObject::writePosVel(GhostConnection *connection, const Point &pos, const Point &vel, BitStream *stream)
+{
+   S32 values[PosVelValueCount] = { quantize(pos.x, PosBits[3]), quantize(pos.y, PosBits[3]),
+                                    quantize(vel.x, VelBits[3]), quantize(vel.y, VelBits[3]) };
+   S32 deltas[PosVelValueCount];
+
+   S32 baselineSlot;
+   const S32 *baseline = connection->getAckedBaseline(baselineSlot);
+   bool useDeltas = baseline != NULL;
+
+   for(S32 i = 0; i < PosVelValueCount && useDeltas; i++)
+   {
+      deltas[i] = values[i] - baseline[i];
+      useDeltas = fitsInBits(deltas[i], PosVelDeltaBits[3]);
+   }
+
+   if(stream->writeFlag(useDeltas))
+   {
+      stream->writeInt(baselineSlot, GhostConnection::BaselineSlotBitSize);
+
+      for(S32 i = 0; i < PosVelValueCount; i++)
+         writeSizedInt(stream, deltas[i], PosVelDeltaBits);
+   }
+   else
+   {
+      writeSizedInt(stream, values[0], PosBits);
+      writeSizedInt(stream, values[1], PosBits);
+      writeSizedInt(stream, values[2], VelBits);
+      writeSizedInt(stream, values[3], VelBits);
+   }
+
+   S32 slot = connection->recordBaseline(values, PosVelValueCount);
+
+   if(stream->writeFlag(slot >= 0))
+      stream->writeInt(slot, GhostConnection::BaselineSlotBitSize);
+}
+
+
+// Any changes here need to be reflected in MoveObject::writePosVel
+void MoveObject::readPosVel(BitStream *stream, Point &pos, Point &vel)
+{
+   S32 values[PosVelValueCount];
+
+   if(stream->readFlag())
+   {
+      S32 baselineSlot = stream->readInt(GhostConnection::BaselineSlotBitSize);
+
+      for(S32 i = 0; i < PosVelValueCount; i++)
+         values[i] = mReceivedPosVel[baselineSlot][i] + readSizedInt(stream, PosVelDeltaBits);
+   }
+   else
+   {
+      values[0] = readSizedInt(stream, PosBits);
+      values[1] = readSizedInt(stream, PosBits);
+      values[2] = readSizedInt(stream, VelBits);
+      values[3] = readSizedInt(stream, VelBits);
+   }
+
+   if(stream->readFlag())
+   {
+      S32 slot = stream->readInt(GhostConnection::BaselineSlotBitSize);
+
+      for(S32 i = 0; i < PosVelValueCount; i++)
+         mReceivedPosVel[slot][i] = values[i];
+   }
+
+   pos.set(F32(values[0]), F32(values[1]));
+   vel.set(F32(values[2]), F32(values[3]));
+}
+
+
 /////
 // Lua interface
 /**
@@ -1060,8 +1373,6 @@ void MoveItem::idle(BfObject::IdleCallPath path)
 void MoveItem::setPositionMask() { setMaskBits(PositionMask); }      // Could be moved to MoveObject
 
 
-static const S32 VEL_POINT_SEND_BITS = 511;     // 511 = 2^9 - 1, the biggest int we can pack into 9 bits.
-
 U32 MoveItem::packUpdate(GhostConnection *connection, U32 updateMask, BitStream *stream)
 {
    U32 retMask = 0;
@@ -1070,8 +1381,7 @@ U32 MoveItem::packUpdate(GhostConnection *connection, U32 updateMask, BitStream
 
    if(stream->writeFlag(updateMask & PositionMask))
    {
-      ((GameConnection *) connection)->writeCompressedPoint(getActualPos(), stream);
-      writeCompressedVelocity(getActualVel(), VEL_POINT_SEND_BITS, stream);
+      writePosVel(connection, getActualPos(), getActualVel(), stream);
       stream->writeFlag(updateMask & WarpPositionMask);     // WarpPositionMask
    }
 
@@ -1091,9 +1401,9 @@ void MoveItem::unpackUpdate(GhostConnection *connection, BitStream *stream)
 
    if(stream->readFlag())                          // PositionMask
    {
-      Point pt;
+      Point pt, vel;
 
-      ((GameConnection *) connection)->readCompressedPoint(pt, stream);
+      readPosVel(stream, pt, vel);
 
       // Here, we need to set the renderPos BEFORE setting actualPos -- setting actualPos triggers a 
       // recalculation of the object's extent, which, for whatever reason, will extend from the renderPos
@@ -1104,9 +1414,7 @@ void MoveItem::unpackUpdate(GhostConnection *connection, BitStream *stream)
          setRenderPos(pt);
 
       setActualPos(pt);
-
-      readCompressedVelocity(pt, VEL_POINT_SEND_BITS, stream);   
-      setActualVel(pt);
+      setActualVel(vel);
 
       positionChanged = true;
       warpToNewPosition = stream->readFlag();     // WarpPositionMask
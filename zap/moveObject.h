@@ -10,6 +10,8 @@
 #include "LuaWrapper.h"
 #include "DismountModesEnum.h"
 
+#include "tnlGhostConnection.h"
+
 namespace Zap
 {
 
@@ -50,6 +52,8 @@ public:
 ////////////////////////////////////////
 ////////////////////////////////////////
 
+struct MoveFrame;
+
 class MoveObject : public Item
 {
    typedef Item Parent;
@@ -62,10 +66,14 @@ private:
    Vector<SafePtr<Zone> > mZones1;      
    Vector<SafePtr<Zone> > mZones2;
    bool mZones1IsCurrent;        // "Pointer" to one of the above
+   Point mZoneCheckPos;          // Where we were when we last worked out which zones we're in...
+   U32 mZoneIndexGeneration;     // ...and how the zones were laid out at the time, see ZoneIndex::refresh()
 
    Vector<SafePtr<Zone> > &getCurrZoneList();                  // Get list of zones object is currently in
    Vector<SafePtr<Zone> > &getPrevZoneList();                  // Get list of zones object was in last tick
 
+   void updateMirroredCircle();     // Copy our collision circle into our database, see GridDatabase::setMirroredCircle()
+
 protected:
    enum {
       InterpMaxVelocity = 900, // velocity to use to interpolate to proper position
@@ -76,6 +84,12 @@ protected:
    F32 mMass;
    bool mWaitingForMoveToUpdate;  // client only
 
+   // Positions and velocities received, in the slots the server asked us to keep them in -- client only
+   S32 mReceivedPosVel[GhostConnection::BaselineSlotCount][GhostConnection::MaxBaselineValues];
+
+   void writePosVel(GhostConnection *connection, const Point &pos, const Point &vel, BitStream *stream);
+   void readPosVel(BitStream *stream, Point &pos, Point &vel);
+
    enum MaskBits {
       PositionMask     = Parent::FirstFreeMask << 0,     // Position has changed and needs to be updated
       WarpPositionMask = Parent::FirstFreeMask << 1,     // A large change in position not requiring client-side "smoothing"
@@ -141,12 +155,16 @@ public:
    void setPosVelAng(const Point &pos, const Point &vel, F32 ang);
    virtual void setInitialPosVelAng(const Point &pos, const Point &vel, F32 ang);
 
+   void setRadius(F32 radius);
+
    F32 getMass();
    void setMass(F32 mass);
 
    virtual void playCollisionSound(U32 stateIndex, MoveObject *moveObjectThatWasHit, F32 velocity);
 
-   F32 move(F32 time, U32 stateIndex, bool displacing = false, Vector<SafePtr<MoveObject> > = Vector<SafePtr<MoveObject> >());
+   F32 move(F32 time, U32 stateIndex, bool displacing = false);
+   MoveObject *advanceMove(MoveFrame &frame, U32 stateIndex, S32 islandStart, F32 &displaceTime);
+   void finishMove(MoveFrame &frame, U32 stateIndex);
    virtual bool collide(BfObject *otherObject);
 
    // CollideTypes is used to improve speed on findFirstCollision
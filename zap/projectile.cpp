@@ -26,6 +26,8 @@ namespace Zap
 
 using namespace LuaArgs;
 
+BF_IMPLEMENT_POOLED_CLASS(Projectile);
+
 // Constructor -- used when weapon is fired  
 Projectile::Projectile(WeaponType type, const Point &pos, const Point &vel, BfObject *shooter)
 {
@@ -537,6 +539,7 @@ S32 Projectile::lua_setVel(lua_State *L)
 ////////////////////////////////////////
 
 TNL_IMPLEMENT_NETOBJECT(Burst);
+BF_IMPLEMENT_POOLED_CLASS(Burst);
 
 // Constructor -- used when burst is fired
 Burst::Burst(const Point &pos, const Point &vel, BfObject *shooter, F32 radius) : MoveItem(pos, true, radius, BurstMass)
@@ -816,6 +819,7 @@ S32 Burst::lua_getWeapon(lua_State *L) { return returnWeaponType(L, mWeaponType)
 ////////////////////////////////////////
 
 TNL_IMPLEMENT_NETOBJECT(Mine);
+BF_IMPLEMENT_POOLED_CLASS(Mine);
 
 
 const U32 Mine::FuseDelay = 100;
@@ -1114,6 +1118,7 @@ REGISTER_LUA_SUBCLASS(Mine, Burst);
 //////////////////////////////////
 
 TNL_IMPLEMENT_NETOBJECT(SpyBug);
+BF_IMPLEMENT_POOLED_CLASS(SpyBug);
 
 // Constructor -- used when SpyBug is deployed
 SpyBug::SpyBug(const Point &pos, BfObject *planter) : Burst(pos, Point(0,0), planter)
@@ -1382,6 +1387,7 @@ REGISTER_LUA_SUBCLASS(SpyBug, Burst);
 ////////////////////////////////////////
 
 TNL_IMPLEMENT_NETOBJECT(Seeker);
+BF_IMPLEMENT_POOLED_CLASS(Seeker);
 
 // Statics
 const F32 Seeker::Radius = 2;
@@ -9,6 +9,7 @@
 #include "BfObject.h"      // Parent
 #include "moveObject.h"    // Parent
 
+#include "ObjectPool.h"
 #include "Point.h"
 #include "WeaponInfo.h"
 #include "sparkManager.h"
@@ -85,6 +86,7 @@ public:
    BfObject *getShooter() const;
 
    TNL_DECLARE_CLASS(Projectile);
+   BF_DECLARE_POOLED_CLASS;
 
    //// Lua interface
    LUAW_DECLARE_CLASS_CUSTOM_CONSTRUCTOR(Projectile);
@@ -153,6 +155,7 @@ public:
    BfObject *getShooter() const;
 
    TNL_DECLARE_CLASS(Burst);
+   BF_DECLARE_POOLED_CLASS;
 
    //// Lua interface
    LUAW_DECLARE_CLASS_CUSTOM_CONSTRUCTOR(Burst);
@@ -199,6 +202,7 @@ public:
    void unpackUpdate(GhostConnection *connection, BitStream *stream);
 
    TNL_DECLARE_CLASS(Mine);
+   BF_DECLARE_POOLED_CLASS;
 
    /////
    // Editor methods
@@ -260,6 +264,7 @@ public:
    void unpackUpdate(GhostConnection *connection, BitStream *stream);
 
    TNL_DECLARE_CLASS(SpyBug);
+   BF_DECLARE_POOLED_CLASS;
 
    /////
    // Editor methods
@@ -355,6 +360,7 @@ public:
    BfObject *getShooter() const;
 
    TNL_DECLARE_CLASS(Seeker);
+   BF_DECLARE_POOLED_CLASS;
 
    //// Lua interface
    LUAW_DECLARE_CLASS_CUSTOM_CONSTRUCTOR(Seeker);
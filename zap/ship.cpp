@@ -1391,8 +1391,7 @@ U32 Ship::packUpdate(GhostConnection *connection, U32 updateMask, BitStream *str
          // Send position and speed  ==> use renderPos because that is the server's best guess of where a client-controlled
          //                              ship is at any given moment, even if the server hasn't heard from the client for
          //                              dseveral frames due to network delays.
-         gameConnection->writeCompressedPoint(getRenderPos(), stream);
-         writeCompressedVelocity(getRenderVel(), BoostMaxVelocity + 1, stream);
+         writePosVel(connection, getRenderPos(), getRenderVel(), stream);
       }
       if(stream->writeFlag(updateMask & MoveMask))             // <=== TWO
          mCurrentMove.pack(stream, NULL, false);               // Send current move
@@ -1571,12 +1570,10 @@ void Ship::unpackUpdate(GhostConnection *connection, BitStream *stream)
 
    if(stream->readFlag())     // UpdateMask
    {
-      Point p;
-      ((GameConnection *) connection)->readCompressedPoint(p, stream);
+      Point p, vel;
+      readPosVel(stream, p, vel);
       Parent::setActualPos(p);
-
-      readCompressedVelocity(p, BoostMaxVelocity + 1, stream);
-      Parent::setActualVel(p);
+      Parent::setActualVel(vel);
       positionChanged = true;
    }
 
@@ -43,7 +43,7 @@ const U16 SpeedZone::defaultSpeed = 2000;
 // Combined C++/Lua constructor
 SpeedZone::SpeedZone(lua_State *L)
 {
-   mNetFlags.set(Ghostable);
+   mNetFlags.set(Ghostable | SharedUpdates);
    mObjectTypeNumber = SpeedZoneTypeNumber;
 
    mSpeed = defaultSpeed;